@@ -0,0 +1,142 @@
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "PetscException.hpp"
+#include "LogFile.hpp"
+
+#include "BoijeGenerationSolver.hpp"
+#include "SimulatorArguments.hpp"
+
+int main(int argc, char *argv[])
+{
+    ExecutableSupport::StartupWithoutShowingCopyright(&argc, &argv);
+    //main() returns code indicating solver run success or failure mode
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    if (CountPositionalArguments(argc, argv) != 9)
+    {
+        ExecutableSupport::PrintError(
+                "Wrong arguments for solver.\nUsage (replace<> with values):\n BoijeSolver <directoryString> <filenameString> <endGenerationUnsigned> <phase2GenerationUnsigned> <phase3GenerationUnsigned> <pAtoh7Double(0-1)> <pPtf1aDouble(0-1)> <pngDouble(0-1)>\nWrites <filename> (count probabilities), <filename>Events (expected mitotic modes) and <filename>Sequences (sequence sampler probabilities), for each generation up to endGeneration\nOptions:\n-max_count <unsigned>: largest count resolved (default 255)\n-min_sequence_probability <double>: sequences less likely than this are dropped (default 1e-12)",
+                true);
+        exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        return exit_code;
+    }
+
+    /***********************
+     * SOLVER PARAMETERS
+     ***********************/
+    std::string directoryString, filenameString;
+    unsigned endGeneration, phase2Generation, phase3Generation;
+    double pAtoh7, pPtf1a, png; //stochastic model parameters
+    unsigned maxCount = 255;
+    double minSequenceProbability = 1e-12;
+
+    //PARSE ARGUMENTS
+    directoryString = argv[1];
+    filenameString = argv[2];
+    endGeneration = std::stoul(argv[3]);
+    phase2Generation = std::stoul(argv[4]);
+    phase3Generation = std::stoul(argv[5]);
+    pAtoh7 = std::stod(argv[6]);
+    pPtf1a = std::stod(argv[7]);
+    png = std::stod(argv[8]);
+    if (SimulatorOptionExists("-max_count"))
+        maxCount = CommandLineArguments::Instance()->GetUnsignedCorrespondingToOption("-max_count");
+    if (SimulatorOptionExists("-min_sequence_probability"))
+        minSequenceProbability = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption(
+                "-min_sequence_probability");
+
+    /************************
+     * PARAMETER/ARGUMENT SANITY CHECK
+     ************************/
+    bool sane = 1;
+
+    if (endGeneration <= 0)
+    {
+        ExecutableSupport::PrintError("Bad endGeneration (argument 3). endGeneration must be > 0");
+        sane = 0;
+    }
+
+    if (phase3Generation < phase2Generation)
+    {
+        ExecutableSupport::PrintError(
+                "Bad phase2Generation or phase3Generation (arguments 4, 5). phase3Generation must be > phase2Generation. Both must be >0");
+        sane = 0;
+    }
+
+    if (pAtoh7 < 0 || pAtoh7 > 1 || pPtf1a < 0 || pPtf1a > 1 || png < 0 || png > 1)
+    {
+        ExecutableSupport::PrintError("Bad pAtoh7, pPtf1a or png (arguments 6, 7, 8). Must be  0-1");
+        sane = 0;
+    }
+
+    if (sane == 0)
+    {
+        ExecutableSupport::PrintError("Exiting with bad arguments. See errors for details");
+        exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        return exit_code;
+    }
+
+    /************************
+     * SOLVE & OUTPUT
+     ************************/
+
+    BoijeGenerationSolver solver(maxCount);
+    solver.SetModelParameters(phase2Generation, phase3Generation, pAtoh7, pPtf1a, png);
+
+    ExecutableSupport::Print("Solver writing files " + filenameString + ", " + filenameString + "Events, "
+            + filenameString + "Sequences to directory " + directoryString);
+
+    LogFile* p_log = LogFile::Instance();
+    p_log->Set(0, directoryString, filenameString);
+    *p_log << "Generation\tCount\tP(CloneSize)\tP(RGC)\tP(AC/HC)\tP(PR/BC)\n";
+    for (unsigned generation = 1; generation <= endGeneration; generation++)
+    {
+        std::vector<std::vector<double> > distributions;
+        distributions.push_back(solver.GetCountDistribution(BoijeGenerationSolver::CLONE_SIZE, generation));
+        distributions.push_back(solver.GetCountDistribution(BoijeGenerationSolver::RGC_COUNT, generation));
+        distributions.push_back(solver.GetCountDistribution(BoijeGenerationSolver::AC_HC_COUNT, generation));
+        distributions.push_back(solver.GetCountDistribution(BoijeGenerationSolver::PR_BC_COUNT, generation));
+
+        for (unsigned m = 0; m < solver.GetCountRange(); m++)
+        {
+            *p_log << generation << "\t" << m;
+            for (unsigned i = 0; i < distributions.size(); i++)
+            {
+                *p_log << "\t" << distributions[i][m];
+            }
+            *p_log << "\n";
+        }
+    }
+    LogFile::Close();
+
+    p_log = LogFile::Instance();
+    p_log->Set(0, directoryString, filenameString + "Events");
+    *p_log << "Generation\tPP\tPD\tDD\n";
+    std::vector<std::vector<double> > events = solver.GetExpectedModeEvents(endGeneration);
+    for (unsigned generation = 1; generation <= endGeneration; generation++)
+    {
+        *p_log << generation << "\t" << events[generation][0] << "\t" << events[generation][1] << "\t"
+                << events[generation][2] << "\n";
+    }
+    LogFile::Close();
+
+    p_log = LogFile::Instance();
+    p_log->Set(0, directoryString, filenameString + "Sequences");
+    *p_log << "End Generation\tSequence\tProbability\n";
+    for (unsigned generation = 1; generation <= endGeneration; generation++)
+    {
+        std::map<std::string, double> sequences = solver.GetSequenceDistribution(generation, minSequenceProbability);
+        for (std::map<std::string, double>::const_iterator it = sequences.begin(); it != sequences.end(); ++it)
+        {
+            *p_log << generation << "\t" << it->first << "\t" << it->second << "\n";
+        }
+    }
+    LogFile::Close();
+
+    return exit_code;
+}
@@ -24,6 +24,11 @@
 #include "VertexBasedCellPopulation.hpp"
 
 #include "ColumnDataWriter.hpp"
+#include "SimulatorSeedShard.hpp"
+#include "EventOutputBuffer.hpp"
+#include "CountDistanceBound.hpp"
+#include "CycleDurationSampler.hpp"
+#include "SimulatorArguments.hpp"
 
 int main(int argc, char *argv[])
 {
@@ -31,10 +36,10 @@ int main(int argc, char *argv[])
     //main() returns code indicating sim run success or failure mode
     int exit_code = ExecutableSupport::EXIT_OK;
 
-    if (argc != 15)
+    if (CountPositionalArguments(argc, argv) != 15)
     {
         ExecutableSupport::PrintError(
-                "Wrong arguments for simulator.\nUsage (replace<> with values, pass bools as 0 or 1):\n GomesSimulator <directoryString> <filenameString> <outputModeUnsigned(0=counts,1=events,2=sequence)> <debugOutputBool> <startSeedUnsigned> <endSeedUnsigned> <endTimeDoubleHours> <cellCycleNormalMeanDouble> <cellCycleNormalStdDouble> <pPPDouble(0-1)> <pPDDouble(0-1)> <pBCDouble(0-1)> <pACDouble(0-1)> <pMGDouble(0-1)>",
+                "Wrong arguments for simulator.\nUsage (replace<> with values, pass bools as 0 or 1):\n GomesSimulator <directoryString> <filenameString> <outputModeUnsigned(0=counts,1=events,2=sequence)> <debugOutputBool> <startSeedUnsigned> <endSeedUnsigned> <endTimeDoubleHours> <cellCycleNormalMeanDouble> <cellCycleNormalStdDouble> <pPPDouble(0-1)> <pPDDouble(0-1)> <pBCDouble(0-1)> <pACDouble(0-1)> <pMGDouble(0-1)>\nOptions:\n-fast_rng: draw cycle durations from the buffered CycleDurationSampler\n-antithetic: run seeds in antithetic pairs (startSeed, startSeed+1), ...; each pair's second seed replays the first's random stream with mirrored mode RVs & cycle duration quantiles\n-abort <referenceFile> <toleranceDouble>: counts only; stop once the count RSS against the reference histogram (probabilities of counts 1,2,... in referenceFile) is certain to exceed the tolerance, exiting with code 3",
                 true);
         exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
         return exit_code;
@@ -49,6 +54,9 @@ int main(int argc, char *argv[])
     unsigned startSeed, endSeed;
     double endTime;
     double normalMu, normalSigma, pPP, pPD, pBC, pAC, pMG; //stochastic model parameters
+    bool fastRNG, antithetic;
+    std::string abortFilename; //reference count histogram for early abort, if any
+    double abortTolerance = 0; //count RSS above which the run is abandoned
 
     //PARSE ARGUMENTS
     directoryString = argv[1];
@@ -65,6 +73,13 @@ int main(int argc, char *argv[])
     pBC = std::stod(argv[12]);
     pAC = std::stod(argv[13]);
     pMG = std::stod(argv[14]);
+    fastRNG = SimulatorOptionExists("-fast_rng");
+    antithetic = SimulatorOptionExists("-antithetic");
+    if (SimulatorOptionExists("-abort"))
+    {
+        abortFilename = CommandLineArguments::Instance()->GetStringCorrespondingToOption("-abort", 1);
+        abortTolerance = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-abort", 2);
+    }
 
     /************************
      * PARAMETER/ARGUMENT SANITY CHECK
@@ -110,6 +125,12 @@ int main(int argc, char *argv[])
         sane = 0;
     }
 
+    if (!abortFilename.empty() && (abortTolerance < 0 || outputMode != 0))
+    {
+        ExecutableSupport::PrintError("Bad -abort. Tolerance must be >=0; early abort requires count output (argument 3 = 0)");
+        sane = 0;
+    }
+
     if (sane == 0)
     {
         ExecutableSupport::PrintError("Exiting with bad arguments. See errors for details");
@@ -121,22 +142,42 @@ int main(int argc, char *argv[])
      * SIMULATOR OUTPUT SETUP
      ************************/
 
+//Split the seed range across MPI ranks (one shard when run serially)
+    SimulatorSeedShard shard(startSeed, endSeed);
+
 //Set up singleton LogFile
     LogFile* p_log = LogFile::Instance();
-    p_log->Set(0, directoryString, filenameString);
+    p_log->Set(0, directoryString, shard.GetShardName(filenameString));
 
     ExecutableSupport::Print("Simulator writing file " + filenameString + " to directory " + directoryString);
 
 //Log entry counter
-    unsigned entry_number = 1;
+    unsigned entry_number = shard.GetFirstEntry();
+
+//Write appropriate headers to log (first shard only)
+    if (shard.IsFirstShard())
+    {
+        if (outputMode == 0) *p_log << "Entry\tSeed\tCount\n";
+        if (outputMode == 1) *p_log << "Time (hpf)\tSeed\tCellID\tMitotic Mode (0=PP;1=PD;2=DD)\tP(PP)\tP(PD)\tP(DD)\n";
+        if (outputMode == 2) *p_log << "Entry\tSeed\tSequence\n";
+    }
 
-//Write appropriate headers to log
-    if (outputMode == 0) *p_log << "Entry\tSeed\tCount\n";
-    if (outputMode == 1) *p_log << "Time (hpf)\tSeed\tCellID\tMitotic Mode (0=PP;1=PD;2=DD)\n";
-    if (outputMode == 2) *p_log << "Entry\tSeed\tSequence\n";
+//Worker event buffer for seed-tagged row output (models write mode events & sequences to the same buffer)
+    EventOutputBuffer* p_events = EventOutputBuffer::Instance();
 
 //Instance RNG
     RandomNumberGenerator* p_RNG = RandomNumberGenerator::Instance();
+    //Buffered cycle duration stream, reseeded with each simulation seed
+    boost::shared_ptr<CycleDurationSampler> p_durationSampler;
+    if (fastRNG) p_durationSampler.reset(new CycleDurationSampler(startSeed));
+
+//Early abort: the run stops once its count histogram cannot come within the tolerance of the reference
+    boost::shared_ptr<CountDistanceBound> p_distanceBound;
+    if (!abortFilename.empty())
+    {
+        p_distanceBound.reset(new CountDistanceBound(endSeed - startSeed + 1, abortTolerance));
+        p_distanceBound->ReadReference(abortFilename);
+    }
 
 //Initialise pointers to relevant singleton ProliferativeTypes and Properties
     MAKE_PTR(WildTypeCellMutationState, p_state);
@@ -153,9 +194,11 @@ int main(int argc, char *argv[])
      ************************/
 
 //iterate through supplied seed range, executing one simulation per seed
-    for (unsigned seed = startSeed; seed <= endSeed; seed++)
+    for (unsigned seed = shard.GetStartSeed(); seed < shard.GetStopSeed(); seed++)
     {
-        if (outputMode == 2) *p_log << entry_number << "\t" << seed << "\t"; //write seed to log - sequence written by cellcyclemodel objects
+        //rows for this seed go to the worker's event buffer, merged into the log in seed order
+        p_events->BeginSeed(seed);
+        if (outputMode == 2) *p_events << entry_number << "\t" << seed << "\t"; //write seed to log - sequence written by cellcyclemodel objects
 
         //initialise pointer to debugWriter
         ColumnDataWriter* debugWriter;
@@ -163,8 +206,12 @@ int main(int argc, char *argv[])
         //initialise SimulationTime (permits cellcyclemodel setup)
         SimulationTime::Instance()->SetStartTime(0.0);
 
+        //Antithetic pairs: the second seed of each pair replays the first seed's random stream with mirrored draws
+        bool mirrored = antithetic && (seed - startSeed) % 2 == 1;
+        unsigned streamSeed = mirrored ? seed - 1 : seed;
+
         //Reseed the RNG with the required seed
-        p_RNG->Reseed(seed);
+        p_RNG->Reseed(streamSeed);
 
         //Initialise a HeCellCycleModel and set it up with appropriate TiL values
         GomesCellCycleModel* p_cycle_model = new GomesCellCycleModel;
@@ -189,6 +236,12 @@ int main(int argc, char *argv[])
         p_cycle_model->SetModelParameters(normalMu, normalSigma, pPP, pPD, pBC, pAC, pMG);
         p_cycle_model->SetModelProperties(p_RPh_fate, p_AC_fate, p_BC_fate, p_MG_fate);
         if (outputMode == 2) p_cycle_model->EnableSequenceSampler(p_label);
+        if (fastRNG)
+        {
+            p_durationSampler->Reseed(streamSeed);
+            p_cycle_model->EnableFastDurationSampler(p_durationSampler);
+        }
+        if (mirrored) p_cycle_model->EnableAntitheticDraws();
         if (outputMode == 2) p_cell->AddCellProperty(p_label);
         p_cell->InitialiseCellCycleModel();
         cells.push_back(p_cell);
@@ -208,14 +261,14 @@ int main(int argc, char *argv[])
         p_simulator->SetStopProperty(p_Mitotic); //simulation to stop if no mitotic cells are left
         p_simulator->SetDt(0.25);
         p_simulator->SetEndTime(endTime);
-        p_simulator->SetOutputDirectory("UnusedSimOutput" + filenameString); //unused output
+        p_simulator->SetOutputDirectory("UnusedSimOutput" + shard.GetShardName(filenameString)); //unused output
         p_simulator->Solve();
 
         //Count lineage size
         unsigned count = cell_population->GetNumRealCells();
 
-        if (outputMode == 0) *p_log << entry_number << "\t" << seed << "\t" << count << "\n";
-        if (outputMode == 2) *p_log << "\n";
+        if (outputMode == 0) *p_events << entry_number << "\t" << seed << "\t" << count << "\n";
+        if (outputMode == 2) *p_events << "\n";
 
         //Reset for next simulation
         SimulationTime::Destroy();
@@ -227,10 +280,26 @@ int main(int argc, char *argv[])
             debugWriter->Close();
         }
 
+        //seeds run serially, so each seed's rows are merged as soon as it finishes; only one seed's rows are held
+        EventOutputBuffer::MergeToLog();
+
+        if (p_distanceBound)
+        {
+            p_distanceBound->AddLineage(count);
+            if (p_distanceBound->IsExceeded())
+            {
+                //rows so far are still written, so the partial output can be inspected
+                ExecutableSupport::Print("Count distance exceeds -abort tolerance, stopping after seed " + std::to_string(seed));
+                exit_code = CountDistanceBound::ABORT_EXIT_CODE;
+                break;
+            }
+        }
+
     }
 
     p_RNG->Destroy();
     LogFile::Close();
+    shard.GatherShardFiles(directoryString, filenameString);
 
     return exit_code;
 }
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <string>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "PetscException.hpp"
+#include "LogFile.hpp"
+
+#include "GomesGeneratingFunctionSolver.hpp"
+#include "SimulatorArguments.hpp"
+
+int main(int argc, char *argv[])
+{
+    ExecutableSupport::StartupWithoutShowingCopyright(&argc, &argv);
+    //main() returns code indicating solver run success or failure mode
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    if (CountPositionalArguments(argc, argv) != 11)
+    {
+        ExecutableSupport::PrintError(
+                "Wrong arguments for solver.\nUsage (replace<> with values):\n GomesSolver <directoryString> <filenameString> <endTimeDoubleHours> <cellCycleNormalMeanDouble> <cellCycleNormalStdDouble> <pPPDouble(0-1)> <pPDDouble(0-1)> <pBCDouble(0-1)> <pACDouble(0-1)> <pMGDouble(0-1)>\nOptions:\n-dt <double>: simulator timestep to solve for (default 0.25, as GomesSimulator)\n-max_count <unsigned>: largest count resolved (default 255)",
+                true);
+        exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        return exit_code;
+    }
+
+    /***********************
+     * SOLVER PARAMETERS
+     ***********************/
+    std::string directoryString, filenameString;
+    double endTime;
+    double normalMu, normalSigma, pPP, pPD, pBC, pAC, pMG; //stochastic model parameters
+    double dt = 0.25;
+    unsigned maxCount = 255;
+
+    //PARSE ARGUMENTS
+    directoryString = argv[1];
+    filenameString = argv[2];
+    endTime = std::stod(argv[3]);
+    normalMu = std::stod(argv[4]);
+    normalSigma = std::stod(argv[5]);
+    pPP = std::stod(argv[6]);
+    pPD = std::stod(argv[7]);
+    pBC = std::stod(argv[8]);
+    pAC = std::stod(argv[9]);
+    pMG = std::stod(argv[10]);
+    if (SimulatorOptionExists("-dt")) dt = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-dt");
+    if (SimulatorOptionExists("-max_count"))
+        maxCount = CommandLineArguments::Instance()->GetUnsignedCorrespondingToOption("-max_count");
+
+    /************************
+     * PARAMETER/ARGUMENT SANITY CHECK
+     ************************/
+    bool sane = 1;
+
+    if (endTime <= 0 || dt <= 0)
+    {
+        ExecutableSupport::PrintError("Bad endTime (argument 3) or dt. Both must be > 0");
+        sane = 0;
+    }
+
+    if (normalMu <= 0 || normalSigma <= 0)
+    {
+        ExecutableSupport::PrintError("Bad cell cycle normal mean or std (arguments 4, 5). Must be  >0");
+        sane = 0;
+    }
+
+    if (pPP + pPD > 1 || pPP > 1 || pPP < 0 || pPD > 1 || pPD < 0)
+    {
+        ExecutableSupport::PrintError(
+                "Bad mitotic mode probabilities (arguments 6, 7). pPP + pPD should be >=0, <=1, sum should not exceed 1");
+        sane = 0;
+    }
+
+    if (pBC + pAC + pMG > 1 || pBC > 1 || pBC < 0 || pAC > 1 || pAC < 0 || pMG > 1 || pMG < 0)
+    {
+        ExecutableSupport::PrintError(
+                "Bad specification probabilities (arguments 8, 9, 10). pBC, pAC, pMG should be >=0, <=1, sum should not exceed 1");
+        sane = 0;
+    }
+
+    if (sane == 0)
+    {
+        ExecutableSupport::PrintError("Exiting with bad arguments. See errors for details");
+        exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        return exit_code;
+    }
+
+    /************************
+     * SOLVE & OUTPUT
+     ************************/
+
+    GomesGeneratingFunctionSolver solver(dt, maxCount);
+    solver.SetModelParameters(normalMu, normalSigma, pPP, pPD, pBC, pAC, pMG);
+
+    std::vector<std::vector<double> > distributions;
+    distributions.push_back(solver.GetCountDistribution(GomesGeneratingFunctionSolver::CLONE_SIZE, endTime));
+    distributions.push_back(solver.GetCountDistribution(GomesGeneratingFunctionSolver::RPH_COUNT, endTime));
+    distributions.push_back(solver.GetCountDistribution(GomesGeneratingFunctionSolver::AC_COUNT, endTime));
+    distributions.push_back(solver.GetCountDistribution(GomesGeneratingFunctionSolver::BC_COUNT, endTime));
+    distributions.push_back(solver.GetCountDistribution(GomesGeneratingFunctionSolver::MG_COUNT, endTime));
+
+    LogFile* p_log = LogFile::Instance();
+    p_log->Set(0, directoryString, filenameString);
+
+    ExecutableSupport::Print("Solver writing file " + filenameString + " to directory " + directoryString);
+
+    *p_log << "Count\tP(CloneSize)\tP(RPh)\tP(AC)\tP(BC)\tP(MG)\n";
+    for (unsigned m = 0; m < solver.GetCountRange(); m++)
+    {
+        *p_log << m;
+        for (unsigned i = 0; i < distributions.size(); i++)
+        {
+            *p_log << "\t" << distributions[i][m];
+        }
+        *p_log << "\n";
+    }
+
+    LogFile::Close();
+
+    return exit_code;
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include <cmath>
 
 #include <cxxtest/TestSuite.h>
 #include "ExecutableSupport.hpp"
@@ -8,6 +9,7 @@
 #include "PetscException.hpp"
 
 #include "HeCellCycleModel.hpp"
+#include "HePolicyCellCycleModel.hpp"
 #include "OffLatticeSimulationPropertyStop.hpp"
 
 #include "AbstractCellBasedTestSuite.hpp"
@@ -23,6 +25,28 @@
 #include "VertexBasedCellPopulation.hpp"
 
 #include "ColumnDataWriter.hpp"
+#include "SimulatorSeedShard.hpp"
+#include "EventOutputBuffer.hpp"
+#include "CycleDurationSampler.hpp"
+#include "SimulatorArguments.hpp"
+#include "HeModeReweighter.hpp"
+#include "CountDistanceBound.hpp"
+#include "LowDiscrepancySequence.hpp"
+#include "LineageSnapshot.hpp"
+
+/**
+ * Instantiate the compile-time policy He model matching the simulator's output mode
+ * Used for production runs; debug output requires the runtime-configured HeCellCycleModel
+ */
+template<class MODE_POLICY>
+HeCellCycleModel* CreatePolicyModel(int outputMode)
+{
+    if (outputMode == 1)
+        return new HePolicyCellCycleModel<MODE_POLICY, HeModeEventLogOutput, HeNoSequenceSampler, HeKeepSpecified>;
+    if (outputMode == 2)
+        return new HePolicyCellCycleModel<MODE_POLICY, HeNoModeEventOutput, HeSequenceSampler, HeKeepSpecified>;
+    return new HePolicyCellCycleModel<MODE_POLICY, HeNoModeEventOutput, HeNoSequenceSampler, HeKeepSpecified>;
+}
 
 int main(int argc, char *argv[])
 {
@@ -30,10 +54,11 @@ int main(int argc, char *argv[])
     //main() returns code indicating sim run success or failure mode
     int exit_code = ExecutableSupport::EXIT_OK;
 
-    if (argc != 22 && argc != 20)
+    int positionalArgc = CountPositionalArguments(argc, argv);
+    if (positionalArgc != 22 && positionalArgc != 20)
     {
         ExecutableSupport::PrintError(
-                "Wrong arguments for simulator.\nUsage (replace<> with values, pass bools as 0 or 1):\nStochastic Mode:\nHeSimulator <directoryString> <filenameString> <outputModeUnsigned(0=counts,1=events,2=sequence)> <deterministicBool=0> <fixtureUnsigned(0=He;1=Wan;2=test)> <founderAth5Mutant?Bool> <debugOutputBool> <startSeedUnsigned> <endSeedUnsigned>  <inductionTimeDoubleHours> <earliestLineageStartDoubleHours> <latestLineageStartDoubleHours> <endTimeDoubleHours> <mMitoticModePhase2Double> <mMitoticModePhase3Double> <pPP1Double(0-1)> <pPD1Double(0-1)> <pPP1Double(0-1)> <pPD1Double(0-1)> <pPP1Double(0-1)> <pPD1Double(0-1)>\nDeterministic Mode:\nHeSimulator <directoryString> <filenameString> <outputModeUnsigned(0=counts,1=events,2=sequence)> <deterministicBool=1> <fixtureUnsigned(0=He;1=Wan;2=test)> <founderAth5Mutant?Bool> <debugOutputBool> <startSeedUnsigned> <endSeedUnsigned>  <inductionTimeDoubleHours> <earliestLineageStartDoubleHours> <latestLineageStartDoubleHours> <endTimeDoubleHours> <phase1ShapeDouble(>0)> <phase1ScaleDouble(>0)> <phase2ShapeDouble(>0)> <phase2ScaleDouble(>0)> <phaseBoundarySisterShiftWidthDouble>\n",
+                "Wrong arguments for simulator.\nUsage (replace<> with values, pass bools as 0 or 1):\nStochastic Mode:\nHeSimulator <directoryString> <filenameString> <outputModeUnsigned(0=counts,1=events,2=sequence)> <deterministicBool=0> <fixtureUnsigned(0=He;1=Wan;2=test)> <founderAth5Mutant?Bool> <debugOutputBool> <startSeedUnsigned> <endSeedUnsigned>  <inductionTimeDoubleHours> <earliestLineageStartDoubleHours> <latestLineageStartDoubleHours> <endTimeDoubleHours> <mMitoticModePhase2Double> <mMitoticModePhase3Double> <pPP1Double(0-1)> <pPD1Double(0-1)> <pPP1Double(0-1)> <pPD1Double(0-1)> <pPP1Double(0-1)> <pPD1Double(0-1)>\nDeterministic Mode:\nHeSimulator <directoryString> <filenameString> <outputModeUnsigned(0=counts,1=events,2=sequence)> <deterministicBool=1> <fixtureUnsigned(0=He;1=Wan;2=test)> <founderAth5Mutant?Bool> <debugOutputBool> <startSeedUnsigned> <endSeedUnsigned>  <inductionTimeDoubleHours> <earliestLineageStartDoubleHours> <latestLineageStartDoubleHours> <endTimeDoubleHours> <phase1ShapeDouble(>0)> <phase1ScaleDouble(>0)> <phase2ShapeDouble(>0)> <phase2ScaleDouble(>0)> <phaseBoundarySisterShiftWidthDouble>\nOptions:\n-fast_rng: draw cycle durations from the buffered CycleDurationSampler\n-gamma_table: with -fast_rng, tabulate the cycle duration gamma distribution\n-stratify: fixtures 0 & 1, spread lineage start times / TiL offsets across the seed range with a scrambled low discrepancy sequence\n-dt <double>: simulation timestep in hours (default 0.05); coarser steps give cheap coupled runs for multilevel estimates\n-antithetic: run seeds in antithetic pairs (startSeed, startSeed+1), ...; each pair's second seed replays the first's random stream with mirrored mode RVs, cycle duration quantiles & lineage start times / TiL offsets\n-tilt <double(0-1)>: stochastic counts only; importance sampling of large clones: simulate with each phase's pPP moved this fraction of the way to 1 (pPD, pDD scaled down), writing each lineage's likelihood ratio weight in a Weight column\n-reweight <alternativesFile>: stochastic counts only; also write <filename>Reweighted, count histograms reweighted to each alternative pPP1 pPD1 pPP2 pPD2 pPP3 pPD3 line in alternativesFile\n-split <splitTimeDoubleHours> <continuationsUnsigned>: counts only; fork each lineage still running at this simulation time into independent continuations, writing a row per continuation with a 1/continuations Weight column\n-split_threshold <unsigned>: with -split, only fork lineages with at least this many mitotic cells at the split time (default 1)\n-cycle <gammaShiftDouble> <gammaShapeDouble> <gammaScaleDouble> <sisterShiftDouble>: cycle duration shifted gamma & sister shift width (default 4 2 1 1)\n-abort <referenceFile> <toleranceDouble>: unweighted counts only; stop once the count RSS against the reference histogram (probabilities of counts 1,2,... in referenceFile) is certain to exceed the tolerance, exiting with code 3\n",
                 true);
         exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
         return exit_code;
@@ -49,6 +74,15 @@ int main(int argc, char *argv[])
     double inductionTime, earliestLineageStartTime, latestLineageStartTime, endTime;
     double mitoticModePhase2, mitoticModePhase3, pPP1, pPD1, pPP2, pPD2, pPP3, pPD3; //stochastic model parameters
     double phase1Shape, phase1Scale, phase2Shape, phase2Scale, phaseSisterShiftWidth, phaseOffset;
+    bool fastRNG, gammaTable, stratify, antithetic;
+    double dt = 0.05; //simulation timestep (h)
+    double tilt = 0; //importance sampling proposal tilt towards PP divisions
+    std::string reweightFilename; //alternative phase probabilities for likelihood-ratio reweighting, if any
+    double splitTime = 0; //simulation time (h) at which running lineages are forked
+    unsigned splitContinuations = 0, splitThreshold = 1; //continuations per forked lineage; minimum mitotic cells to fork
+    double gammaShift = 4, gammaShape = 2, gammaScale = 1, sisterShift = 1; //cycle duration parameters (He 2012 defaults)
+    std::string abortFilename; //reference count histogram for early abort, if any
+    double abortTolerance = 0; //count RSS above which the run is abandoned
 
     //PARSE ARGUMENTS
     directoryString = argv[1];
@@ -64,6 +98,33 @@ int main(int argc, char *argv[])
     earliestLineageStartTime = std::stod(argv[11]);
     latestLineageStartTime = std::stod(argv[12]);
     endTime = std::stod(argv[13]);
+    fastRNG = SimulatorOptionExists("-fast_rng");
+    gammaTable = SimulatorOptionExists("-gamma_table");
+    stratify = SimulatorOptionExists("-stratify");
+    antithetic = SimulatorOptionExists("-antithetic");
+    if (SimulatorOptionExists("-dt")) dt = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-dt");
+    if (SimulatorOptionExists("-tilt")) tilt = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-tilt");
+    if (SimulatorOptionExists("-reweight"))
+        reweightFilename = CommandLineArguments::Instance()->GetStringCorrespondingToOption("-reweight");
+    if (SimulatorOptionExists("-split"))
+    {
+        splitTime = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-split", 1);
+        splitContinuations = CommandLineArguments::Instance()->GetUnsignedCorrespondingToOption("-split", 2);
+    }
+    if (SimulatorOptionExists("-split_threshold"))
+        splitThreshold = CommandLineArguments::Instance()->GetUnsignedCorrespondingToOption("-split_threshold");
+    if (SimulatorOptionExists("-cycle"))
+    {
+        gammaShift = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-cycle", 1);
+        gammaShape = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-cycle", 2);
+        gammaScale = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-cycle", 3);
+        sisterShift = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-cycle", 4);
+    }
+    if (SimulatorOptionExists("-abort"))
+    {
+        abortFilename = CommandLineArguments::Instance()->GetStringCorrespondingToOption("-abort", 1);
+        abortTolerance = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-abort", 2);
+    }
 
     if (deterministicMode == 0)
     {
@@ -97,6 +158,12 @@ int main(int argc, char *argv[])
      ************************/
     bool sane = 1;
 
+    if (dt <= 0)
+    {
+        ExecutableSupport::PrintError("Bad dt option. Must be > 0");
+        sane = 0;
+    }
+
     if (outputMode != 0 && outputMode != 1 && outputMode != 2)
     {
         ExecutableSupport::PrintError(
@@ -200,6 +267,43 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (gammaShift < 0 || gammaShape <= 0 || gammaScale <= 0 || sisterShift < 0)
+    {
+        ExecutableSupport::PrintError(
+                "Bad -cycle. Shift must be >=0, cycle shape and scale params must be positive-valued, sister shift must be >=0");
+        sane = 0;
+    }
+
+    if (!reweightFilename.empty() && (deterministicMode || outputMode != 0))
+    {
+        ExecutableSupport::PrintError("-reweight requires stochastic mode (argument 4 = 0) and count output (argument 3 = 0)");
+        sane = 0;
+    }
+
+    if (tilt < 0 || tilt >= 1 || (tilt > 0 && (deterministicMode || outputMode != 0)))
+    {
+        ExecutableSupport::PrintError(
+                "Bad -tilt. Must be >=0, <1; tilted sampling requires stochastic mode (argument 4 = 0) and count output (argument 3 = 0)");
+        sane = 0;
+    }
+
+    if (SimulatorOptionExists("-split")
+            && (splitTime <= 0 || splitContinuations == 0 || splitThreshold == 0 || outputMode != 0
+                    || !reweightFilename.empty()))
+    {
+        ExecutableSupport::PrintError(
+                "Bad -split. Split time must be >0, continuations & -split_threshold >0; splitting requires count output (argument 3 = 0) and cannot be combined with -reweight");
+        sane = 0;
+    }
+
+    if (!abortFilename.empty()
+            && (abortTolerance < 0 || outputMode != 0 || tilt > 0 || splitContinuations > 0 || !reweightFilename.empty()))
+    {
+        ExecutableSupport::PrintError(
+                "Bad -abort. Tolerance must be >=0; early abort requires count output (argument 3 = 0) and cannot be combined with -tilt, -split or -reweight");
+        sane = 0;
+    }
+
     if (sane == 0)
     {
         ExecutableSupport::PrintError("Exiting with bad arguments. See errors for details");
@@ -212,22 +316,67 @@ int main(int argc, char *argv[])
      * SIMULATOR OUTPUT SETUP
      ************************/
 
+//Split the seed range across MPI ranks (one shard when run serially)
+    SimulatorSeedShard shard(startSeed, endSeed);
+
 //Set up singleton LogFile
     LogFile* p_log = LogFile::Instance();
-    p_log->Set(0, directoryString, filenameString);
+    p_log->Set(0, directoryString, shard.GetShardName(filenameString));
 
     ExecutableSupport::Print("Simulator writing file " + filenameString + " to directory " + directoryString);
 
 //Log entry counter
-    unsigned entry_number = 1;
+    unsigned entry_number = shard.GetFirstEntry();
+
+//Write appropriate headers to log (first shard only)
+    if (shard.IsFirstShard())
+    {
+        if (outputMode == 0)
+            *p_log << "Entry\tInduction Time (h)\tSeed\tCount"
+                    << (tilt > 0 || splitContinuations > 0 ? "\tWeight\n" : "\n");
+        if (outputMode == 1) *p_log << "Time (hpf)\tSeed\tCellID\tMitotic Mode (0=PP;1=PD;2=DD)\tP(PP)\tP(PD)\tP(DD)\n";
+        if (outputMode == 2) *p_log << "Entry\tSeed\tSequence\n";
+    }
 
-//Write appropriate headers to log
-    if (outputMode == 0) *p_log << "Entry\tInduction Time (h)\tSeed\tCount\n";
-    if (outputMode == 1) *p_log << "Time (hpf)\tSeed\tCellID\tMitotic Mode (0=PP;1=PD;2=DD)\n";
-    if (outputMode == 2) *p_log << "Entry\tSeed\tSequence\n";
+//Worker event buffer for seed-tagged row output (models write mode events & sequences to the same buffer)
+    EventOutputBuffer* p_events = EventOutputBuffer::Instance();
 
 //Instance RNG
     RandomNumberGenerator* p_RNG = RandomNumberGenerator::Instance();
+    //Buffered cycle duration stream, reseeded with each simulation seed
+    boost::shared_ptr<CycleDurationSampler> p_durationSampler;
+    if (fastRNG) p_durationSampler.reset(new CycleDurationSampler(startSeed));
+
+//Stratified start time / TiL covariate, indexed by the seed's position in the full seed range
+    LowDiscrepancySequence covariateSequence(startSeed);
+
+//Tilted sampling: lineages are simulated under a PP-boosted proposal & weighted back to the target probabilities
+    std::vector<double> targetProbabilities, simulatedProbabilities;
+    if (!deterministicMode)
+    {
+        targetProbabilities = { pPP1, pPD1, pPP2, pPD2, pPP3, pPD3 };
+        simulatedProbabilities = HeModeLikelihoodRecorder::GetTiltedProbabilities(targetProbabilities, tilt);
+    }
+
+//Likelihood-ratio reweighting: each lineage's mitotic mode decisions are recorded & weighted to the alternatives
+    boost::shared_ptr<HeModeLikelihoodRecorder> p_likelihoodRecorder;
+    boost::shared_ptr<HeModeReweighter> p_reweighter;
+    if (tilt > 0) p_likelihoodRecorder.reset(new HeModeLikelihoodRecorder);
+    if (!reweightFilename.empty())
+    {
+        //weights are relative to the simulated (proposal) probabilities, so reweighting composes with tilting
+        p_likelihoodRecorder.reset(new HeModeLikelihoodRecorder);
+        p_reweighter.reset(new HeModeReweighter(simulatedProbabilities, ath5founder));
+        p_reweighter->ReadAlternatives(reweightFilename);
+    }
+
+//Early abort: the run stops once its count histogram cannot come within the tolerance of the reference
+    boost::shared_ptr<CountDistanceBound> p_distanceBound;
+    if (!abortFilename.empty())
+    {
+        p_distanceBound.reset(new CountDistanceBound(endSeed - startSeed + 1, abortTolerance));
+        p_distanceBound->ReadReference(abortFilename);
+    }
 
 //Initialise pointers to relevant singleton ProliferativeTypes and Properties
     MAKE_PTR(WildTypeCellMutationState, p_state);
@@ -235,15 +384,19 @@ int main(int argc, char *argv[])
     MAKE_PTR(DifferentiatedCellProliferativeType, p_PostMitotic);
     MAKE_PTR(Ath5Mo, p_Morpholino);
     MAKE_PTR(CellLabel, p_label);
+    //properties carried onto the cells of forked lineages
+    std::vector<boost::shared_ptr<AbstractCellProperty> > carriedProperties = { p_Morpholino, p_label };
 
     /************************
      * SIMULATOR SETUP & RUN
      ************************/
 
 //iterate through supplied seed range, executing one simulation per seed
-    for (unsigned seed = startSeed; seed <= endSeed; seed++)
+    for (unsigned seed = shard.GetStartSeed(); seed < shard.GetStopSeed(); seed++)
     {
-        if (outputMode == 2) *p_log << entry_number << "\t" << seed << "\t"; //write seed to log - sequence written by cellcyclemodel objects
+        //rows for this seed go to the worker's event buffer, merged into the log in seed order
+        p_events->BeginSeed(seed);
+        if (outputMode == 2) *p_events << entry_number << "\t" << seed << "\t"; //write seed to log - sequence written by cellcyclemodel objects
 
         //initialise pointer to debugWriter
         ColumnDataWriter* debugWriter;
@@ -251,11 +404,36 @@ int main(int argc, char *argv[])
         //initialise SimulationTime (permits cellcyclemodel setup)
         SimulationTime::Instance()->SetStartTime(0.0);
 
+        //Antithetic pairs: the second seed of each pair replays the first seed's random stream with mirrored draws
+        //pairs are keyed on the full seed range, so shards may split a pair without changing either lineage
+        unsigned streamSeed = seed;
+        unsigned covariateIndex = seed - startSeed;
+        bool mirrored = false;
+        if (antithetic)
+        {
+            mirrored = (seed - startSeed) % 2 == 1;
+            streamSeed = mirrored ? seed - 1 : seed;
+            covariateIndex = (seed - startSeed) / 2;
+        }
+
         //Reseed the RNG with the required seed
-        p_RNG->Reseed(seed);
+        p_RNG->Reseed(streamSeed);
 
         //Initialise a HeCellCycleModel and set it up with appropriate TiL values
-        HeCellCycleModel* p_cycle_model = new HeCellCycleModel;
+        //production runs use the policy model for the requested mode; debug output needs the runtime-configured model
+        HeCellCycleModel* p_cycle_model;
+        if (debugOutput)
+        {
+            p_cycle_model = new HeCellCycleModel;
+        }
+        else if (deterministicMode)
+        {
+            p_cycle_model = CreatePolicyModel<HeDeterministicMode>(outputMode);
+        }
+        else
+        {
+            p_cycle_model = CreatePolicyModel<HeStochasticMode>(outputMode);
+        }
 
         if (debugOutput)
         {
@@ -277,7 +455,11 @@ int main(int argc, char *argv[])
         if (fixture == 0) //He 2012-type fixture - even distribution across nasal-temporal axis
         {
             //generate lineage start time from even random distro across earliest-latest start time figures
-            lineageStartTime = (p_RNG->ranf() * (latestLineageStartTime - earliestLineageStartTime))
+            //the RNG draw is made either way, so stratification leaves the rest of each seed's random sequence unchanged
+            double startTimeRV = p_RNG->ranf();
+            if (stratify) startTimeRV = covariateSequence.GetSample(covariateIndex);
+            if (mirrored) startTimeRV = 1.0 - startTimeRV;
+            lineageStartTime = (startTimeRV * (latestLineageStartTime - earliestLineageStartTime))
                     + earliestLineageStartTime;
             //this reflects induction of cells after the lineages' first mitosis
             if (lineageStartTime < inductionTime)
@@ -301,8 +483,11 @@ int main(int argc, char *argv[])
         //this allows investigation of different assumptions about how Wan et al.'s model output was generated
         {
             //generate random lineage start time from even random distro across CMZ residency time
-            currTiL = p_RNG->ranf() * latestLineageStartTime;
-            currSimEndTime = std::max(.05, endTime - currTiL); //minimum 1 timestep, prevents 0 timestep SimulationTime error
+            double tiLRV = p_RNG->ranf();
+            if (stratify) tiLRV = covariateSequence.GetSample(covariateIndex);
+            if (mirrored) tiLRV = 1.0 - tiLRV;
+            currTiL = tiLRV * latestLineageStartTime;
+            currSimEndTime = std::max(dt, endTime - currTiL); //minimum 1 timestep, prevents 0 timestep SimulationTime error
             if (outputMode == 1) p_cycle_model->EnableModeEventOutput(0, seed);
         }
         else if (fixture == 2) //validation fixture- all founders have TiL given by induction time
@@ -317,8 +502,11 @@ int main(int argc, char *argv[])
 
         if (!deterministicMode)
         {
-            p_cycle_model->SetModelParameters(currTiL, mitoticModePhase2, mitoticModePhase2 + mitoticModePhase3, pPP1,
-                                              pPD1, pPP2, pPD2, pPP3, pPD3);
+            p_cycle_model->SetModelParameters(currTiL, mitoticModePhase2, mitoticModePhase2 + mitoticModePhase3,
+                                              simulatedProbabilities[0], simulatedProbabilities[1],
+                                              simulatedProbabilities[2], simulatedProbabilities[3],
+                                              simulatedProbabilities[4], simulatedProbabilities[5], gammaShift,
+                                              gammaShape, gammaScale, sisterShift);
         }
         else
         {
@@ -326,11 +514,26 @@ int main(int argc, char *argv[])
             double currPhase2Boundary = phaseOffset + p_RNG->GammaRandomDeviate(phase1Shape, phase1Scale);
             double currPhase3Boundary = currPhase2Boundary + p_RNG->GammaRandomDeviate(phase2Shape, phase2Scale);
 
-            p_cycle_model->SetDeterministicMode(currTiL, currPhase2Boundary, currPhase3Boundary, phaseSisterShiftWidth);
+            p_cycle_model->SetDeterministicMode(currTiL, currPhase2Boundary, currPhase3Boundary, phaseSisterShiftWidth,
+                                                gammaShift, gammaShape, gammaScale, sisterShift);
         }
 
         if (outputMode == 2) p_cycle_model->EnableSequenceSampler();
 
+        if (fastRNG)
+        {
+            p_durationSampler->Reseed(streamSeed);
+            p_cycle_model->EnableFastDurationSampler(p_durationSampler, gammaTable);
+        }
+
+        if (antithetic) p_cycle_model->EnableAntitheticDraws(mirrored);
+
+        if (p_likelihoodRecorder)
+        {
+            p_likelihoodRecorder->Reset();
+            p_cycle_model->EnableLikelihoodRecorder(p_likelihoodRecorder);
+        }
+
         //Setup vector containing lineage founder with the properly set up cell cycle model
         std::vector<CellPtr> cells;
         CellPtr p_cell(new Cell(p_state, p_cycle_model));
@@ -353,18 +556,94 @@ int main(int argc, char *argv[])
         boost::shared_ptr<OffLatticeSimulationPropertyStop<2>> p_simulator(
                 new OffLatticeSimulationPropertyStop<2>(*cell_population));
         p_simulator->SetStopProperty(p_Mitotic); //simulation to stop if no mitotic cells are left
-        p_simulator->SetDt(0.05);
-        p_simulator->SetEndTime(currSimEndTime);
-        p_simulator->SetOutputDirectory("UnusedSimOutput" + filenameString); //unused output
+        p_simulator->SetDt(dt);
+        //Lineage splitting: lineages are solved to the split time, then forked into independent continuations
+        bool splitLineage = splitContinuations > 0 && splitTime < currSimEndTime;
+        p_simulator->SetEndTime(splitLineage ? splitTime : currSimEndTime);
+        p_simulator->SetOutputDirectory("UnusedSimOutput" + shard.GetShardName(filenameString)); //unused output
         p_simulator->Solve();
 
-        //Count lineage size
-        unsigned count = cell_population->GetNumRealCells();
+        //Count lineage size & weight: one row per lineage, or per continuation of a forked lineage
+        std::vector<unsigned> counts;
+        std::vector<double> weights;
+
+        boost::shared_ptr<LineageSnapshot> p_snapshot;
+        if (splitLineage) p_snapshot.reset(new LineageSnapshot(*cell_population, carriedProperties));
+
+        if (p_snapshot && p_snapshot->GetNumProliferativeCells() >= splitThreshold)
+        {
+            //each continuation restarts from the lineage's mode decisions up to the split
+            HeModeLikelihoodRecorder splitRecord;
+            if (p_likelihoodRecorder) splitRecord = *p_likelihoodRecorder;
+
+            for (unsigned k = 0; k < splitContinuations; k++)
+            {
+                //restart SimulationTime at the split & give the continuation its own RNG substream
+                SimulationTime::Destroy();
+                SimulationTime::Instance()->SetStartTime(splitTime);
+                unsigned continuationSeed = LineageSnapshot::GetContinuationSeed(streamSeed, k);
+                p_RNG->Reseed(continuationSeed);
+                if (fastRNG) p_durationSampler->Reseed(continuationSeed);
+                if (p_likelihoodRecorder) *p_likelihoodRecorder = splitRecord;
+
+                std::vector<CellPtr> forkedCells = p_snapshot->CreateCells(p_state);
+                HoneycombMeshGenerator forkGenerator(1, forkedCells.size());
+                NodesOnlyMesh<2> forkMesh;
+                forkMesh.ConstructNodesWithoutMesh(*forkGenerator.GetMesh(), 1.5);
+                NodeBasedCellPopulation<2> forkPopulation(forkMesh, forkedCells);
+
+                //forked cycle models are already initialised
+                OffLatticeSimulationPropertyStop<2> forkSimulator(forkPopulation, false, false);
+                forkSimulator.SetStopProperty(p_Mitotic);
+                forkSimulator.SetDt(dt);
+                forkSimulator.SetEndTime(currSimEndTime);
+                forkSimulator.SetOutputDirectory("UnusedSimOutput" + shard.GetShardName(filenameString));
+                forkSimulator.Solve();
+
+                double weight = 1.0 / splitContinuations;
+                if (tilt > 0)
+                {
+                    weight *= exp(p_likelihoodRecorder->GetLogLikelihood(targetProbabilities, ath5founder)
+                            - p_likelihoodRecorder->GetLogLikelihood(simulatedProbabilities, ath5founder));
+                }
+                counts.push_back(p_snapshot->GetPostMitoticCount() + forkPopulation.GetNumRealCells());
+                weights.push_back(weight);
+            }
+        }
+        else
+        {
+            //lineages below the split threshold run on unforked
+            if (p_snapshot && p_snapshot->GetNumProliferativeCells() > 0)
+            {
+                p_simulator->SetEndTime(currSimEndTime);
+                p_simulator->Solve();
+            }
 
-        if (outputMode == 0) *p_log << entry_number << "\t" << inductionTime << "\t" << seed << "\t" << count << "\n";
-        if (outputMode == 2) *p_log << "\n";
+            double weight = 1.0;
+            if (tilt > 0)
+            {
+                //likelihood ratio of the lineage's mitotic modes, target / proposal
+                weight = exp(p_likelihoodRecorder->GetLogLikelihood(targetProbabilities, ath5founder)
+                        - p_likelihoodRecorder->GetLogLikelihood(simulatedProbabilities, ath5founder));
+            }
+            counts.push_back(cell_population->GetNumRealCells());
+            weights.push_back(weight);
+        }
+
+        if (outputMode == 0)
+        {
+            for (unsigned i = 0; i < counts.size(); i++)
+            {
+                *p_events << entry_number << "\t" << inductionTime << "\t" << seed << "\t" << counts[i];
+                if (tilt > 0 || splitContinuations > 0) *p_events << "\t" << weights[i];
+                *p_events << "\n";
+            }
+        }
+        if (outputMode == 2) *p_events << "\n";
+        if (p_reweighter) p_reweighter->AddLineage(*p_likelihoodRecorder, counts[0]);
 
         //Reset for next simulation
+        p_snapshot.reset();
         SimulationTime::Destroy();
         delete cell_population;
         entry_number++;
@@ -374,10 +653,27 @@ int main(int argc, char *argv[])
             debugWriter->Close();
         }
 
+        //seeds run serially, so each seed's rows are merged as soon as it finishes; only one seed's rows are held
+        EventOutputBuffer::MergeToLog();
+
+        if (p_distanceBound)
+        {
+            p_distanceBound->AddLineage(counts[0]);
+            if (p_distanceBound->IsExceeded())
+            {
+                //rows so far are still written, so the partial output can be inspected
+                ExecutableSupport::Print("Count distance exceeds -abort tolerance, stopping after seed " + std::to_string(seed));
+                exit_code = CountDistanceBound::ABORT_EXIT_CODE;
+                break;
+            }
+        }
+
     }
 
     p_RNG->Destroy();
     LogFile::Close();
+    shard.GatherShardFiles(directoryString, filenameString);
+    if (p_reweighter) p_reweighter->WriteSummary(directoryString, filenameString + "Reweighted");
 
     return exit_code;
 }
@@ -0,0 +1,188 @@
+#include <iostream>
+#include <string>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "PetscException.hpp"
+#include "LogFile.hpp"
+
+#include "HeMasterEquationSolver.hpp"
+#include "SimulatorArguments.hpp"
+
+int main(int argc, char *argv[])
+{
+    ExecutableSupport::StartupWithoutShowingCopyright(&argc, &argv);
+    //main() returns code indicating solver run success or failure mode
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    if (CountPositionalArguments(argc, argv) != 17)
+    {
+        ExecutableSupport::PrintError(
+                "Wrong arguments for solver.\nUsage (replace<> with values, pass bools as 0 or 1):\n HeSolver <directoryString> <filenameString> <fixtureUnsigned(0=He;2=test)> <founderAth5Mutant?Bool> <inductionTimeDoubleHours> <earliestLineageStartDoubleHours> <latestLineageStartDoubleHours> <endTimeDoubleHours> <mMitoticModePhase2Double> <mMitoticModePhase3Double> <pPP1Double(0-1)> <pPD1Double(0-1)> <pPP2Double(0-1)> <pPD2Double(0-1)> <pPP3Double(0-1)> <pPD3Double(0-1)>\nArguments as HeSimulator's stochastic mode. Writes <filename> (count probabilities) and <filename>Rates (expected PP/PD/DD events per lineage per hour)\nOptions:\n-dt <double>: solver timestep (default 0.25; HeSimulator uses 0.05)\n-max_count <unsigned>: largest count resolved (default 255)\n-start_nodes <unsigned>: fixture 0 lineage start time quadrature nodes (default 32)\n-cycle <gammaShiftDouble> <gammaShapeDouble> <gammaScaleDouble> <sisterShiftDouble>: cycle duration shifted gamma & sister shift width (default 4 2 1 1)",
+                true);
+        exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        return exit_code;
+    }
+
+    /***********************
+     * SOLVER PARAMETERS
+     ***********************/
+    std::string directoryString, filenameString;
+    unsigned fixture;
+    bool ath5founder;
+    double inductionTime, earliestLineageStartTime, latestLineageStartTime, endTime;
+    double mitoticModePhase2, mitoticModePhase3, pPP1, pPD1, pPP2, pPD2, pPP3, pPD3; //stochastic model parameters
+    double gammaShift = 4, gammaShape = 2, gammaScale = 1, sisterShift = 1; //cycle duration parameters (He 2012 defaults)
+    double dt = 0.25;
+    unsigned maxCount = 255;
+    unsigned startNodes = 32;
+
+    //PARSE ARGUMENTS
+    directoryString = argv[1];
+    filenameString = argv[2];
+    fixture = std::stoul(argv[3]);
+    ath5founder = std::stoul(argv[4]);
+    inductionTime = std::stod(argv[5]);
+    earliestLineageStartTime = std::stod(argv[6]);
+    latestLineageStartTime = std::stod(argv[7]);
+    endTime = std::stod(argv[8]);
+    mitoticModePhase2 = std::stod(argv[9]);
+    mitoticModePhase3 = std::stod(argv[10]);
+    pPP1 = std::stod(argv[11]);
+    pPD1 = std::stod(argv[12]);
+    pPP2 = std::stod(argv[13]);
+    pPD2 = std::stod(argv[14]);
+    pPP3 = std::stod(argv[15]);
+    pPD3 = std::stod(argv[16]);
+    if (SimulatorOptionExists("-dt")) dt = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-dt");
+    if (SimulatorOptionExists("-max_count"))
+        maxCount = CommandLineArguments::Instance()->GetUnsignedCorrespondingToOption("-max_count");
+    if (SimulatorOptionExists("-start_nodes"))
+        startNodes = CommandLineArguments::Instance()->GetUnsignedCorrespondingToOption("-start_nodes");
+    if (SimulatorOptionExists("-cycle"))
+    {
+        gammaShift = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-cycle", 1);
+        gammaShape = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-cycle", 2);
+        gammaScale = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-cycle", 3);
+        sisterShift = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-cycle", 4);
+    }
+
+    /************************
+     * PARAMETER/ARGUMENT SANITY CHECK
+     ************************/
+    bool sane = 1;
+
+    if (fixture != 0 && fixture != 2)
+    {
+        ExecutableSupport::PrintError("Bad fixture (argument 3). Must be 0 (He) or 2 (validation/test)");
+        sane = 0;
+    }
+
+    if (inductionTime >= endTime)
+    {
+        ExecutableSupport::PrintError("Bad inductionTime (argument 5). Must be <endTime(arg8)");
+        sane = 0;
+    }
+    if (fixture == 0 && (earliestLineageStartTime >= endTime || earliestLineageStartTime >= latestLineageStartTime))
+    {
+        ExecutableSupport::PrintError(
+                "Bad earliestLineageStartTime (argument 6). Must be <endTime(arg8), <latestLineageStarTime (arg7)");
+        sane = 0;
+    }
+    if (fixture == 0 && latestLineageStartTime > endTime)
+    {
+        ExecutableSupport::PrintError("Bad latestLineageStartTime (argument 7). Must be <=endTime(arg8)");
+        sane = 0;
+    }
+
+    if (mitoticModePhase2 < 0 || mitoticModePhase3 < 0)
+    {
+        ExecutableSupport::PrintError("Bad mitoticModePhase2 or mitoticModePhase3 (arguments 9, 10). Must be >0");
+        sane = 0;
+    }
+    if (pPP1 + pPD1 > 1 || pPP1 > 1 || pPP1 < 0 || pPD1 > 1 || pPD1 < 0)
+    {
+        ExecutableSupport::PrintError(
+                "Bad phase 1 probabilities (arguments 11, 12). pPP1 + pPD1 should be >=0, <=1, sum should not exceed 1");
+        sane = 0;
+    }
+    if (pPP2 + pPD2 > 1 || pPP2 > 1 || pPP2 < 0 || pPD2 > 1 || pPD2 < 0)
+    {
+        ExecutableSupport::PrintError(
+                "Bad phase 2 probabilities (arguments 13, 14). pPP2 + pPD2 should be >=0, <=1, sum should not exceed 1");
+        sane = 0;
+    }
+    if (pPP3 + pPD3 > 1 || pPP3 > 1 || pPP3 < 0 || pPD3 > 1 || pPD3 < 0)
+    {
+        ExecutableSupport::PrintError(
+                "Bad phase 3 probabilities (arguments 15, 16). pPP3 + pPD3 should be >=0, <=1, sum should not exceed 1");
+        sane = 0;
+    }
+
+    if (gammaShift < 0 || gammaShape <= 0 || gammaScale <= 0 || sisterShift < 0)
+    {
+        ExecutableSupport::PrintError(
+                "Bad -cycle. Shift must be >=0, cycle shape and scale params must be positive-valued, sister shift must be >=0");
+        sane = 0;
+    }
+
+    if (dt <= 0 || startNodes == 0)
+    {
+        ExecutableSupport::PrintError("Bad dt or start_nodes option. Must be >0");
+        sane = 0;
+    }
+
+    if (sane == 0)
+    {
+        ExecutableSupport::PrintError("Exiting with bad arguments. See errors for details");
+        exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        return exit_code;
+    }
+
+    /************************
+     * SOLVE & OUTPUT
+     ************************/
+
+    HeMasterEquationSolver solver(dt, maxCount);
+    //phase 3 boundary is given as phase 2's length, as HeSimulator
+    solver.SetModelParameters(mitoticModePhase2, mitoticModePhase2 + mitoticModePhase3, pPP1, pPD1, pPP2, pPD2, pPP3,
+                              pPD3, gammaShift, gammaShape, gammaScale, sisterShift);
+    solver.SetAth5Founder(ath5founder);
+
+    if (fixture == 0)
+    {
+        solver.SolveHeFixture(inductionTime, earliestLineageStartTime, latestLineageStartTime, endTime, startNodes);
+    }
+    else
+    {
+        solver.SolveValidationFixture(inductionTime, endTime);
+    }
+
+    ExecutableSupport::Print("Solver writing files " + filenameString + ", " + filenameString + "Rates to directory "
+            + directoryString);
+
+    LogFile* p_log = LogFile::Instance();
+    p_log->Set(0, directoryString, filenameString);
+    const std::vector<double>& r_counts = solver.rGetCountDistribution();
+    *p_log << "Count\tProbability\n";
+    for (unsigned m = 0; m < r_counts.size(); m++)
+    {
+        *p_log << m << "\t" << r_counts[m] << "\n";
+    }
+    LogFile::Close();
+
+    p_log = LogFile::Instance();
+    p_log->Set(0, directoryString, filenameString + "Rates");
+    const std::vector<std::vector<double> >& r_rates = solver.rGetModeRates();
+    if (fixture == 0) *p_log << "Time (hpf)\tPP/h\tPD/h\tDD/h\n";
+    if (fixture == 2) *p_log << "Time (h)\tPP/h\tPD/h\tDD/h\n";
+    for (unsigned hour = 0; hour < r_rates.size(); hour++)
+    {
+        *p_log << solver.GetRateStartHour() + hour << "\t" << r_rates[hour][0] << "\t" << r_rates[hour][1] << "\t"
+                << r_rates[hour][2] << "\n";
+    }
+    LogFile::Close();
+
+    return exit_code;
+}
@@ -9,6 +9,7 @@
 
 #include "WanStemCellCycleModel.hpp"
 #include "HeCellCycleModel.hpp"
+#include "HePolicyCellCycleModel.hpp"
 #include "OffLatticeSimulationPropertyStop.hpp"
 
 #include "AbstractCellBasedTestSuite.hpp"
@@ -25,6 +26,10 @@
 #include "VertexBasedCellPopulation.hpp"
 
 #include "CellProliferativeTypesCountWriter.hpp"
+#include "CycleDurationSampler.hpp"
+#include "SimulatorArguments.hpp"
+#include "LowDiscrepancySequence.hpp"
+#include "SimulatorSeedShard.hpp"
 
 int main(int argc, char *argv[])
 {
@@ -32,10 +37,10 @@ int main(int argc, char *argv[])
     //main() returns code indicating sim run success or failure mode
     int exit_code = ExecutableSupport::EXIT_OK;
 
-    if (argc != 23)
+    if (CountPositionalArguments(argc, argv) != 23)
     {
         ExecutableSupport::PrintError(
-                "Wrong arguments for simulator.\nUsage (replace<> with values, pass bools as 0 or 1):\n WanSimulator <directoryString> <startSeedUnsigned> <endSeedUnsigned> <cmzResidencyTimeDoubleHours> <stemDivisorDouble> <meanProgenitorPopualtion@3dpfDouble> <stdProgenitorPopulation@3dpfDouble> <stemGammaShiftDouble> <stemGammaShapeDouble> <stemGammaScaleDouble> <progenitorGammaShiftDouble> <progenitorGammaShapeDouble> <progenitorGammaScaleDouble> <progenitorSisterShiftDouble> <mMitoticModePhase2Double> <mMitoticModePhase3Double> <pPP1Double(0-1)> <pPD1Double(0-1)> <pPP1Double(0-1)> <pPD1Double(0-1)> <pPP1Double(0-1)> <pPD1Double(0-1)>",
+                "Wrong arguments for simulator.\nUsage (replace<> with values, pass bools as 0 or 1):\n WanSimulator <directoryString> <startSeedUnsigned> <endSeedUnsigned> <cmzResidencyTimeDoubleHours> <stemDivisorDouble> <meanProgenitorPopualtion@3dpfDouble> <stdProgenitorPopulation@3dpfDouble> <stemGammaShiftDouble> <stemGammaShapeDouble> <stemGammaScaleDouble> <progenitorGammaShiftDouble> <progenitorGammaShapeDouble> <progenitorGammaScaleDouble> <progenitorSisterShiftDouble> <mMitoticModePhase2Double> <mMitoticModePhase3Double> <pPP1Double(0-1)> <pPD1Double(0-1)> <pPP1Double(0-1)> <pPD1Double(0-1)> <pPP1Double(0-1)> <pPD1Double(0-1)>\nOptions:\n-fast_rng: draw cycle durations from the buffered CycleDurationSampler\n-gamma_table: with -fast_rng, tabulate the progenitor cycle duration gamma distribution\n-dt <double>: simulation timestep in hours (default 1); coarser steps give cheap coupled runs for multilevel estimates\n-stratify: spread progenitor TiLs across the CMZ residency time with a scrambled low discrepancy sequence",
                 true);
         exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
         return exit_code;
@@ -51,6 +56,8 @@ int main(int argc, char *argv[])
     double stemGammaShift, stemGammaShape, stemGammaScale, progenitorGammaShift, progenitorGammaShape,
             progenitorGammaScale, progenitorGammaSister;
     double mitoticModePhase2, mitoticModePhase3, pPP1, pPD1, pPP2, pPD2, pPP3, pPD3; //stochastic He model parameters
+    bool fastRNG, gammaTable, stratify;
+    double dt = 1; //simulation timestep (h)
 
     //PARSE ARGUMENTS
     directoryString = argv[1];
@@ -78,6 +85,10 @@ int main(int argc, char *argv[])
     pPD2 = std::stod(argv[20]);
     pPP3 = std::stod(argv[21]);
     pPD3 = std::stod(argv[22]);
+    fastRNG = SimulatorOptionExists("-fast_rng");
+    gammaTable = SimulatorOptionExists("-gamma_table");
+    stratify = SimulatorOptionExists("-stratify");
+    if (SimulatorOptionExists("-dt")) dt = CommandLineArguments::Instance()->GetDoubleCorrespondingToOption("-dt");
 
     std::vector<double> stemOffspringParams = { mitoticModePhase2, mitoticModePhase2 + mitoticModePhase3, pPP1, pPD1,
                                                 pPP2, pPD2, pPP3, pPD3, progenitorGammaShift, progenitorGammaShape,
@@ -88,6 +99,12 @@ int main(int argc, char *argv[])
      ************************/
     bool sane = 1;
 
+    if (dt <= 0)
+    {
+        ExecutableSupport::PrintError("Bad dt option. Must be > 0");
+        sane = 0;
+    }
+
     if (endSeed < startSeed)
     {
         ExecutableSupport::PrintError("Bad start & end seeds (arguments, 3, 4). endSeed must not be < startSeed");
@@ -168,8 +185,18 @@ int main(int argc, char *argv[])
 
     ExecutableSupport::Print("Simulator writing files to directory " + directoryString);
 
+//Split the seed range across MPI ranks (one shard when run serially); per-seed output directories need no gather
+    SimulatorSeedShard shard(startSeed, endSeed);
+
 //Instance RNG
     RandomNumberGenerator* p_RNG = RandomNumberGenerator::Instance();
+    //Buffered cycle duration stream, reseeded with each simulation seed; the table covers the progenitor majority
+    boost::shared_ptr<CycleDurationSampler> p_durationSampler;
+    if (fastRNG)
+    {
+        p_durationSampler.reset(new CycleDurationSampler(startSeed));
+        if (gammaTable) p_durationSampler->SetGammaTable(progenitorGammaShape, progenitorGammaScale);
+    }
 
 //Initialise pointers to relevant singleton ProliferativeTypes and Properties
     boost::shared_ptr<AbstractCellProperty> p_state(CellPropertyRegistry::Instance()->Get<WildTypeCellMutationState>());
@@ -180,13 +207,14 @@ int main(int argc, char *argv[])
             CellPropertyRegistry::Instance()->Get<DifferentiatedCellProliferativeType>());
 
 //iterate through supplied seed range, executing one simulation per seed
-    for (unsigned seed = startSeed; seed <= endSeed; seed++)
+    for (unsigned seed = shard.GetStartSeed(); seed < shard.GetStopSeed(); seed++)
     {
         //initialise SimulationTime (permits cellcyclemodel setup)
         SimulationTime::Instance()->SetStartTime(0.0);
 
         //Reseed the RNG with the required seed
         p_RNG->Reseed(seed);
+        if (fastRNG) p_durationSampler->Reseed(seed);
 
         //unsigned numberStem = int(std::round(p_RNG->NormalRandomDeviate(stemMean, stemStd)));
         unsigned numberProgenitors = int(std::round(p_RNG->NormalRandomDeviate(progenitorMean, progenitorStd)));
@@ -195,11 +223,15 @@ int main(int argc, char *argv[])
         std::vector<CellPtr> stems;
         std::vector<CellPtr> cells;
 
+        //progenitor TiLs stratified within each seed's population
+        LowDiscrepancySequence tiLSequence(seed);
+
         for (unsigned i = 0; i < numberStem; i++)
         {
             WanStemCellCycleModel* p_stem_model = new WanStemCellCycleModel;
             p_stem_model->SetDimension(2);
             p_stem_model->SetModelParameters(stemGammaShift, stemGammaShape, stemGammaScale, stemOffspringParams);
+            if (fastRNG) p_stem_model->EnableFastDurationSampler(p_durationSampler);
 
             CellPtr p_cell(new Cell(p_state, p_stem_model));
             p_cell->InitialiseCellCycleModel();
@@ -209,13 +241,18 @@ int main(int argc, char *argv[])
 
         for (unsigned i = 0; i < numberProgenitors; i++)
         {
-            double currTiL = p_RNG->ranf() * cmzResidencyTime;
+            //the RNG draw is made either way, so stratification leaves the rest of each seed's random sequence unchanged
+            double tiLRV = p_RNG->ranf();
+            if (stratify) tiLRV = tiLSequence.GetSample(i);
+            double currTiL = tiLRV * cmzResidencyTime;
 
-            HeCellCycleModel* p_prog_model = new HeCellCycleModel;
+            HeCellCycleModel* p_prog_model = new HePolicyCellCycleModel<HeStochasticMode, HeNoModeEventOutput,
+                    HeNoSequenceSampler, HeKillSpecified>;
             p_prog_model->SetDimension(2);
             p_prog_model->SetModelParameters(currTiL, mitoticModePhase2, mitoticModePhase2 + mitoticModePhase3, pPP1,
                                              pPD1, pPP2, pPD2, pPP3, pPD3);
             p_prog_model->EnableKillSpecified();
+            if (fastRNG) p_prog_model->EnableFastDurationSampler(p_durationSampler);
 
             CellPtr p_cell(new Cell(p_state, p_prog_model));
             p_cell->InitialiseCellCycleModel();
@@ -243,7 +280,7 @@ int main(int argc, char *argv[])
         boost::shared_ptr<OffLatticeSimulationPropertyStop<2>> p_simulator(
                 new OffLatticeSimulationPropertyStop<2>(*cell_population));
         p_simulator->SetStopProperty(p_Transit); //simulation to stop if no RPCs are left
-        p_simulator->SetDt(1);
+        p_simulator->SetDt(dt);
         p_simulator->SetOutputDirectory(directoryString + "/Seed" + std::to_string(seed) + "Results");
         p_simulator->SetEndTime(8568); // 360dpf - 3dpf simulation start time
         p_simulator->Solve();
@@ -0,0 +1,331 @@
+import multiprocessing
+import os
+import subprocess
+import datetime
+import pickle
+import shutil
+
+import numpy as np
+
+from fixture_loss import count_prob_list, count_rss, load_rates, rate_rss
+
+###########################################################################
+# ABC-SMC POSTERIOR INFERENCE
+# Approximate Bayesian computation by sequential Monte Carlo (Beaumont et al. 2009) for the stochastic He,
+# deterministic He, Gomes or Boije model parameters. Generation 0 draws particles from uniform priors; each later
+# generation resamples the previous population by weight, perturbs with a Gaussian kernel (twice the weighted
+# population covariance) & keeps particles whose simulated histograms lie within the current tolerance of the
+# empirical ones. Tolerances are a quantile of the previous generation's distances.
+# The distance is the residual sum of squares against the empirical histograms, summed over components: the He mode
+# rate histograms, then each induction time's count histogram (Gomes & Boije: the 24 h count histogram only). Each
+# particle's component simulations run in sequence, and a particle is abandoned as soon as its partial distance
+# exceeds the tolerance, so poor particles cost only their first components. Count simulations are also passed the
+# remaining tolerance with -abort: the simulator stops partway through its seeds once the count distance is certain to
+# exceed it (exit code 3). Particles run in parallel, one per cpu.
+# The sampler state is checkpointed after each batch of particles; set resume = 1 to continue from the checkpoint.
+###########################################################################
+
+he_executable = '/home/main/chaste_build/projects/ISP/apps/HeSimulator'
+gomes_executable = '/home/main/chaste_build/projects/ISP/apps/GomesSimulator'
+boije_executable = '/home/main/chaste_build/projects/ISP/apps/BoijeSimulator'
+output_root = '/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/'
+
+model = 0 #0=stochastic He;1=deterministic He;2=Gomes;3=Boije
+deterministic_mode = 1 if model == 1 else 0
+
+if model == 0 or model == 1: executable = he_executable
+if model == 2: executable = gomes_executable
+if model == 3: executable = boije_executable
+
+if not(os.path.isfile(executable)):
+    raise Exception('Could not find executable: ' + executable)
+
+#####################
+# ABC-SMC SETTINGS
+#####################
+
+number_particles = 200
+max_generations = 15
+tolerance_quantile = 0.5 #next tolerance: this quantile of the current generation's distances
+min_acceptance_rate = 0.01 #stop once fewer proposals than this are accepted
+kernel_scale = 2.0 #perturbation kernel covariance, in weighted population covariances
+abc_seed = 786 #traceable RNG
+resume = 0 #1=continue from the checkpoint
+keep_particle_output = 0 #0=delete each particle's simulator output once scored
+simulator_abort = 1 #1=count simulations stop early once the particle's distance must exceed the tolerance
+aborted_exit_code = 3 #simulator exit code for runs stopped by -abort
+
+#########################
+# SIMULATION PARAMETERS
+#########################
+
+start_seed = 0
+end_seed = 999
+rate_end_seed = 249
+directory_name = "ABCSMC"
+log_name = "ABCSMCOutput"
+checkpoint_name = "ABCSMCCheckpoint"
+reference_name = "ABCSMCReference" #empirical count histograms, read by the simulators' -abort option
+fixture = 0 #0=He 2012;1=Wan 2016
+ath5founder = 0
+
+earliest_lineage_start_time = 23.0
+latest_lineage_start_time = 39.0
+induction_times = [ 24, 32, 48 ]
+end_time = 72.0
+rate_end_time = 80
+
+gomes_end_time = 48.0 #24 hpf founders to 72 hpf
+boije_end_generation = 250 #lineages run to completion
+
+################################################################
+# INFERRED PARAMETERS: uniform prior bounds
+################################################################
+
+#STOCHASTIC HE: phase2, phase3 (phase lengths), PP2, PD2, PP3; phase 1 PP & phase 3 PD fixed
+he_names = ["phase2", "phase3", "PP2", "PD2", "PP3"]
+he_lower = np.array([4, 0, 0, 0, 0]) #phase 2 below 4h has no effect (refractory period after first division)
+he_upper = np.array([20, 20, 1, 1, 1])
+phase_1_pPP = 1.0
+phase_1_pPD = 0.0
+phase_3_pPD = 0.0
+
+#DETERMINISTIC HE: phase boundary gamma shapes & scales, sister shift width, offset
+det_names = ["p1Sh", "p1Sc", "p2Sh", "p2Sc", "sisterShift", "offset"]
+det_lower = np.array([.1, .1, .1, .1, .1, -10])
+det_upper = np.array([10, 10, 10, 10, 2, 10])
+
+#GOMES: lognormal cycle mu & sigma, PP, PD, BC, AC, MG
+gomes_names = ["normalMu", "normalSigma", "PP", "PD", "BC", "AC", "MG"]
+gomes_lower = np.array([3, .01, 0, 0, 0, 0, 0])
+gomes_upper = np.array([5, 1, 1, 1, 1, 1, 1])
+
+#BOIJE: phase 2 & 3 generations (simulated as the nearest integer), pAtoh7, pPtf1a, png
+boije_names = ["phase2Gen", "phase3Gen", "pAtoh7", "pPtf1a", "png"]
+#phase 3 divisions are DD with probability png & PP otherwise; png < .5 lineages grow without end, so are excluded
+boije_lower = np.array([.5, .5, 0, 0, .5])
+boije_upper = np.array([10.5, 10.5, 1, 1, 1])
+boije_integer = np.array([True, True, False, False, False])
+
+if model == 0: names, lower, upper = he_names, he_lower, he_upper
+if model == 1: names, lower, upper = det_names, det_lower, det_upper
+if model == 2: names, lower, upper = gomes_names, gomes_lower, gomes_upper
+if model == 3: names, lower, upper = boije_names, boije_lower, boije_upper
+integer_parameters = boije_integer if model == 3 else np.zeros(lower.size, dtype=bool)
+
+#setup the log file
+log_filename = output_root + directory_name + "/" + log_name
+checkpoint_filename = output_root + directory_name + "/" + checkpoint_name
+reference_filename = output_root + directory_name + "/" + reference_name
+os.makedirs(os.path.dirname(log_filename), exist_ok=True)
+
+for i in range(0, len(count_prob_list)):
+    np.savetxt(reference_filename + str(i), count_prob_list[i])
+
+log = open(log_filename,"a" if resume == 1 else "w")
+
+def main():
+    # Use processes equal to the number of cpus available; each process runs one particle's simulations in sequence
+    cpu_count = multiprocessing.cpu_count()
+    pool = multiprocessing.Pool(processes=cpu_count)
+
+    if resume == 1 and os.path.isfile(checkpoint_filename):
+        state = load_checkpoint()
+        log.write("Resumed ABC-SMC of model " + str(model) + " at generation " + str(state["t"]) + ", " + str(len(state["accepted_thetas"])) + " particles accepted @\n" + str(datetime.datetime.now()) + "\n")
+    else:
+        state = {"t": 0, "epsilon": np.inf, "population": None, "weights": None, "distances": None,
+                 "accepted_thetas": [], "accepted_distances": [], "proposals": 0, "simulations": 0,
+                 "rng_state": np.random.RandomState(seed=abc_seed).get_state()}
+        log.write("Began ABC-SMC of model " + str(model) + " @\n" + str(datetime.datetime.now()) + "\n")
+        log.write("t\tepsilon\taccepted\tproposals\tsimulations\tESS\t" + "\t".join(["mean" + name for name in names]) + "\n")
+
+    p_RNG = np.random.RandomState()
+    p_RNG.set_state(state["rng_state"])
+
+    while state["t"] < max_generations:
+        t = state["t"]
+        if t > 0: kernel_covariance = kernel_scale * np.atleast_2d(np.cov(state["population"].T, aweights=state["weights"]))
+
+        #propose, simulate & screen batches of particles until the generation is full
+        while len(state["accepted_thetas"]) < number_particles:
+            if t == 0:
+                thetas = [sample_prior(p_RNG) for i in range(0, cpu_count)]
+            else:
+                thetas = [perturb(state["population"], state["weights"], kernel_covariance, p_RNG) for i in range(0, cpu_count)]
+
+            jobs = [(thetas[i], "G" + str(t) + "P" + str(state["proposals"] + i), state["epsilon"]) for i in range(0, cpu_count)]
+            print("Generation " + str(t) + ": simulating particles " + str(state["proposals"]) + "-" + str(state["proposals"] + cpu_count - 1) + ", " + str(len(state["accepted_thetas"])) + " accepted")
+            results = pool.map(simulate_particle, jobs, 1)
+
+            #accept in proposal order, discarding any beyond the generation size
+            for i in range(0, cpu_count):
+                distance, complete, simulations = results[i]
+                state["simulations"] += simulations
+                if complete and distance <= state["epsilon"] and len(state["accepted_thetas"]) < number_particles:
+                    state["accepted_thetas"].append(thetas[i])
+                    state["accepted_distances"].append(distance)
+            state["proposals"] += cpu_count
+
+            state["rng_state"] = p_RNG.get_state()
+            save_checkpoint(state)
+
+        population = np.array(state["accepted_thetas"])
+        distances = np.array(state["accepted_distances"])
+        if t == 0:
+            weights = np.ones(number_particles)
+        else:
+            weights = importance_weights(population, state["population"], state["weights"], kernel_covariance)
+        weights = weights / np.sum(weights)
+        acceptance_rate = number_particles / state["proposals"]
+
+        write_generation(t, population, weights, distances)
+        log.write(str(t) + "\t" + str(state["epsilon"]) + "\t" + str(number_particles) + "\t" + str(state["proposals"]) + "\t" + str(state["simulations"])\
+                  + "\t" + str(1 / np.sum(np.square(weights))) + "\t" + "\t".join([str(v) for v in weights.dot(population)]) + "\n")
+        log.flush()
+
+        #next generation's tolerance
+        state = {"t": t + 1, "epsilon": np.quantile(distances, tolerance_quantile), "population": population, "weights": weights,
+                 "distances": distances, "accepted_thetas": [], "accepted_distances": [], "proposals": 0, "simulations": 0,
+                 "rng_state": p_RNG.get_state()}
+        save_checkpoint(state)
+
+        if t > 0 and acceptance_rate < min_acceptance_rate:
+            log.write("Acceptance rate " + str(acceptance_rate) + " below minimum, stopping\n")
+            break
+
+    log.write("Finished @\n" + str(datetime.datetime.now()) + "\n")
+    log.close()
+    pool.close()
+
+##############################
+# PRIOR & PERTURBATION KERNEL
+##############################
+
+def simulated_theta(theta):
+#Parameters as passed to the simulator
+    return np.where(integer_parameters, np.round(theta), theta)
+
+def in_prior_support(theta):
+#Uniform prior bounds & the simulators' validity constraints
+    if np.any(theta < lower) or np.any(theta > upper): return False
+    simulated = simulated_theta(theta)
+
+    if model == 0:
+        return simulated[2] + simulated[3] <= 1 #pPP2 + pPD2 <= 1
+    if model == 1:
+        #as SPSA: 95% of sister shift values less than the smallest mean phase time
+        return simulated[4] <= min(simulated[0]*simulated[1], simulated[2]*simulated[3])/2
+    if model == 2:
+        return simulated[2] + simulated[3] <= 1 and np.sum(simulated[4:7]) <= 1
+    if model == 3:
+        return simulated[1] >= simulated[0] #phase3Generation >= phase2Generation
+
+def sample_prior(p_RNG):
+    while True:
+        theta = p_RNG.uniform(lower, upper)
+        if in_prior_support(theta): return theta
+
+def perturb(population, weights, kernel_covariance, p_RNG):
+#Resample a particle by weight & move it with the Gaussian kernel, until it lands in the prior support
+    while True:
+        theta = p_RNG.multivariate_normal(population[p_RNG.choice(len(population), p=weights)], kernel_covariance)
+        if in_prior_support(theta): return theta
+
+def importance_weights(population, previous_population, previous_weights, kernel_covariance):
+#Uniform prior density over the kernel mixture density; constants cancel on normalisation
+    inverse_covariance = np.linalg.inv(kernel_covariance)
+    differences = population[:,None,:] - previous_population[None,:,:]
+    kernel_density = np.exp(-0.5 * np.einsum('ijk,kl,ijl->ij', differences, inverse_covariance, differences))
+    return 1 / kernel_density.dot(previous_weights)
+
+##############################
+# PARTICLE SIMULATION
+##############################
+
+def particle_components(theta, file_name):
+#(command, output file, distance function, -abort reference or None) per distance component, in simulation order; He
+#models run the cheaper rate fixture first, so poor particles are abandoned before their count runs
+    components = []
+    theta = simulated_theta(theta)
+    parameters = " ".join([str(v) for v in theta])
+
+    if model == 0 or model == 1:
+        if model == 0:
+            parameters = str(theta[0])+" "+str(theta[1])+" "+str(phase_1_pPP)+" "+str(phase_1_pPD)+" "+str(theta[2])+" "+str(theta[3])+" "+str(theta[4])+" "+str(phase_3_pPD)
+
+        components.append((executable+" "+directory_name+" "+file_name+"Rate 1 "+str(deterministic_mode)+" "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                           +str(start_seed)+" "+str(rate_end_seed)+" "+str(earliest_lineage_start_time)+" "+str(earliest_lineage_start_time)+" "\
+                           +str(latest_lineage_start_time)+" "+str(rate_end_time)+" "+parameters, file_name + "Rate", rate_distance, None))
+        for i in range(0, len(induction_times)):
+            components.append((executable+" "+directory_name+" "+file_name+str(induction_times[i])+" 0 "+str(deterministic_mode)+" "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                               +str(start_seed)+" "+str(end_seed)+" "+str(induction_times[i])+" "+str(earliest_lineage_start_time)+" "\
+                               +str(latest_lineage_start_time)+" "+str(end_time)+" "+parameters, file_name + str(induction_times[i]),\
+                               lambda output, i=i: count_rss(np.loadtxt(output, skiprows=1, usecols=3, ndmin=1), count_prob_list[i]),\
+                               reference_filename + str(i)))
+
+    #Gomes & Boije count files: Entry, Seed, Count
+    if model == 2:
+        components.append((executable+" "+directory_name+" "+file_name+" 0 0 "+str(start_seed)+" "+str(end_seed)+" "+str(gomes_end_time)+" "+parameters,\
+                           file_name, lambda output: count_rss(np.loadtxt(output, skiprows=1, usecols=2, ndmin=1), count_prob_list[0]),\
+                           reference_filename + "0"))
+
+    if model == 3:
+        parameters = str(int(theta[0]))+" "+str(int(theta[1]))+" "+str(theta[2])+" "+str(theta[3])+" "+str(theta[4])
+        components.append((executable+" "+directory_name+" "+file_name+" 0 0 "+str(start_seed)+" "+str(end_seed)+" "+str(boije_end_generation)+" "+parameters,\
+                           file_name, lambda output: count_rss(np.loadtxt(output, skiprows=1, usecols=2, ndmin=1), count_prob_list[0]),\
+                           reference_filename + "0"))
+
+    return components
+
+def simulate_particle(job):
+#Run a particle's components until done or its partial distance exceeds the tolerance; returns (distance, complete, simulations run)
+    theta, file_name, epsilon = job
+    distance = 0
+    simulations = 0
+    for command, output_name, component_distance, reference in particle_components(theta, file_name):
+        if simulator_abort == 1 and reference is not None and epsilon < np.inf:
+            command += " -abort " + reference + " " + str(epsilon - distance)
+        exit_code = execute_command(command)
+        simulations += 1
+        output = output_root + directory_name + "/" + output_name
+        #a simulator stopped by -abort has shown the component distance must exceed the remaining tolerance
+        distance = np.inf if exit_code == aborted_exit_code else distance + component_distance(output)
+        if keep_particle_output == 0:
+            os.remove(output)
+            shutil.rmtree(output_root + "UnusedSimOutput" + output_name, ignore_errors=True)
+        if distance > epsilon: return distance, False, simulations
+    return distance, True, simulations
+
+def rate_distance(output):
+    return np.sum(rate_rss(load_rates(output), rate_end_seed + 1))
+
+##############################
+# OUTPUT & CHECKPOINTS
+##############################
+
+def write_generation(t, population, weights, distances):
+    generation_file = open(output_root + directory_name + "/ABCGeneration" + str(t), "w")
+    generation_file.write("\t".join(names) + "\tWeight\tDistance\n")
+    for i in range(0, len(population)):
+        generation_file.write("\t".join([str(v) for v in population[i]]) + "\t" + str(weights[i]) + "\t" + str(distances[i]) + "\n")
+    generation_file.close()
+
+def save_checkpoint(state):
+#Write then rename, so an interrupted save leaves the previous checkpoint intact
+    checkpoint_file = open(checkpoint_filename + ".tmp", "wb")
+    pickle.dump(state, checkpoint_file)
+    checkpoint_file.close()
+    os.replace(checkpoint_filename + ".tmp", checkpoint_filename)
+
+def load_checkpoint():
+    checkpoint_file = open(checkpoint_filename, "rb")
+    state = pickle.load(checkpoint_file)
+    checkpoint_file.close()
+    return state
+
+# This is a helper function for run_simulation that runs bash commands in separate processes
+def execute_command(cmd):
+    return subprocess.call(cmd, shell=True)
+
+if __name__ == "__main__":
+    main()
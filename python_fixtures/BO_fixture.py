@@ -0,0 +1,292 @@
+import multiprocessing
+import os
+import subprocess
+import datetime
+
+import numpy as np
+from scipy.linalg import cho_factor, cho_solve
+from scipy.optimize import minimize
+from scipy.stats import norm
+
+from fixture_loss import count_prob_list, count_rss, load_rates, rate_rss, aic, number_comparisons_per_induction, number_rate_comparisons
+
+###########################################################################
+# BAYESIAN OPTIMISATION OF THE STOCHASTIC HE MODEL
+# Each loss evaluation (the SPSA fixture's count & mode rate AIC) costs thousands of lineage simulations, while the
+# stochastic model's fitted theta (phase2, phase3, PP2, PD2, PP3) has only five dimensions. A Gaussian process
+# emulator (ARD Matern 5/2 kernel + noise nugget, hyperparameters by maximum marginal likelihood) is fitted to the
+# noisy AIC evaluations collected so far, and new thetas are chosen by expected improvement over the best posterior
+# mean among evaluated thetas.
+# Each round proposes a batch of thetas, one per group of cpus needed to evaluate it: after each pick, the GP is
+# conditioned on its own prediction there ("kriging believer"), which pushes the next pick elsewhere. The whole
+# batch is dispatched to the simulator pool at once. A Latin hypercube design seeds the emulator.
+###########################################################################
+
+executable = '/home/main/chaste_build/projects/ISP/apps/HeSimulator'
+output_root = '/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/'
+
+if not(os.path.isfile(executable)):
+    raise Exception('Could not find executable: ' + executable)
+
+#####################
+# BO SETTINGS
+#####################
+
+initial_design_points = 20 #Latin hypercube evaluations before the first GP fit
+max_evaluations = 150 #total loss evaluations, including the initial design
+batch_size = 0 #thetas proposed per round (0=as many as fill the cpus)
+candidate_points = 5000 #random feasible thetas scored by EI each pick; the best few are refined by local search
+refined_candidates = 5
+hyperparameter_restarts = 5
+bo_seed = 786 #traceable RNG
+
+#########################
+# SIMULATION PARAMETERS
+#########################
+
+start_seed = 0
+end_seed = 999
+rate_end_seed = 249
+directory_name = "BO"
+log_name = "BOOutput"
+fixture = 0 #0=He 2012;1=Wan 2016
+ath5founder = 0
+
+earliest_lineage_start_time = 23.0
+latest_lineage_start_time = 39.0
+induction_times = [ 24, 32, 48 ]
+end_time = 72.0
+rate_end_time = 80
+
+he_model_params = 15
+
+###################################
+# SEARCH SPACE: phase2, phase3, PP2, PD2, PP3
+###################################
+
+theta_names = ["phase2", "phase3", "PP2", "PD2", "PP3"]
+theta_lower = np.array([4, 0, 0, 0, 0]) #phase 2 below 4h has no effect (refractory period after first division)
+theta_upper = np.array([20, 20, 1, 1, 1])
+phase_1_pPP = 1.0
+phase_1_pPD = 0.0
+phase_3_pPD = 0.0
+
+#setup the log file
+log_filename = output_root + directory_name + "/" + log_name
+os.makedirs(os.path.dirname(log_filename), exist_ok=True)
+
+log = open(log_filename,"w")
+
+def main():
+    p_RNG = np.random.RandomState(seed=bo_seed)
+    dimension = theta_lower.size
+
+    # Use processes equal to the number of cpus available
+    cpu_count = multiprocessing.cpu_count()
+    pool = multiprocessing.Pool(processes=cpu_count)
+
+    commands_per_theta = len(theta_commands(theta_lower, "Size"))
+    proposals_per_round = batch_size if batch_size > 0 else max(1, cpu_count // commands_per_theta)
+
+    log.write("Began Bayesian optimisation of He model @\n" + str(datetime.datetime.now()) + "\n")
+    log.write("n\t" + "\t".join(theta_names) + "\tAIC\n")
+
+    #GP inputs are thetas scaled to the unit cube
+    design = latin_hypercube(initial_design_points, dimension, p_RNG)
+    design = np.array([feasible(point) for point in design])
+    evaluated_points = np.zeros((0, dimension))
+    evaluated_AICs = np.zeros(0)
+
+    batch = design
+    while True:
+        AICs = evaluate_batch(evaluated_AICs.size, batch, pool)
+        evaluated_points = np.vstack([evaluated_points, batch])
+        evaluated_AICs = np.append(evaluated_AICs, AICs)
+        for i in range(0, batch.shape[0]):
+            log.write(str(evaluated_AICs.size - batch.shape[0] + i) + "\t" + "\t".join([str(v) for v in to_theta(batch[i])]) + "\t" + str(AICs[i]) + "\n")
+        log.flush()
+
+        if evaluated_AICs.size >= max_evaluations: break
+
+        gp = fit_gp(evaluated_points, evaluated_AICs, p_RNG)
+        log.write("GP lengthscales " + str(gp["lengthscales"]) + " signal sd " + str(np.sqrt(gp["signal_variance"])) + " noise sd " + str(np.sqrt(gp["noise_variance"])) + " (standardised AIC)\n")
+        batch = propose_batch(gp, min(proposals_per_round, max_evaluations - evaluated_AICs.size), p_RNG)
+
+    #report the evaluated theta with the best posterior mean: individual AICs are noisy
+    gp = fit_gp(evaluated_points, evaluated_AICs, p_RNG)
+    posterior_mean, posterior_sd = gp_predict(gp, evaluated_points)
+    best = np.argmin(posterior_mean)
+    log.write("Best posterior mean AIC " + str(posterior_mean[best] * gp["y_sd"] + gp["y_mean"]) + "\n")
+    log.write("\t".join(theta_names) + "\n")
+    log.write("\t".join([str(v) for v in to_theta(evaluated_points[best])]) + "\n")
+    log.close()
+
+##############################
+# SEARCH SPACE UTILITIES
+##############################
+
+def to_theta(point):
+    return theta_lower + point * (theta_upper - theta_lower)
+
+def feasible(point):
+#Project a unit cube point onto the valid theta space (pPP2 + pPD2 <= 1)
+    theta = to_theta(np.clip(point, 0, 1))
+    if theta[2] + theta[3] > 1: theta[2:4] = theta[2:4] / (theta[2] + theta[3])
+    return (theta - theta_lower) / (theta_upper - theta_lower)
+
+def is_feasible(points):
+    thetas = theta_lower + points * (theta_upper - theta_lower)
+    return thetas[:,2] + thetas[:,3] <= 1 + 1e-9
+
+def latin_hypercube(n, dimension, p_RNG):
+    strata = np.array([p_RNG.permutation(n) for i in range(0, dimension)]).T
+    return (strata + p_RNG.random_sample((n, dimension))) / n
+
+def random_feasible_points(n, dimension, p_RNG):
+    points = p_RNG.random_sample((2 * n, dimension))
+    points = points[is_feasible(points)]
+    return points[0:n]
+
+##############################
+# GAUSSIAN PROCESS EMULATOR
+##############################
+
+def matern52(A, B, lengthscales, signal_variance):
+    scaled_distance = np.sqrt(np.sum(np.square((A[:,None,:] - B[None,:,:]) / lengthscales), axis=2))
+    root5d = np.sqrt(5) * scaled_distance
+    return signal_variance * (1 + root5d + np.square(root5d) / 3) * np.exp(-root5d)
+
+def negative_log_marginal_likelihood(log_parameters, X, y):
+    dimension = X.shape[1]
+    lengthscales = np.exp(log_parameters[0:dimension])
+    signal_variance = np.exp(log_parameters[dimension])
+    noise_variance = np.exp(log_parameters[dimension + 1])
+    K = matern52(X, X, lengthscales, signal_variance) + (noise_variance + 1e-8) * np.eye(y.size)
+    try:
+        L = cho_factor(K, lower=True)
+    except np.linalg.LinAlgError:
+        return 1e10
+    alpha = cho_solve(L, y)
+    return 0.5 * y.dot(alpha) + np.sum(np.log(np.diag(L[0]))) + 0.5 * y.size * np.log(2 * np.pi)
+
+def fit_gp(X, AICs, p_RNG):
+#Maximum marginal likelihood hyperparameters, from several starts; AICs are standardised
+    dimension = X.shape[1]
+    y_mean = np.mean(AICs)
+    y_sd = np.std(AICs) if np.std(AICs) > 0 else 1.0
+    y = (AICs - y_mean) / y_sd
+
+    #log lengthscales (unit cube), log signal variance, log noise variance
+    bounds = [(np.log(.01), np.log(10))] * dimension + [(np.log(.01), np.log(100)), (np.log(1e-6), np.log(1))]
+    best = None
+    for r in range(0, hyperparameter_restarts):
+        start = np.array([p_RNG.uniform(low, high) for (low, high) in bounds])
+        result = minimize(negative_log_marginal_likelihood, start, args=(X, y), method="L-BFGS-B", bounds=bounds)
+        if best is None or result.fun < best.fun: best = result
+
+    gp = {"X": X, "y": y, "y_mean": y_mean, "y_sd": y_sd,
+          "lengthscales": np.exp(best.x[0:dimension]), "signal_variance": np.exp(best.x[dimension]),
+          "noise_variance": np.exp(best.x[dimension + 1])}
+    return condition_gp(gp, X, y)
+
+def condition_gp(gp, X, y):
+#Posterior given observations (X, y), with fixed hyperparameters
+    gp["X"] = X
+    gp["y"] = y
+    K = matern52(X, X, gp["lengthscales"], gp["signal_variance"]) + (gp["noise_variance"] + 1e-8) * np.eye(y.size)
+    gp["L"] = cho_factor(K, lower=True)
+    gp["alpha"] = cho_solve(gp["L"], y)
+    return gp
+
+def gp_predict(gp, points):
+#Posterior mean & sd of the latent (noise-free) standardised AIC
+    Ks = matern52(points, gp["X"], gp["lengthscales"], gp["signal_variance"])
+    mean = Ks.dot(gp["alpha"])
+    v = cho_solve(gp["L"], Ks.T)
+    variance = np.maximum(gp["signal_variance"] - np.sum(Ks * v.T, axis=1), 1e-12)
+    return mean, np.sqrt(variance)
+
+##############################
+# ACQUISITION
+##############################
+
+def expected_improvement(gp, points, incumbent):
+    mean, sd = gp_predict(gp, points)
+    z = (incumbent - mean) / sd
+    return (incumbent - mean) * norm.cdf(z) + sd * norm.pdf(z)
+
+def propose_batch(gp, n, p_RNG):
+#Kriging believer batch: pick the EI maximiser, condition the GP on its predicted mean there, repeat
+    dimension = gp["X"].shape[1]
+    X = gp["X"]
+    y = gp["y"]
+    batch = []
+    for b in range(0, n):
+        #noisy observations: the incumbent is the best posterior mean among observed points
+        incumbent = np.min(gp_predict(gp, X)[0])
+
+        candidates = random_feasible_points(candidate_points, dimension, p_RNG)
+        scores = expected_improvement(gp, candidates, incumbent)
+        best_point = candidates[np.argmax(scores)]
+        best_score = np.max(scores)
+
+        #local refinement of the best candidates
+        for start in candidates[np.argsort(scores)[::-1][0:refined_candidates]]:
+            result = minimize(lambda p: -expected_improvement(gp, feasible(p)[None,:], incumbent)[0], start, method="L-BFGS-B", bounds=[(0, 1)] * dimension)
+            if -result.fun > best_score:
+                best_point = feasible(result.x)
+                best_score = -result.fun
+
+        batch.append(best_point)
+        X = np.vstack([X, best_point])
+        y = np.append(y, gp_predict(gp, best_point[None,:])[0])
+        gp = condition_gp(gp, X, y)
+
+    return np.array(batch)
+
+##############################
+# LOSS EVALUATION
+##############################
+
+def theta_commands(theta, file_name):
+#Rate fixture, then each induction time's counts
+    command_list = []
+    parameters = str(theta[0])+" "+str(theta[1])+" "+str(phase_1_pPP)+" "+str(phase_1_pPD)+" "+str(theta[2])+" "+str(theta[3])+" "+str(theta[4])+" "+str(phase_3_pPD)
+
+    command_list.append(executable+" "+directory_name+" "+file_name+"Rate 1 0 "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                        +str(start_seed)+" "+str(rate_end_seed)+" "+str(earliest_lineage_start_time)+" "+str(earliest_lineage_start_time)+" "\
+                        +str(latest_lineage_start_time)+" "+str(rate_end_time)+" "+parameters)
+    for induction_time in induction_times:
+        command_list.append(executable+" "+directory_name+" "+file_name+str(induction_time)+" 0 0 "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                            +str(start_seed)+" "+str(end_seed)+" "+str(induction_time)+" "+str(earliest_lineage_start_time)+" "\
+                            +str(latest_lineage_start_time)+" "+str(end_time)+" "+parameters)
+    return command_list
+
+def evaluate_batch(first_evaluation, batch, pool):
+#Simulate every theta of the batch concurrently & return their AICs
+    command_list = []
+    for i in range(0, batch.shape[0]):
+        command_list += theta_commands(to_theta(batch[i]), "Evaluation" + str(first_evaluation + i))
+
+    print("Starting simulations for evaluations " + str(first_evaluation) + "-" + str(first_evaluation + batch.shape[0] - 1) + ", " + str(len(command_list)) + " commands")
+    pool.map(execute_command, command_list, 1)
+
+    return np.array([theta_AIC("Evaluation" + str(first_evaluation + i)) for i in range(0, batch.shape[0])])
+
+def theta_AIC(file_name):
+#AIC of the residual sum of squares against the empirical count & mode rate histograms, as SPSA
+    rss = 0
+    for i in range(0, len(induction_times)):
+        counts = np.loadtxt(output_root + directory_name + "/" + file_name + str(induction_times[i]), skiprows=1, usecols=3, ndmin=1)
+        rss += count_rss(counts, count_prob_list[i])
+    rss += np.sum(rate_rss(load_rates(output_root + directory_name + "/" + file_name + "Rate"), rate_end_seed + 1))
+
+    number_comparisons = number_comparisons_per_induction * len(induction_times) + number_rate_comparisons
+    return aic(rss, he_model_params, number_comparisons)
+
+# This is a helper function for run_simulation that runs bash commands in separate processes
+def execute_command(cmd):
+    return subprocess.call(cmd, shell=True)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,311 @@
+import multiprocessing
+import os
+import subprocess
+import datetime
+
+import numpy as np
+
+from fixture_loss import count_prob_list, count_rss, load_rates, rate_rss, aic, number_comparisons_per_induction, number_rate_comparisons
+
+###########################################################################
+# CMA-ES MODEL FITTING
+# Refits the stochastic He, deterministic He, Gomes or Boije model parameters with a (mu/mu_w, lambda) covariance
+# matrix adaptation evolution strategy. Each generation's whole population of parameter vectors is simulated
+# concurrently on the common seed range (common random numbers sharpen the population's ranking), scored by the
+# AIC of its residuals against the empirical histograms, and the search distribution's mean, covariance & step size
+# are updated from the best half.
+# Search coordinates are parameters in units of each parameter's scale. Candidates outside the simulators' valid
+# parameter space (bounds, pPP + pPD <= 1, fate probability sums <= 1, phase3Generation >= phase2Generation) are
+# repaired onto it for simulation & penalised by their squared repair distance, so the distribution is pulled back
+# towards feasible space.
+# He & deterministic models are scored on the SPSA fixture's count (24, 32, 48 h induction) and mode rate
+# histograms. The Gomes & Boije simulators log clone counts only; they are scored on the 24 h induction clone size
+# histogram, with founders run from 24 to 72 hpf (Gomes) or to lineage completion (Boije).
+###########################################################################
+
+he_executable = '/home/main/chaste_build/projects/ISP/apps/HeSimulator'
+gomes_executable = '/home/main/chaste_build/projects/ISP/apps/GomesSimulator'
+boije_executable = '/home/main/chaste_build/projects/ISP/apps/BoijeSimulator'
+output_root = '/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/'
+
+model = 0 #0=stochastic He;1=deterministic He;2=Gomes;3=Boije
+deterministic_mode = 1 if model == 1 else 0
+
+if model == 0 or model == 1: executable = he_executable
+if model == 2: executable = gomes_executable
+if model == 3: executable = boije_executable
+
+if not(os.path.isfile(executable)):
+    raise Exception('Could not find executable: ' + executable)
+
+#####################
+# CMA-ES SETTINGS
+#####################
+
+max_generations = 100
+sigma_zero = 0.3 #initial step size, in units of each parameter's scale
+population_size = 0 #candidates per generation (0=the larger of the CMA-ES default & as many candidates as fill the cpus)
+penalty_weight = 1000 #AIC penalty per unit squared (scaled) constraint repair distance
+integer_sd_floor = 0.2 #minimum search sd of integer parameters (scaled units), so rounding plateaus do not stall them
+cma_seed = 786 #traceable RNG
+
+#########################
+# SIMULATION PARAMETERS
+#########################
+
+#every candidate is simulated on the same seeds
+start_seed = 0
+end_seed = 999
+rate_end_seed = 249
+directory_name = "CMAES"
+log_name = "CMAESOutput"
+fixture = 0 #0=He 2012;1=Wan 2016
+ath5founder = 0
+
+earliest_lineage_start_time = 23.0
+latest_lineage_start_time = 39.0
+induction_times = [ 24, 32, 48 ]
+end_time = 72.0
+rate_end_time = 80
+
+gomes_end_time = 48.0 #24 hpf founders to 72 hpf
+boije_end_generation = 250 #lineages run to completion
+
+################################################################
+# FITTED PARAMETERS: starting values, scales, bounds, AIC params
+################################################################
+
+#STOCHASTIC HE: phase2, phase3 (phase lengths), PP2, PD2, PP3; phase 1 PP & phase 3 PD fixed
+he_names = ["phase2", "phase3", "PP2", "PD2", "PP3"]
+he_theta_zero = np.array([8, 7, .2, .4, .2])
+he_scale = np.array([1, 1, .1, .1, .1])
+he_lower = np.array([4, 0, 0, 0, 0]) #phase 2 below 4h has no effect (refractory period after first division)
+he_upper = np.array([np.inf, np.inf, 1, 1, 1])
+he_model_params = 15
+phase_1_pPP = 1.0
+phase_1_pPD = 0.0
+phase_3_pPD = 0.0
+
+#DETERMINISTIC HE: phase boundary gamma shapes & scales, sister shift width, offset
+det_names = ["p1Sh", "p1Sc", "p2Sh", "p2Sc", "sisterShift", "offset"]
+det_theta_zero = np.array([3, 2, 2, 2, .25, 0])
+det_scale = np.array([1, 1, 1, 1, 1, 3])
+det_lower = np.array([.1, .1, .1, .1, .1, -np.inf])
+det_upper = np.array([np.inf, np.inf, np.inf, np.inf, np.inf, np.inf])
+det_model_params = 13
+
+#GOMES: lognormal cycle mu & sigma, PP, PD, BC, AC, MG
+gomes_names = ["normalMu", "normalSigma", "PP", "PD", "BC", "AC", "MG"]
+gomes_theta_zero = np.array([3.9716, .32839, .055, .221, .128, .106, .028])
+gomes_scale = np.array([.5, .1, .05, .05, .05, .05, .05])
+gomes_lower = np.array([.01, .01, 0, 0, 0, 0, 0])
+gomes_upper = np.array([np.inf, np.inf, 1, 1, 1, 1, 1])
+gomes_model_params = 7
+
+#BOIJE: phase 2 & 3 generations (integers), pAtoh7, pPtf1a, png
+boije_names = ["phase2Gen", "phase3Gen", "pAtoh7", "pPtf1a", "png"]
+boije_theta_zero = np.array([3, 5, .32, .3, .8])
+boije_scale = np.array([1, 1, .1, .1, .1])
+#phase 1 is all PP divisions, so clones grow as 2^phase2Gen; phase 3 divisions are DD with probability png & PP
+#otherwise, and png < .5 lineages grow without end
+boije_lower = np.array([1, 1, 0, 0, .5])
+boije_upper = np.array([10, 10, 1, 1, 1])
+boije_model_params = 5
+boije_integer = np.array([True, True, False, False, False])
+
+if model == 0: names, theta_zero, scale, lower, upper, number_params = he_names, he_theta_zero, he_scale, he_lower, he_upper, he_model_params
+if model == 1: names, theta_zero, scale, lower, upper, number_params = det_names, det_theta_zero, det_scale, det_lower, det_upper, det_model_params
+if model == 2: names, theta_zero, scale, lower, upper, number_params = gomes_names, gomes_theta_zero, gomes_scale, gomes_lower, gomes_upper, gomes_model_params
+if model == 3: names, theta_zero, scale, lower, upper, number_params = boije_names, boije_theta_zero, boije_scale, boije_lower, boije_upper, boije_model_params
+integer_parameters = boije_integer if model == 3 else np.zeros(theta_zero.size, dtype=bool)
+
+#setup the log file
+log_filename = output_root + directory_name + "/" + log_name
+os.makedirs(os.path.dirname(log_filename), exist_ok=True)
+
+log = open(log_filename,"w")
+
+def main():
+    p_RNG = np.random.RandomState(seed=cma_seed)
+    dimension = theta_zero.size
+
+    # Use processes equal to the number of cpus available; all of a generation's commands share the pool
+    cpu_count = multiprocessing.cpu_count()
+    pool = multiprocessing.Pool(processes=cpu_count)
+
+    #population size: at least the CMA-ES default, raised to use every cpu
+    default_population = 4 + int(3 * np.log(dimension))
+    commands_per_candidate = len(candidate_commands(theta_zero, "Size"))
+    lam = population_size if population_size > 0 else max(default_population, cpu_count // commands_per_candidate)
+
+    #selection & recombination weights
+    mu = lam // 2
+    weights = np.log(mu + .5) - np.log(np.arange(1, mu + 1))
+    weights = weights / np.sum(weights)
+    mueff = 1 / np.sum(np.square(weights))
+
+    #adaptation rates for the evolution paths, covariance matrix & step size
+    cc = (4 + mueff / dimension) / (dimension + 4 + 2 * mueff / dimension)
+    cs = (mueff + 2) / (dimension + mueff + 5)
+    c1 = 2 / ((dimension + 1.3)**2 + mueff)
+    cmu = min(1 - c1, 2 * (mueff - 2 + 1 / mueff) / ((dimension + 2)**2 + mueff))
+    damps = 1 + 2 * max(0, np.sqrt((mueff - 1) / (dimension + 1)) - 1) + cs
+    chiN = np.sqrt(dimension) * (1 - 1 / (4 * dimension) + 1 / (21 * dimension**2))
+
+    #search distribution, in scaled coordinates about theta_zero
+    mean = np.zeros(dimension)
+    sigma = sigma_zero
+    C = np.eye(dimension)
+    pc = np.zeros(dimension)
+    ps = np.zeros(dimension)
+
+    best_fitness = np.inf
+    best_theta = theta_zero
+
+    log.write("Began CMA-ES optimisation of model " + str(model) + " @\n" + str(datetime.datetime.now()) + "\n")
+    log.write("Population " + str(lam) + ", parents " + str(mu) + "\n")
+    log.write("g\tsigma\tbestAIC\t" + "\t".join(["mean" + name for name in names]) + "\n")
+
+    for g in range(0, max_generations):
+        #sample the population: x = mean + sigma * B D z
+        eigenvalues, B = np.linalg.eigh(C)
+        D = np.sqrt(np.maximum(eigenvalues, 1e-20))
+        z = p_RNG.standard_normal((lam, dimension))
+        y = z.dot((B * D).T)
+        x = mean + sigma * y
+
+        #repair onto the valid parameter space for simulation; penalise the repair distance (rounding is not a repair)
+        thetas = [theta_zero + scale * x[i] for i in range(0, lam)]
+        repaired_thetas = [repair(theta) for theta in thetas]
+        rounded_thetas = [np.where(integer_parameters, np.round(theta), theta) for theta in thetas]
+        penalties = np.array([np.sum(np.square((rounded_thetas[i] - repaired_thetas[i]) / scale)) for i in range(0, lam)])
+
+        fitness = evaluate_population(g, repaired_thetas, pool) + penalty_weight * penalties
+
+        order = np.argsort(fitness)
+        if fitness[order[0]] < best_fitness:
+            best_fitness = fitness[order[0]]
+            best_theta = repaired_thetas[order[0]]
+
+        #recombine the best mu candidates
+        old_mean = mean
+        mean = weights.dot(x[order[0:mu]])
+        y_w = (mean - old_mean) / sigma
+
+        #cumulative step size adaptation path, in the isotropic (C^-1/2) frame
+        C_inverse_root = B.dot(np.diag(1 / D)).dot(B.T)
+        ps = (1 - cs) * ps + np.sqrt(cs * (2 - cs) * mueff) * C_inverse_root.dot(y_w)
+        hsig = np.linalg.norm(ps) / np.sqrt(1 - (1 - cs)**(2 * (g + 1))) / chiN < 1.4 + 2 / (dimension + 1)
+
+        #rank one & rank mu covariance updates
+        pc = (1 - cc) * pc + hsig * np.sqrt(cc * (2 - cc) * mueff) * y_w
+        y_selected = y[order[0:mu]]
+        rank_mu = (y_selected.T * weights).dot(y_selected)
+        C = (1 - c1 - cmu) * C + c1 * (np.outer(pc, pc) + (1 - hsig) * cc * (2 - cc) * C) + cmu * rank_mu
+        C = (C + C.T) / 2
+
+        sigma = sigma * np.exp((cs / damps) * (np.linalg.norm(ps) / chiN - 1))
+
+        #integer parameters keep enough variance to step between whole values
+        for i in np.where(integer_parameters)[0]:
+            if sigma * np.sqrt(C[i,i]) < integer_sd_floor: C[i,i] = (integer_sd_floor / sigma)**2
+
+        log.write(str(g) + "\t" + str(sigma) + "\t" + str(fitness[order[0]]) + "\t" + "\t".join([str(v) for v in repair(theta_zero + scale * mean)]) + "\n")
+        log.flush()
+
+    log.write("Best AIC " + str(best_fitness) + "\n")
+    log.write("\t".join(names) + "\n")
+    log.write("\t".join([str(v) for v in best_theta]) + "\n")
+    log.close()
+
+def repair(theta):
+#Project a candidate onto the simulator's valid parameter space
+    repaired = np.clip(theta, lower, upper)
+
+    if model == 0:
+        repaired[2:4] = simplex_repair(repaired[2:4]) #pPP2 + pPD2 <= 1
+
+    if model == 1:
+        #as SPSA: 95% of sister shift values less than the smallest mean phase time
+        min_phase = min(repaired[0]*repaired[1], repaired[2]*repaired[3])
+        repaired[4] = min(repaired[4], min_phase/2)
+
+    if model == 2:
+        repaired[2:4] = simplex_repair(repaired[2:4]) #pPP + pPD <= 1
+        repaired[4:7] = simplex_repair(repaired[4:7]) #pBC + pAC + pMG <= 1
+
+    if model == 3:
+        repaired[0:2] = np.round(repaired[0:2]) #generations are whole numbers
+        repaired[1] = max(repaired[1], repaired[0]) #phase3Generation >= phase2Generation
+
+    return repaired
+
+def simplex_repair(probabilities):
+#Scale probabilities summing to more than 1 back onto the simplex face
+    total = np.sum(probabilities)
+    if total > 1: return probabilities / total
+    return probabilities
+
+def candidate_commands(theta, file_name):
+#Simulator commands scoring one candidate; He models run the rate fixture, then each induction time's counts
+    command_list = []
+    parameters = " ".join([str(v) for v in theta])
+
+    if model == 0 or model == 1:
+        if model == 0:
+            parameters = str(theta[0])+" "+str(theta[1])+" "+str(phase_1_pPP)+" "+str(phase_1_pPD)+" "+str(theta[2])+" "+str(theta[3])+" "+str(theta[4])+" "+str(phase_3_pPD)
+
+        command_list.append(executable+" "+directory_name+" "+file_name+"Rate 1 "+str(deterministic_mode)+" "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                            +str(start_seed)+" "+str(rate_end_seed)+" "+str(earliest_lineage_start_time)+" "+str(earliest_lineage_start_time)+" "\
+                            +str(latest_lineage_start_time)+" "+str(rate_end_time)+" "+parameters)
+        for induction_time in induction_times:
+            command_list.append(executable+" "+directory_name+" "+file_name+str(induction_time)+" 0 "+str(deterministic_mode)+" "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                                +str(start_seed)+" "+str(end_seed)+" "+str(induction_time)+" "+str(earliest_lineage_start_time)+" "\
+                                +str(latest_lineage_start_time)+" "+str(end_time)+" "+parameters)
+
+    if model == 2:
+        command_list.append(executable+" "+directory_name+" "+file_name+" 0 0 "+str(start_seed)+" "+str(end_seed)+" "+str(gomes_end_time)+" "+parameters)
+
+    if model == 3:
+        parameters = str(int(theta[0]))+" "+str(int(theta[1]))+" "+str(theta[2])+" "+str(theta[3])+" "+str(theta[4])
+        command_list.append(executable+" "+directory_name+" "+file_name+" 0 0 "+str(start_seed)+" "+str(end_seed)+" "+str(boije_end_generation)+" "+parameters)
+
+    return command_list
+
+def evaluate_population(g, thetas, pool):
+#Simulate every candidate concurrently & return their AICs
+    command_list = []
+    for i in range(0, len(thetas)):
+        command_list += candidate_commands(thetas[i], "Candidate" + str(i))
+
+    print("Starting simulations for generation " + str(g) + ", " + str(len(thetas)) + " candidates, " + str(len(command_list)) + " commands")
+    pool.map(execute_command, command_list, 1)
+
+    return np.array([candidate_AIC("Candidate" + str(i)) for i in range(0, len(thetas))])
+
+def candidate_AIC(file_name):
+#AIC of a candidate's residual sum of squares against the empirical histograms
+    if model == 0 or model == 1:
+        rss = 0
+        for i in range(0, len(induction_times)):
+            counts = np.loadtxt(output_root + directory_name + "/" + file_name + str(induction_times[i]), skiprows=1, usecols=3, ndmin=1)
+            rss += count_rss(counts, count_prob_list[i])
+
+        rss += np.sum(rate_rss(load_rates(output_root + directory_name + "/" + file_name + "Rate"), rate_end_seed + 1))
+
+        number_comparisons = number_comparisons_per_induction * len(induction_times) + number_rate_comparisons
+
+    else:
+        #Gomes & Boije count files: Entry, Seed, Count
+        counts = np.loadtxt(output_root + directory_name + "/" + file_name, skiprows=1, usecols=2, ndmin=1)
+        rss = count_rss(counts, count_prob_list[0])
+        number_comparisons = number_comparisons_per_induction
+
+    return aic(rss, number_params, number_comparisons)
+
+# This is a helper function for run_simulation that runs bash commands in separate processes
+def execute_command(cmd):
+    return subprocess.call(cmd, shell=True)
+
+if __name__ == "__main__":
+    main()
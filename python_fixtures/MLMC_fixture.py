@@ -0,0 +1,299 @@
+import multiprocessing
+import os
+import subprocess
+import time
+
+import numpy as np
+
+###########################################################################
+# MULTILEVEL MONTE CARLO LOSS ESTIMATE
+# The SPSA loss only needs the expected histogram bins (He counts & mode rates) or the expected CMZ population
+# (Wan). These are estimated by the telescoping sum E[P_L] = E[P_0] + sum_l E[P_l - P_(l-1)] over simulator
+# timesteps dt_0 > dt_1 > ... > dt_L: many cheap coarse-dt runs, plus a few fine runs coupled to coarse runs of
+# the same seed. A seed gives the same random stream at every dt, so coupled runs draw the same cycle lengths &
+# mitotic modes until their division timing differs, and the corrections have small variance.
+# A pilot run estimates each level's correction variance V_l & CPU cost C_l; the remaining CPU budget is then
+# allocated N_l ~ sqrt(V_l/C_l), which minimises the estimate's variance for the budget.
+###########################################################################
+
+he_executable = '/home/main/chaste_build/projects/ISP/apps/HeSimulator'
+wan_executable = '/home/main/chaste_build/projects/ISP/apps/WanSimulator'
+output_root = '/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/'
+
+model = 0 #0=He 2012 counts & mode rates (HeSimulator);1=Wan 2016 CMZ population (WanSimulator)
+
+if model == 0: executable = he_executable
+if model == 1: executable = wan_executable
+
+if not(os.path.isfile(executable)):
+    raise Exception('Could not find executable: ' + executable)
+
+#####################
+# MLMC SETTINGS
+#####################
+
+he_dt_levels = [0.4, 0.2, 0.1, 0.05] #coarse to fine; the finest level is HeSimulator's production timestep
+wan_dt_levels = [4.0, 2.0, 1.0] #the finest level is WanSimulator's production timestep
+he_pilot_seeds = [400, 200, 100, 50]
+wan_pilot_seeds = [16, 8, 4]
+cpu_budget_hours = 8.0 #total CPU time, including the pilot
+
+start_seed = 0
+level_seed_stride = 1000000 #levels draw from disjoint seed blocks, so the level estimates are independent
+directory_name = "MLMC"
+log_name = "MLMCOutput"
+
+#########################
+# HE SIMULATION PARAMETERS
+#########################
+
+deterministic_mode = 0
+fixture = 0 #0=He 2012;1=Wan 2016
+ath5founder = 0
+earliest_lineage_start_time = 23.0
+latest_lineage_start_time = 39.0
+induction_times = [ 24, 32, 48 ]
+end_time = 72.0
+rate_end_time = 80
+he_model_params = 15
+
+mitotic_mode_phase_2 = 8 #These are phase lengths, so
+mitotic_mode_phase_3 = 7 #Phase3 boundary = mmp2 + mmp3
+phase_1_pPP = 1.0
+phase_1_pPD = 0.0
+phase_2_pPP = 0.2
+phase_2_pPD = 0.4
+phase_3_pPP = 0.2
+phase_3_pPD = 0.0
+
+he_theta_string = str(mitotic_mode_phase_2) + " " + str(mitotic_mode_phase_3) + " " + str(phase_1_pPP) + " " + str(phase_1_pPD) + " " + str(phase_2_pPP) + " " + str(phase_2_pPD) + " " + str(phase_3_pPP) + " " + str(phase_3_pPD)
+
+##########################
+# WAN SIMULATION PARAMETERS
+##########################
+
+wan_cmz_theta_string = "17.0 10 792 160 4 6.5 4 4 2 1 1"
+wan_stochastic_theta_string = "8 15 1.0 0.0 0.2 0.4 0.2 0.0"
+
+##############################
+# EMPIRICAL RESULTS
+##############################
+
+number_comparisons = 3030
+number_comparisons_per_induction = 1000
+rate_bin_sequence = np.arange(30,85,5)
+lineages_sampled_events = 60
+
+raw_counts = np.loadtxt('/home/main/git/chaste/projects/ISP/empirical_data/empirical_counts.csv', skiprows=1, usecols=(3,4,5,6,7,8,9,10))
+count_slices = [slice(0,64), slice(64,233), slice(233,396)]
+count_prob_list = []
+for i in range(0,len(count_slices)):
+    prob,bin_edges = np.histogram(np.sum(raw_counts[count_slices[i],:],axis=1),np.arange(1,32,1),density=True)
+    count_prob_list.append(np.concatenate([prob, np.zeros(number_comparisons_per_induction - prob.size)]))
+
+raw_events = np.loadtxt('/home/main/git/chaste/projects/ISP/empirical_data/empirical_lineages.csv', skiprows=1, usecols=(3,5,8))
+observed_events = raw_events[np.where(raw_events[:,2]==1)]
+event_prob_list = []
+for i in range(0,3):
+    histo,bin_edges = np.histogram(observed_events[np.where(observed_events[:,0]==i)][:,1],rate_bin_sequence,density=False)
+    event_prob_list.append(np.array((histo/lineages_sampled_events)/5))
+
+#Wan CMZ population means & SDs at retina ages (hpf); simulations start at 72hpf
+wan_empirical_times = np.array([72,120,192,288,408,552,720,1440,2160,4320,8640])
+wan_empirical_mean = np.array([792.0, 768.4, 906.1, 1159.7, 1630.0, 3157.9, 3480.2, 4105.1, 1003.0, 477.2, 438.8088611111])
+wan_empirical_sd = np.array([160.1, 200.1, 244.5, 477.6, 444.3, 1414.3, 472.1, 1169.7, 422.8, 367.5, 294.8])
+
+
+def main():
+    os.makedirs(output_root + directory_name, exist_ok=True)
+    log = open(output_root + directory_name + "/" + log_name, "w")
+
+    if model == 0:
+        dt_levels = he_dt_levels
+        pilot_seeds = he_pilot_seeds
+    if model == 1:
+        dt_levels = wan_dt_levels
+        pilot_seeds = wan_pilot_seeds
+
+    number_levels = len(dt_levels)
+    budget = cpu_budget_hours * 3600
+
+    #per-level running sums of the corrections Y_l, their squares & the finest level's uncorrected samples
+    sums = [None] * number_levels
+    square_sums = [None] * number_levels
+    samples = np.zeros(number_levels, dtype=int)
+    costs = np.zeros(number_levels) #CPU seconds per correction sample
+    fine_sum = None
+    fine_square_sum = None
+    fine_cost = 0 #CPU seconds per finest-dt run alone
+
+    log.write("Pilot run\n")
+    for l in range(0,number_levels):
+        correction, fine, costs[l], level_fine_cost = sample_level(l, dt_levels, level_first_seed(l), pilot_seeds[l])
+        sums[l] = np.sum(correction,axis=0)
+        square_sums[l] = np.sum(np.square(correction),axis=0)
+        samples[l] = pilot_seeds[l]
+        if l == number_levels - 1:
+            fine_sum = np.sum(fine,axis=0)
+            fine_square_sum = np.sum(np.square(fine),axis=0)
+            fine_cost = level_fine_cost
+
+    variances = level_variances(sums, square_sums, samples)
+    spent = np.sum(costs * samples)
+    log_levels(log, dt_levels, samples, costs, variances)
+
+    #optimal allocation of the whole budget, N_l = B sqrt(V_l/C_l) / sum_k sqrt(V_k C_k); the pilot is already spent
+    allocation = budget * np.sqrt(variances / costs) / np.sum(np.sqrt(variances * costs))
+    extra_samples = np.maximum(np.ceil(allocation).astype(int) - samples, 0)
+
+    if spent < budget:
+        log.write("Allocated run\n")
+        for l in range(0,number_levels):
+            if extra_samples[l] == 0: continue
+            correction, fine, cost, level_fine_cost = sample_level(l, dt_levels, level_first_seed(l) + samples[l], extra_samples[l])
+            sums[l] += np.sum(correction,axis=0)
+            square_sums[l] += np.sum(np.square(correction),axis=0)
+            costs[l] = (costs[l] * samples[l] + cost * extra_samples[l]) / (samples[l] + extra_samples[l])
+            samples[l] += extra_samples[l]
+            if l == number_levels - 1:
+                fine_sum += np.sum(fine,axis=0)
+                fine_square_sum += np.sum(np.square(fine),axis=0)
+                fine_cost = (fine_cost * (samples[l] - extra_samples[l]) + level_fine_cost * extra_samples[l]) / samples[l]
+        variances = level_variances(sums, square_sums, samples)
+        log_levels(log, dt_levels, samples, costs, variances)
+
+    #MLMC estimate & its variance
+    estimate = np.sum([sums[l] / samples[l] for l in range(0,number_levels)], axis=0)
+    estimate_variance = np.sum(variances / samples)
+
+    #plain Monte Carlo at the finest dt with the same CPU time, for comparison
+    fine_variance = np.sum(fine_square_sum / samples[-1] - np.square(fine_sum / samples[-1]))
+    plain_variance = fine_variance * fine_cost / np.sum(costs * samples)
+
+    log.write("Estimate variance (summed over components): " + str(estimate_variance) + "\n")
+    log.write("Equal-CPU plain Monte Carlo variance at dt " + str(dt_levels[-1]) + ": " + str(plain_variance) + "\n")
+    log.write("Variance reduction factor: " + str(plain_variance / estimate_variance) + "\n")
+    log.write("Loss: " + str(loss(estimate)) + "\n")
+
+    np.savetxt(output_root + directory_name + "/" + log_name + "Estimate", estimate)
+    log.close()
+
+
+def level_first_seed(level):
+    return start_seed + level * level_seed_stride
+
+
+def sample_level(level, dt_levels, first_seed, number_seeds):
+    #level 0 samples P_0; level l samples the coupled correction P_l - P_(l-1) on the same seeds
+    #returns the corrections, the uncorrected fine samples, CPU seconds per correction & per fine run
+    fine, cost = simulate(dt_levels[level], first_seed, number_seeds)
+    if level == 0:
+        return fine, fine, cost, cost
+    coarse, coarse_cost = simulate(dt_levels[level-1], first_seed, number_seeds)
+    return fine - coarse, fine, cost + coarse_cost, cost
+
+
+def level_variances(sums, square_sums, samples):
+    #per-sample variance of each level's correction, summed over the estimated components
+    variances = np.zeros(len(sums))
+    for l in range(0,len(sums)):
+        mean = sums[l] / samples[l]
+        variances[l] = max(np.sum(square_sums[l] / samples[l] - np.square(mean)) * samples[l] / max(samples[l] - 1, 1), 1e-300)
+    return variances
+
+
+def log_levels(log, dt_levels, samples, costs, variances):
+    log.write("Level\tdt\tSeeds\tCPUsPerSeed\tCorrectionVariance\n")
+    for l in range(0,len(dt_levels)):
+        log.write(str(l) + "\t" + str(dt_levels[l]) + "\t" + str(samples[l]) + "\t" + str(costs[l]) + "\t" + str(variances[l]) + "\n")
+    log.flush()
+
+
+def simulate(dt, first_seed, number_seeds):
+    #returns one row of estimated components per seed, and the CPU seconds per seed
+    cpu_count = multiprocessing.cpu_count()
+    last_seed = first_seed + number_seeds - 1
+    file_stem = "Dt" + str(dt) + "Seeds" + str(first_seed)
+    command_list = []
+
+    if model == 0:
+        settings = str(deterministic_mode) + " " + str(fixture) + " " + str(ath5founder) + " 0 " + str(first_seed) + " " + str(last_seed) + " "
+        for i in range(0,len(induction_times)):
+            command_list.append("mpirun -np " + str(cpu_count) + " " + executable + " " + directory_name + " " + file_stem + "Count" + str(induction_times[i]) + " 0 "\
+                                + settings + str(induction_times[i]) + " " + str(earliest_lineage_start_time) + " " + str(latest_lineage_start_time) + " "\
+                                + str(end_time) + " " + he_theta_string + " -dt " + str(dt))
+        command_list.append("mpirun -np " + str(cpu_count) + " " + executable + " " + directory_name + " " + file_stem + "Rate 1 "\
+                            + settings + str(earliest_lineage_start_time) + " " + str(earliest_lineage_start_time) + " " + str(latest_lineage_start_time) + " "\
+                            + str(rate_end_time) + " " + he_theta_string + " -dt " + str(dt))
+    if model == 1:
+        command_list.append("mpirun -np " + str(cpu_count) + " " + executable + " " + directory_name + "/" + file_stem + " " + str(first_seed) + " " + str(last_seed) + " "\
+                            + wan_cmz_theta_string + " " + wan_stochastic_theta_string + " -dt " + str(dt))
+
+    start = time.time()
+    for command in command_list:
+        execute_command(command)
+    cost = (time.time() - start) * cpu_count / number_seeds
+
+    if model == 0: return he_components(file_stem, first_seed, number_seeds), cost
+    if model == 1: return wan_components(file_stem, first_seed, number_seeds), cost
+
+
+def he_components(file_stem, first_seed, number_seeds):
+    #per seed: count bin indicators for each induction time (bins 1-1000), then hourly PP, PD, DD expected rates per 5h bin
+    number_rate_bins = rate_bin_sequence.size - 1
+    components = np.zeros((number_seeds, len(induction_times) * number_comparisons_per_induction + 3 * number_rate_bins))
+
+    for i in range(0,len(induction_times)):
+        counts = np.loadtxt(output_root + directory_name + "/" + file_stem + "Count" + str(induction_times[i]), skiprows=1, usecols=(2,3), ndmin=2)
+        rows = counts[:,0].astype(int) - first_seed
+        bins = counts[:,1].astype(int) - 1
+        in_range = (bins >= 0) & (bins < number_comparisons_per_induction)
+        components[rows[in_range], i * number_comparisons_per_induction + bins[in_range]] = 1
+
+    #event columns: time (hpf), seed, P(PP), P(PD), P(DD)
+    events = np.loadtxt(output_root + directory_name + "/" + file_stem + "Rate", skiprows=1, usecols=(0,1,4,5,6), ndmin=2)
+    rate_bins = np.digitize(events[:,0], rate_bin_sequence) - 1
+    in_range = (rate_bins >= 0) & (rate_bins < number_rate_bins)
+    rows = events[in_range,1].astype(int) - first_seed
+    offset = len(induction_times) * number_comparisons_per_induction
+    for i in range(0,3):
+        np.add.at(components, (rows, offset + i * number_rate_bins + rate_bins[in_range]), events[in_range,2+i] / 5)
+
+    return components
+
+
+def wan_components(file_stem, first_seed, number_seeds):
+    #per seed: CMZ (transit) population at the empirical retina ages; simulations stop once no RPCs are left
+    sample_times = wan_empirical_times - wan_empirical_times[0]
+    components = np.zeros((number_seeds, sample_times.size))
+    for s in range(0,number_seeds):
+        results = np.loadtxt(output_root + directory_name + "/" + file_stem + "/Seed" + str(first_seed + s) + "Results/results_from_time_0/celltypes.dat", usecols=(0,2), ndmin=2)
+        rows = np.searchsorted(results[:,0], sample_times + 1e-9, side='right') - 1
+        components[s,:] = np.where(sample_times <= results[-1,0] + 1e-9, results[np.maximum(rows,0),1], 0)
+    return components
+
+
+def loss(estimate):
+    if model == 0:
+        #SPSA_fixture.py's AIC on the estimated histograms
+        rss = 0
+        for i in range(0,len(induction_times)):
+            histogram = estimate[i * number_comparisons_per_induction:(i + 1) * number_comparisons_per_induction]
+            rss += np.sum(np.square(histogram - count_prob_list[i]))
+        offset = len(induction_times) * number_comparisons_per_induction
+        number_rate_bins = rate_bin_sequence.size - 1
+        for i in range(0,3):
+            residual = estimate[offset + i * number_rate_bins:offset + (i + 1) * number_rate_bins] - event_prob_list[i]
+            rss += (1.5 if i == 1 else 1) * np.sum(np.square(residual)) #PD residual weighting
+        return 2 * he_model_params + number_comparisons * np.log(rss)
+    if model == 1:
+        return np.sum(np.square((estimate - wan_empirical_mean) / wan_empirical_sd))
+
+
+# This is a helper function that runs bash commands
+def execute_command(cmd):
+    return subprocess.call(cmd, shell=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,269 @@
+import multiprocessing
+import os
+import subprocess
+import datetime
+
+import numpy as np
+
+###########################################################################
+# SYNTHETIC LIKELIHOOD MCMC
+# Random walk Metropolis over the stochastic or deterministic He model parameters, scored by Wood's (2010)
+# synthetic likelihood. For each proposal, the simulator is run over a number of replicate batches, each the size
+# of the empirical sample (64, 169 & 163 lineages for the 24, 32 & 48 h induction counts; 60 lineages for the
+# mitotic mode events), so each replicate's summary statistics vary as the empirical ones do. A multivariate normal
+# is fitted to the replicate summaries & the empirical summaries are scored against it.
+# Summaries: clone size quantiles & mean for each induction time, and per-lineage PP/PD/DD event counts in coarse
+# time bins. The four components are simulated independently, so their covariance is fitted block by block.
+# Every proposal uses the same seeds (common random numbers), so differences between proposals' likelihoods
+# reflect the parameters more than simulation noise. The replicate batches of each component are split across the
+# cpus.
+# This fixture covers the He models only. The Gomes & Boije simulators log mitotic mode events, but neither fits these
+# summaries: BoijeSimulator advances by generation, so its events have no hour axis for the empirical time bins, and
+# GomesSimulator has no induction or lineage start time arguments, so it cannot produce the 32 & 48 h counts.
+###########################################################################
+
+executable = '/home/main/chaste_build/projects/ISP/apps/HeSimulator'
+output_root = '/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/'
+
+if not(os.path.isfile(executable)):
+    raise Exception('Could not find executable: ' + executable)
+
+model = 0 #0=stochastic He;1=deterministic He
+deterministic_mode = model
+
+#####################
+# MCMC SETTINGS
+#####################
+
+chain_length = 2000
+burn_in = 500 #proposal scale adapts towards target_acceptance during burn in
+target_acceptance = 0.25
+proposal_sd_zero = 0.5 #initial random walk sd, in units of each parameter's scale
+mcmc_seed = 786 #traceable RNG
+
+##############################
+# SYNTHETIC LIKELIHOOD SETTINGS
+##############################
+
+replicates = 100 #replicate batches per proposal
+covariance_shrinkage = 0.1 #covariance blocks shrunk this far towards their diagonal
+count_quantiles = [.1, .25, .5, .75, .9]
+rate_summary_bins = [30, 45, 60, 80] #coarse bins (hpf) for per-lineage mode event counts
+
+#########################
+# SIMULATION PARAMETERS
+#########################
+
+#common random numbers: replicate r of every proposal runs the same seeds
+start_seed = 0
+directory_name = "SLMCMC"
+log_name = "SLMCMCOutput"
+chain_name = "SLMCMCChain"
+fixture = 0 #0=He 2012;1=Wan 2016
+ath5founder = 0
+
+earliest_lineage_start_time = 23.0
+latest_lineage_start_time = 39.0
+induction_times = [ 24, 32, 48 ]
+end_time = 72.0
+rate_end_time = 80
+
+################################################################
+# SAMPLED PARAMETERS: starting values, scales, uniform prior bounds
+################################################################
+
+#STOCHASTIC HE: phase2, phase3 (phase lengths), PP2, PD2, PP3; phase 1 PP & phase 3 PD fixed
+he_names = ["phase2", "phase3", "PP2", "PD2", "PP3"]
+he_theta_zero = np.array([8, 7, .2, .4, .2])
+he_scale = np.array([1, 1, .1, .1, .1])
+he_lower = np.array([4, 0, 0, 0, 0]) #phase 2 below 4h has no effect (refractory period after first division)
+he_upper = np.array([20, 20, 1, 1, 1])
+phase_1_pPP = 1.0
+phase_1_pPD = 0.0
+phase_3_pPD = 0.0
+
+#DETERMINISTIC HE: phase boundary gamma shapes & scales, sister shift width, offset
+det_names = ["p1Sh", "p1Sc", "p2Sh", "p2Sc", "sisterShift", "offset"]
+det_theta_zero = np.array([3, 2, 2, 2, .25, 0])
+det_scale = np.array([1, 1, 1, 1, 1, 3])
+det_lower = np.array([.1, .1, .1, .1, .1, -10])
+det_upper = np.array([10, 10, 10, 10, 2, 10])
+
+if model == 0: names, theta_zero, scale, lower, upper = he_names, he_theta_zero, he_scale, he_lower, he_upper
+if model == 1: names, theta_zero, scale, lower, upper = det_names, det_theta_zero, det_scale, det_lower, det_upper
+
+##############################
+# HE ET AL EMPIRICAL RESULTS
+##############################
+
+raw_counts = np.loadtxt('/home/main/git/chaste/projects/ISP/empirical_data/empirical_counts.csv', skiprows=1, usecols=(3,4,5,6,7,8,9,10)) #collect the per-cell-type counts
+raw_counts_list = [raw_counts[0:64,:], raw_counts[64:233,:], raw_counts[233:396,:]]
+empirical_clone_sizes = [np.sum(raw_induction_counts,axis=1) for raw_induction_counts in raw_counts_list]
+
+lineages_sampled_events = 60
+
+raw_events = np.loadtxt('/home/main/git/chaste/projects/ISP/empirical_data/empirical_lineages.csv', skiprows=1, usecols=(3,5,8))
+observed_events = raw_events[np.where(raw_events[:,2]==1)] #exclude any mitosis whose time was too early for recording
+
+#replicate batch sizes match the empirical samples
+count_batch_sizes = [clone_sizes.size for clone_sizes in empirical_clone_sizes]
+
+#setup the log file
+log_filename = output_root + directory_name + "/" + log_name
+os.makedirs(os.path.dirname(log_filename), exist_ok=True)
+
+log = open(log_filename,"w")
+
+def main():
+    p_RNG = np.random.RandomState(seed=mcmc_seed)
+
+    # Use processes equal to the number of cpus available; each component's replicates are split into chunks
+    cpu_count = multiprocessing.cpu_count()
+    pool = multiprocessing.Pool(processes=cpu_count)
+    chunks = max(1, min(replicates, cpu_count // (len(induction_times) + 1)))
+
+    observed_summaries = [count_summary(clone_sizes) for clone_sizes in empirical_clone_sizes]
+    observed_summaries.append(rate_summary(observed_events[:,1], observed_events[:,0], lineages_sampled_events))
+
+    log.write("Began synthetic likelihood MCMC of He model " + str(model) + " @\n" + str(datetime.datetime.now()) + "\n")
+    log.write(str(replicates) + " replicates per proposal, in " + str(chunks) + " chunks per component\n")
+
+    chain_file = open(output_root + directory_name + "/" + chain_name, "w")
+    chain_file.write("i\t" + "\t".join(names) + "\tlogSL\taccepted\tproposalSD\n")
+
+    theta = theta_zero
+    log_likelihood = synthetic_log_likelihood(theta, observed_summaries, chunks, pool)
+    proposal_sd = proposal_sd_zero
+    accepted = 0
+
+    for i in range(0, chain_length):
+        proposal = theta + proposal_sd * scale * p_RNG.standard_normal(theta.size)
+
+        #uniform prior: proposals outside its support are rejected without simulation
+        proposal_accepted = False
+        if in_prior_support(proposal):
+            proposal_log_likelihood = synthetic_log_likelihood(proposal, observed_summaries, chunks, pool)
+            if np.log(p_RNG.uniform()) < proposal_log_likelihood - log_likelihood:
+                theta, log_likelihood = proposal, proposal_log_likelihood
+                proposal_accepted = True
+                accepted += 1
+
+        #Robbins-Monro adaptation of the proposal scale during burn in
+        if i < burn_in:
+            proposal_sd = proposal_sd * np.exp((float(proposal_accepted) - target_acceptance) / np.sqrt(i + 1))
+
+        chain_file.write(str(i) + "\t" + "\t".join([str(v) for v in theta]) + "\t" + str(log_likelihood) + "\t" + str(int(proposal_accepted)) + "\t" + str(proposal_sd) + "\n")
+        chain_file.flush()
+
+    log.write("Acceptance rate " + str(accepted / chain_length) + ", final proposal sd " + str(proposal_sd) + "\n")
+    log.write("Finished @\n" + str(datetime.datetime.now()) + "\n")
+    chain_file.close()
+    log.close()
+    pool.close()
+
+def in_prior_support(theta):
+#Uniform prior bounds & the simulator's validity constraints
+    if np.any(theta < lower) or np.any(theta > upper): return False
+    if model == 0:
+        return theta[2] + theta[3] <= 1 #pPP2 + pPD2 <= 1
+    #as SPSA: 95% of sister shift values less than the smallest mean phase time
+    return theta[4] <= min(theta[0]*theta[1], theta[2]*theta[3])/2
+
+##############################
+# SUMMARY STATISTICS
+##############################
+
+def count_summary(clone_sizes):
+    return np.append(np.quantile(clone_sizes, count_quantiles), np.mean(clone_sizes))
+
+def rate_summary(event_times, event_modes, lineages):
+#PP, PD & DD events per lineage in each coarse time bin
+    summary = []
+    for mode in range(0, 3):
+        histo_mode, bin_edges = np.histogram(event_times[np.where(event_modes == mode)], rate_summary_bins)
+        summary.append(histo_mode / lineages)
+    return np.concatenate(summary)
+
+def quantisation_variance(component):
+#Summaries of whole clone sizes & event counts move in discrete steps; their rounding variance keeps covariance
+#blocks non-singular where a summary does not vary over the replicates (eg. the lower quantiles of small clones)
+    if component < len(induction_times):
+        return np.append(np.full(len(count_quantiles), 1/12), 1/(12 * count_batch_sizes[component]**2))
+    return np.full(3 * (len(rate_summary_bins) - 1), 1/(12 * lineages_sampled_events**2))
+
+def mvn_log_density(x, mean, covariance):
+    L = np.linalg.cholesky(covariance)
+    z = np.linalg.solve(L, x - mean)
+    return -0.5 * z.dot(z) - np.sum(np.log(np.diag(L))) - 0.5 * x.size * np.log(2 * np.pi)
+
+##############################
+# SYNTHETIC LIKELIHOOD
+##############################
+
+def parameter_string(theta):
+    if model == 0:
+        return str(theta[0])+" "+str(theta[1])+" "+str(phase_1_pPP)+" "+str(phase_1_pPD)+" "+str(theta[2])+" "+str(theta[3])+" "+str(theta[4])+" "+str(phase_3_pPD)
+    return " ".join([str(v) for v in theta])
+
+def chunk_bounds(chunks):
+#Replicate ranges [first, last) of each chunk
+    edges = np.linspace(0, replicates, chunks + 1).astype(int)
+    return [(edges[c], edges[c+1]) for c in range(0, chunks) if edges[c+1] > edges[c]]
+
+def proposal_commands(theta, chunks):
+#One command per component & chunk; replicate r of a component runs seeds start_seed + r*batch .. start_seed + (r+1)*batch - 1
+    command_list = []
+    parameters = parameter_string(theta)
+    for (first, last) in chunk_bounds(chunks):
+        for i in range(0, len(induction_times)):
+            batch = count_batch_sizes[i]
+            command_list.append(executable+" "+directory_name+" Counts"+str(induction_times[i])+"C"+str(first)+" 0 "+str(deterministic_mode)+" "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                                +str(start_seed + first*batch)+" "+str(start_seed + last*batch - 1)+" "+str(induction_times[i])+" "+str(earliest_lineage_start_time)+" "\
+                                +str(latest_lineage_start_time)+" "+str(end_time)+" "+parameters)
+        batch = lineages_sampled_events
+        command_list.append(executable+" "+directory_name+" RateC"+str(first)+" 1 "+str(deterministic_mode)+" "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                            +str(start_seed + first*batch)+" "+str(start_seed + last*batch - 1)+" "+str(earliest_lineage_start_time)+" "+str(earliest_lineage_start_time)+" "\
+                            +str(latest_lineage_start_time)+" "+str(rate_end_time)+" "+parameters)
+    return command_list
+
+def replicate_summaries(chunks):
+#Summary matrices (replicates x statistics) for each component, from the chunks' output
+    counts = [[] for i in range(0, len(induction_times))]
+    rates = []
+    for (first, last) in chunk_bounds(chunks):
+        for i in range(0, len(induction_times)):
+            batch = count_batch_sizes[i]
+            #count columns: Entry, Induction Time (h), Seed, Count
+            output = np.loadtxt(output_root + directory_name + "/Counts" + str(induction_times[i]) + "C" + str(first), skiprows=1, usecols=(2,3), ndmin=2)
+            for r in range(first, last):
+                in_batch = (output[:,0] >= start_seed + r*batch) & (output[:,0] < start_seed + (r+1)*batch)
+                counts[i].append(count_summary(output[in_batch,1]))
+
+        #event columns: Time (hpf), Seed, CellID, Mode
+        batch = lineages_sampled_events
+        events = np.loadtxt(output_root + directory_name + "/RateC" + str(first), skiprows=1, usecols=(0,1,3), ndmin=2)
+        for r in range(first, last):
+            in_batch = (events[:,1] >= start_seed + r*batch) & (events[:,1] < start_seed + (r+1)*batch)
+            rates.append(rate_summary(events[in_batch,0], events[in_batch,2], batch))
+
+    return [np.array(component) for component in counts] + [np.array(rates)]
+
+def synthetic_log_likelihood(theta, observed_summaries, chunks, pool):
+    pool.map(execute_command, proposal_commands(theta, chunks), 1)
+
+    log_likelihood = 0
+    simulated_summaries = replicate_summaries(chunks)
+    for c in range(0, len(simulated_summaries)):
+        mean = np.mean(simulated_summaries[c], axis=0)
+        covariance = np.atleast_2d(np.cov(simulated_summaries[c].T))
+        covariance = (1 - covariance_shrinkage) * covariance + covariance_shrinkage * np.diag(np.diag(covariance))
+        covariance = covariance + np.diag(quantisation_variance(c))
+        log_likelihood += mvn_log_density(observed_summaries[c], mean, covariance)
+    return log_likelihood
+
+# This is a helper function for run_simulation that runs bash commands in separate processes
+def execute_command(cmd):
+    return subprocess.call(cmd, shell=True)
+
+if __name__ == "__main__":
+    main()
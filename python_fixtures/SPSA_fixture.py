@@ -2,6 +2,7 @@ import multiprocessing
 import os
 import subprocess
 import datetime
+import time
 
 import numpy as np
 import matplotlib.pyplot as plt
@@ -33,10 +34,26 @@ gamma = .101
 ###########################
 
 max_iterations = 199
+perturbations = 1 #simultaneous perturbation vectors per iteration, gradient estimates averaged (0=as many as fill the cpus)
+pipelined = 0 #0=plot each iterate interactively before continuing;1=analyse perturbations as their runs finish, plot & bootstrap in a background process
 number_comparisons = 3030 #total number of comparison points between model output and empirical data (1000 per induction time, 10 per rate mode)
 number_comparisons_per_induction = 1000
 error_samples = 5000 #number of samples to draw when estimating plausibility interval for simulations
 
+#adaptive seed budget: each loss evaluation's seed ranges are split into replicate batches, whose spread estimates the
+#noise in the AIC difference; seeds are only added when the gradient's signal-to-noise ratio is too low to resolve it
+adaptive_seeds = 0 #0=fixed schedule (more seeds @ iterations 169, 189);1=grow seeds when gradient SNR < snr_threshold
+replicate_batches = 10 #contiguous seed blocks per evaluation; each must hold at least one lineage (antithetic pair)
+snr_threshold = 2.0 #|AIC difference| / its estimated standard error
+seed_growth = 2 #seed range multiplier when the SNR is below threshold
+max_end_seed = 4999
+max_rate_end_seed = 1249
+
+#Neyman allocation: the seed budget is shared between the loss components (count runs at each induction time, rate
+#run) in proportion to each component's per-lineage loss difference standard deviation / sqrt(per-lineage cost)
+neyman_allocation = 0 #0=every count run gets end_seed, the rate run rate_end_seed;1=re-balance seeds between iterations
+allocation_smoothing = 0.5 #weight of the newest evaluation in the running variance & cost estimates
+
 #########################
 # SIMULATION PARAMETERS
 #########################
@@ -56,7 +73,12 @@ count_output_mode = 0 #0=lineage counts;1=mitotic event logging;2=sequence sampl
 event_output_mode = 1
 fixture = 0 #0=He 2012;1=Wan 2016
 debug_output = 0 #0=off;1=on
+expected_rates = 0 #0=histogram sampled modes;1=histogram each division's mode probabilities (lower variance rate residuals)
 ath5founder = 0 #0=no morpholino 1=ath5 morpholino
+tilt = 0 #importance sampling tilt of count runs towards PP divisions (0=off, <1); weighted histograms populate the large-clone tail
+split_time = 0 #lineage splitting of count runs: simulation time (h) at which running lineages fork (0=off)
+split_continuations = 4 #continuations per forked lineage, each weighted 1/split_continuations
+antithetic = 0 #0=independent seeds;1=antithetic seed pairs (mirrored mode & cycle draws); seed ranges must hold whole pairs
 
 ##########################
 #GLOBAL MODEL PARAMETERS
@@ -172,9 +194,24 @@ plt.ion()
 fig, ((plt0, plt1, plt2),(plt3, plt4, plt5)) = plt.subplots(2,3,figsize=(12,6))
 plot_list = [plt0,plt1,plt2,plt3,plt4,plt5]
 
+#worker pools, started in main(): simulator commands, and the background plotting stage (one process, lags at most one iterate)
+simulation_pool = None
+plot_pool = None
+plot_job = None
+
+#Neyman allocation state: seed multipliers relative to the budget's ranges, running per-lineage variance & cost estimates
+seed_allocation = np.ones(len(induction_times)+1)
+component_variance = np.zeros(len(induction_times)+1)
+component_cost = np.zeros(len(induction_times)+1)
+rate_lineages_simulated = rate_end_seed + 1
+
 
 def main():
-    global theta_spsa, a,c,file_name,scale_vector,end_seed,rate_end_seed,alpha,gamma
+    global theta_spsa, a,c,file_name,scale_vector,end_seed,rate_end_seed,alpha,gamma,seed_allocation,component_variance,component_cost,simulation_pool,plot_pool
+    
+    # Use processes equal to the number of cpus available; the pools persist across iterates
+    simulation_pool = multiprocessing.Pool(processes=multiprocessing.cpu_count())
+    if pipelined == 1: plot_pool = multiprocessing.Pool(processes=1)
     
     for m in range(0,len(deterministic_modes)):
         
@@ -203,6 +240,11 @@ def main():
             log.write("k\tp1Sh\tp1Sc\tp2Sh\tp2Sc\tsisterShift\toffset\n")
             number_params = det_model_params
         
+        #perturbations per iteration: as many whole perturbations' simulator commands (rate & count runs, +/-) as cpus
+        commands_per_perturbation = 2 * (len(induction_times) + 1)
+        number_perturbations = perturbations if perturbations > 0 else max(1, multiprocessing.cpu_count() // commands_per_perturbation)
+        log.write("Averaging " + str(number_perturbations) + " perturbations per iteration\n")
+        
         #SPSA algorithm iterator k starts at 0
         k=0
        
@@ -210,28 +252,27 @@ def main():
             if k == 0:
                 end_seed = 249
                 rate_end_seed = 99
+                seed_allocation = np.ones(len(induction_times)+1)
+                component_variance = np.zeros(len(induction_times)+1)
+                component_cost = np.zeros(len(induction_times)+1)
         
-            #@defined iterate, increase # of seed to decrease RNG noise to low level
-            if k == 169:
-                end_seed = 999
-                rate_end_seed = 249
-        
-        
-            #@defined iterate, increase # of seeds to decrease RNG noise to close to nil, switch to asymptotically optimal alpha and gamma
-            if k == 189:
-                end_seed = 4999
-                rate_end_seed = 1249
-                alpha = 1
-                gamma = (1/6)
+            if adaptive_seeds == 0:
+                #@defined iterate, increase # of seed to decrease RNG noise to low level
+                if k == 169:
+                    end_seed = 999
+                    rate_end_seed = 249
+            
+                #@defined iterate, increase # of seeds to decrease RNG noise to close to nil, switch to asymptotically optimal alpha and gamma
+                if k == 189:
+                    end_seed = 4999
+                    rate_end_seed = 1249
+                    alpha = 1
+                    gamma = (1/6)
             
             #write the parameter set to be evaluated to file
             if deterministic_mode == 0: log.write(str(k) + "\t" + str(theta_spsa[0]) + "\t" + str(theta_spsa[1]) + "\t" + str(theta_spsa[2]) + "\t" + str(theta_spsa[3]) + "\t" + str(theta_spsa[4]) + "\n")
             if deterministic_mode == 1: log.write(str(k) + "\t" + str(theta_spsa[0]) + "\t" + str(theta_spsa[1]) + "\t" + str(theta_spsa[2]) + "\t" + str(theta_spsa[3]) + "\t" + str(theta_spsa[4])+ "\t" + str(theta_spsa[5]) + "\n")
         
-            #populate the deltak perturbation vector with samples from a .5p bernoulli +1 -1 distribution
-            delta_k = bernoulli.rvs(.5, size=theta_spsa.size, random_state=p_RNG)
-            delta_k[delta_k == 0] = -1
-        
             ak = a / ((A + k + 1)**alpha) #calculate ak from gain sequence
             scaled_ak = ak * scale_vector #scale ak appropriately for parameters expressed in hrs & percent
 
@@ -241,15 +282,31 @@ def main():
             #Project theta_spsa into space bounded by ck to allow gradient sampling at bounds of probability space
             projected_theta = project_theta(theta_spsa, scaled_ck, deterministic_mode)
 
-            #Calculate theta+ and theta- vectors for gradient estimate
-            theta_plus = projected_theta + scaled_ck * delta_k
-            theta_minus = projected_theta - scaled_ck * delta_k
+            delta_list = []
+            theta_plus_list = []
+            theta_minus_list = []
+            for p in range(0,number_perturbations):
+                #populate the deltak perturbation vector with samples from a .5p bernoulli +1 -1 distribution
+                delta_k = bernoulli.rvs(.5, size=theta_spsa.size, random_state=p_RNG)
+                delta_k[delta_k == 0] = -1
+                delta_list.append(delta_k)
+                
+                #Calculate theta+ and theta- vectors for gradient estimate
+                theta_plus_list.append(projected_theta + scaled_ck * delta_k)
+                theta_minus_list.append(projected_theta - scaled_ck * delta_k)
 
-            AIC_gradient = evaluate_AIC_gradient(k, theta_plus, theta_minus, deterministic_mode, number_params, file_name)
+            AIC_gradients, AIC_standard_errors = evaluate_AIC_gradients(k, theta_plus_list, theta_minus_list, deterministic_mode, number_params, file_name)
 
-            ghat = ((AIC_gradient) / (2 * ck)) * delta_k
+            #batch SPSA: average the perturbations' independent gradient estimates
+            ghat = np.zeros(theta_spsa.size)
+            for p in range(0,number_perturbations):
+                ghat = ghat + ((AIC_gradients[p]) / (2 * ck)) * delta_list[p] / number_perturbations
+            
+            #gradient signal-to-noise: |ghat| over the norm of its standard errors (each component has the same error)
+            ghat_standard_error = np.sqrt(theta_spsa.size * np.sum(np.square(AIC_standard_errors))) / (number_perturbations * 2 * ck)
+            gradient_snr = np.linalg.norm(ghat) / ghat_standard_error if ghat_standard_error > 0 else np.inf
 
-            log.write("ghat0: " + str(ghat[0]) + "\n")
+            log.write("ghat0: " + str(ghat[0]) + " GradientSNR: " + str(gradient_snr) + "\n")
 
             #update new theta_spsa
             theta_spsa = theta_spsa - scaled_ak * ghat
@@ -257,14 +314,99 @@ def main():
             #constrain updated theta_spsa
             theta_spsa = project_theta(theta_spsa, np.zeros(theta_spsa.size), deterministic_mode)
 
+            if adaptive_seeds == 1: update_seed_budget(gradient_snr)
+
             k+=1
         
         #write final result and close log
         if deterministic_mode == 0: log.write(str(k) + "\t" + str(theta_spsa[0]) + "\t" + str(theta_spsa[1]) + "\t" + str(theta_spsa[2]) + "\t" + str(theta_spsa[3]) + "\t" + str(theta_spsa[4]) + "\n")
         if deterministic_mode == 1: log.write(str(k) + "\t" + str(theta_spsa[0]) + "\t" + str(theta_spsa[1]) + "\t" + str(theta_spsa[2]) + "\t" + str(theta_spsa[3]) + "\t" + str(theta_spsa[4])+ "\t" + str(theta_spsa[5]) + "\n")
 
+    if plot_pool is not None:
+        plot_pool.close()
+        plot_pool.join()
+    simulation_pool.close()
+    
     log.close
 
+def update_seed_budget(gradient_snr):
+#Grow the seed ranges when the AIC difference is not resolved from its sampling noise
+#Once the budget reaches its maximum, noise is as low as it will get: switch to asymptotically optimal alpha and gamma
+    global end_seed, rate_end_seed, alpha, gamma
+    
+    if gradient_snr < snr_threshold and end_seed < max_end_seed:
+        end_seed = min((end_seed + 1) * seed_growth, max_end_seed + 1) - 1
+        rate_end_seed = min((rate_end_seed + 1) * seed_growth, max_rate_end_seed + 1) - 1
+        log.write("Gradient SNR " + str(gradient_snr) + " < " + str(snr_threshold) + ", seeds increased to " + str(end_seed + 1) + " (counts), " + str(rate_end_seed + 1) + " (rates)\n")
+        
+        if end_seed == max_end_seed:
+            alpha = 1
+            gamma = (1/6)
+
+def component_end_seeds():
+#Last seed of each loss component's runs (counts at each induction time, then rates): the budget's seed ranges scaled
+#by the Neyman allocation, in whole antithetic pairs, with at least one lineage (pair) per replicate batch
+    pair = 2 if antithetic == 1 else 1
+    base_seeds = np.array([end_seed + 1] * len(induction_times) + [rate_end_seed + 1])
+    seeds = np.maximum(np.round(base_seeds * seed_allocation / pair) * pair, replicate_batches * pair)
+    return (start_seed + seeds - 1).astype(int)
+
+def update_seed_allocation(variance_sample, cost_sample):
+#Neyman allocation at fixed cost: n_j proportional to S_j / sqrt(c_j) minimises sum_j S_j^2 / n_j subject to
+#sum_j c_j n_j = budget, where S_j^2 is component j's per-lineage loss difference variance and c_j its per-lineage cost
+    global seed_allocation, component_variance, component_cost
+    
+    if np.all(component_cost == 0):
+        component_variance = variance_sample
+        component_cost = cost_sample
+    else:
+        component_variance = (1 - allocation_smoothing) * component_variance + allocation_smoothing * variance_sample
+        component_cost = (1 - allocation_smoothing) * component_cost + allocation_smoothing * cost_sample
+    
+    if np.sum(component_variance) <= 0 or np.any(component_cost <= 0):
+        return
+    
+    base_seeds = np.array([end_seed + 1] * len(induction_times) + [rate_end_seed + 1])
+    budget = np.sum(component_cost * base_seeds)
+    neyman_seeds = np.sqrt(component_variance / component_cost)
+    neyman_seeds = neyman_seeds * budget / np.sum(component_cost * neyman_seeds)
+    seed_allocation = neyman_seeds / base_seeds
+    
+    log.write("Seed allocation (counts @ induction times, rates): " + str(seed_allocation) + "\n")
+
+def seed_batches(seeds, last_seed):
+#Replicate batch of each output row's seed: contiguous seed blocks, keeping antithetic pairs within one batch
+    pair = 2 if antithetic == 1 else 1
+    units = (last_seed - start_seed + 1) // pair
+    return ((seeds.astype(int) - start_seed) // pair) * replicate_batches // units
+
+def count_rss(output, empirical_prob, weighted):
+#RSS of one induction time's count histogram; output columns are seed, count (, weight)
+    if weighted:
+        #likelihood ratio & split weighted histograms, normalised by lineage (seed) number: unbiased bin probabilities
+        histo, bin_edges = np.histogram(output[:,1], bins=1000, range=(1,1001), weights=output[:,2])
+        prob_histo = histo / np.unique(output[:,0]).size
+    else:
+        prob_histo, bin_edges = np.histogram(output[:,1], bins=1000, range=(1,1001), density=True)
+    
+    return np.sum(np.square(prob_histo - empirical_prob))
+
+def rate_rss(rates, mode, lineages):
+#RSS of one mitotic mode's rate histogram; rates columns are time (hpf), seed, sampled mode, P(PP), P(PD), P(DD)
+    if expected_rates == 1:
+        #each division contributes its probability of mode i: same expectation as the sampled mode counts, less variance
+        histo_rate, bin_edges = np.histogram(rates[:,0], rate_bin_sequence, weights=rates[:,3+mode], density=False)
+    else:
+        histo_rate, bin_edges = np.histogram(rates[np.where(rates[:,2]==mode)][:,0], rate_bin_sequence, density=False)
+    
+    #hourly per-lineage probabilities
+    prob_histo_rate = np.array(histo_rate / (lineages*5))
+    residual = prob_histo_rate - event_prob_list[mode]
+    
+    #PD RESIUDAL WEIGHTING
+    if mode == 1: return np.sum(1.5*np.square(residual))
+    return np.sum(np.square(residual))
+
 def project_theta(theta, boundary, deterministic_mode):
 # Required projection is onto unit triangle modified by boundary (ck value)
 # Values outside the lower bounds are reset first
@@ -310,18 +452,32 @@ def project_theta(theta, boundary, deterministic_mode):
 
     return theta
 
-def evaluate_AIC_gradient(k, theta_plus, theta_minus, deterministic_mode, number_params, file_name):
+def simulation_commands(theta_plus, theta_minus, deterministic_mode, file_name, end_seeds):
     #Form the simulator commands for current thetas and deterministic modes
     command_list = []
     base_command = executable
     
+    #simulator options are appended after the positional arguments
+    options = ""
+    if antithetic == 1:
+        if (end_seed - start_seed + 1) % 2 != 0 or (rate_end_seed - start_seed + 1) % 2 != 0:
+            raise Exception('Antithetic runs need an even number of seeds, so that no pair is split')
+        options = " -antithetic"
+    
+    #tilting applies to the stochastic model's count runs only
+    count_options = options
+    if tilt > 0 and deterministic_mode == 0:
+        count_options = options + " -tilt " + str(tilt)
+    if split_time > 0:
+        count_options = count_options + " -split " + str(split_time) + " " + str(split_continuations)
+    
     rate_settings = str(event_output_mode)+" "\
                     +str(deterministic_mode)+" "\
                     +str(fixture)+" "\
                     +str(ath5founder)+" "\
                     +str(debug_output)+" "\
                     +str(start_seed)+" "\
-                    +str(rate_end_seed)+" "\
+                    +str(end_seeds[-1])+" "\
                     +str(earliest_lineage_start_time)+" "\
                     +str(earliest_lineage_start_time)+" "\
                     +str(latest_lineage_start_time)+" "\
@@ -332,8 +488,7 @@ def evaluate_AIC_gradient(k, theta_plus, theta_minus, deterministic_mode, number
                         +str(fixture)+" "\
                         +str(ath5founder)+" "\
                         +str(debug_output)+" "\
-                        +str(start_seed)+" "\
-                        +str(end_seed)+" "
+                        +str(start_seed)+" "
     
     count_settings_2 = str(earliest_lineage_start_time)+" "\
                         +str(latest_lineage_start_time)+" "\
@@ -362,12 +517,14 @@ def evaluate_AIC_gradient(k, theta_plus, theta_minus, deterministic_mode, number
         command_rate_plus = base_command\
                     +" "+directory_name+" "+ file_name+"RatePlus "\
                     +rate_settings\
-                    +stochastic_params_plus
+                    +stochastic_params_plus\
+                    +options
                         
         command_rate_minus = base_command\
                     +" "+directory_name+" "+ file_name+"RateMinus "\
                     +rate_settings\
-                    +stochastic_params_minus
+                    +stochastic_params_minus\
+                    +options
 
         command_list.append(command_rate_plus)
         command_list.append(command_rate_minus)
@@ -376,16 +533,20 @@ def evaluate_AIC_gradient(k, theta_plus, theta_minus, deterministic_mode, number
             command_plus = base_command\
                         +" "+directory_name+" "+file_name+str(induction_times[i])+"Plus "\
                         +count_settings_1\
+                        +str(end_seeds[i])+" "\
                         +str(induction_times[i])+" "\
                         +count_settings_2\
-                        +stochastic_params_plus
+                        +stochastic_params_plus\
+                        +count_options
                         
             command_minus = base_command\
                         +" "+directory_name+" "+file_name+str(induction_times[i])+"Minus "\
                         +count_settings_1\
+                        +str(end_seeds[i])+" "\
                         +str(induction_times[i])+" "\
                         +count_settings_2\
-                        +stochastic_params_minus
+                        +stochastic_params_minus\
+                        +count_options
                         
             command_list.append(command_plus)
             command_list.append(command_minus)
@@ -409,12 +570,14 @@ def evaluate_AIC_gradient(k, theta_plus, theta_minus, deterministic_mode, number
         command_rate_plus = base_command\
                     +" "+directory_name+" "+ file_name+"RatePlus "\
                     +rate_settings\
-                    +deterministic_params_plus
+                    +deterministic_params_plus\
+                    +options
                 
         command_rate_minus = base_command\
                     +" "+directory_name+" "+ file_name+"RateMinus "\
                     +rate_settings\
-                    +deterministic_params_minus
+                    +deterministic_params_minus\
+                    +options
 
         command_list.append(command_rate_plus)
         command_list.append(command_rate_minus)
@@ -423,92 +586,158 @@ def evaluate_AIC_gradient(k, theta_plus, theta_minus, deterministic_mode, number
             command_plus = base_command\
                         +" "+directory_name+" "+file_name+str(induction_times[i])+"Plus "\
                         +count_settings_1\
+                        +str(end_seeds[i])+" "\
                         +str(induction_times[i])+" "\
                         +count_settings_2\
-                        +deterministic_params_plus
+                        +deterministic_params_plus\
+                        +count_options
                         
             command_minus = base_command\
                         +" "+directory_name+" "+file_name+str(induction_times[i])+"Minus "\
                         +count_settings_1\
+                        +str(end_seeds[i])+" "\
                         +str(induction_times[i])+" "\
                         +count_settings_2\
-                        +deterministic_params_minus
+                        +deterministic_params_minus\
+                        +count_options
                         
             command_list.append(command_plus)
             command_list.append(command_minus)
             
 
+    return command_list
+
+def evaluate_AIC_gradients(k, theta_plus_list, theta_minus_list, deterministic_mode, number_params, file_name):
+    global rate_lineages_simulated, plot_job
+    
+    #seed ranges for each count run, then the rate run
+    end_seeds = component_end_seeds()
+    rate_lineages_simulated = end_seeds[-1] - start_seed + 1
+    
+    #every perturbation's commands go to the pool together; the first perturbation keeps the unsuffixed file names
+    command_list = []
+    perturbation_file_names = []
+    for p in range(0,len(theta_plus_list)):
+        perturbation_file_names.append(file_name if p == 0 else file_name + "P" + str(p))
+        command_list += simulation_commands(theta_plus_list[p], theta_minus_list[p], deterministic_mode, perturbation_file_names[p], end_seeds)
+
     # Use processes equal to the number of cpus available
     cpu_count = multiprocessing.cpu_count()
 
-    print("Starting simulations for iterate " + str(k) + " with " + str(cpu_count) + " processes, " + str(end_seed+1) + " lineages simulated for counts, " + str(rate_end_seed+1) + " lineages for events")
+    print("Starting simulations for iterate " + str(k) + " with " + str(cpu_count) + " processes, " + str(len(theta_plus_list)) + " perturbations, " + str(end_seeds[:-1]-start_seed+1) + " lineages simulated for counts, " + str(end_seeds[-1]-start_seed+1) + " lineages for events")
 
     log.flush() #required to prevent pool from jamming up log for some reason
     
-    # Generate a pool of workers
-    pool = multiprocessing.Pool(processes=cpu_count)
+    # Queue every bash command on the pool; each perturbation is analysed as soon as its own commands are complete
+    # command times give each component's per-lineage cost for the seed allocation
+    command_jobs = [simulation_pool.apply_async(timed_command, (cmd,)) for cmd in command_list]
+    commands_per_perturbation = len(command_list) // len(theta_plus_list)
+    command_times = np.zeros(len(command_list))
+    
+    AIC_gradients = np.zeros(len(theta_plus_list))
+    AIC_standard_errors = np.zeros(len(theta_plus_list))
+    variance_samples = []
+    for p in range(0,len(theta_plus_list)):
+        for j in range(p * commands_per_perturbation, (p + 1) * commands_per_perturbation):
+            command_times[j] = command_jobs[j].get()
+        AIC_gradients[p], AIC_standard_errors[p], batch_differences, perturbation_plot_data = analyse_perturbation(k, theta_plus_list[p], theta_minus_list[p], deterministic_mode, number_params, perturbation_file_names[p], end_seeds)
+        component_lineages = end_seeds - start_seed + 1
+        #per-lineage variance: var(full) ~ var(batch) / batches, times the lineages simulated
+        variance_samples.append(np.var(batch_differences, axis=0, ddof=1) / replicate_batches * component_lineages)
+        #the first perturbation is plotted
+        if p == 0: plot_data = perturbation_plot_data
+    
+    figure_filename = "/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/" +directory_name +"/" + "SDmode" + str(deterministic_mode) + "iterate" + str(k) + ".png"
+    if pipelined == 1:
+        #hand plotting & bootstrap intervals to the background stage; plot data are copies, as the next iterate overwrites the output files
+        if plot_job is not None: plot_job.get()
+        plot_job = plot_pool.apply_async(plot_iterate, (plot_data, rate_lineages_simulated, figure_filename))
+    else:
+        #clear the plots on the interactive figure
+        for i in range(0, len(plot_list)):
+            plt.sca(plot_list[i])
+            plt.cla()
+        for i in range(0, len(plot_data)):
+            plotter(plot_list[i], *plot_data[i])
+        plt.show()
+        plt.savefig(figure_filename)
+    
+    if neyman_allocation == 1:
+        #per-lineage cost of each component's plus & minus runs (each perturbation's commands are rate+, rate-, then each induction time +, -)
+        perturbation_times = np.mean(command_times.reshape(len(theta_plus_list), -1), axis=0)
+        run_times = np.append(perturbation_times[2::2] + perturbation_times[3::2], perturbation_times[0] + perturbation_times[1])
+        cost_sample = run_times / (2 * (end_seeds - start_seed + 1))
+        update_seed_allocation(np.mean(variance_samples, axis=0), cost_sample)
+    
+    return AIC_gradients, AIC_standard_errors
 
-    # Pass the list of bash commands to the pool, block until pool is complete
-    pool.map(execute_command, command_list, 1)
+def analyse_perturbation(k, theta_plus, theta_minus, deterministic_mode, number_params, file_name, end_seeds):
+#RSS & AIC of one perturbation's plus & minus runs
+#Returns the AIC difference, its standard error from the replicate batches, the batches' per-component RSS differences,
+#and the plotter arguments for each subplot
+    plot_data = []
     
     #these numpy arrays hold the individual RSS vals for timepoints + rates
     rss_plus = np.zeros(len(induction_times)+3)
     rss_minus = np.zeros(len(induction_times)+3)
+    #and the same for each replicate batch of seeds
+    batch_rss_plus = np.zeros((replicate_batches,len(induction_times)+3))
+    batch_rss_minus = np.zeros((replicate_batches,len(induction_times)+3))
     
-    #clear the plots on the interactive figure
-    for i in range(0, len(plot_list)):
-        plt.sca(plot_list[i])
-        plt.cla()
+    #count columns: seed, count (, weight)
+    weighted = (tilt > 0 and deterministic_mode == 0) or split_time > 0
+    count_columns = (2,3,4) if weighted else (2,3)
     
     #calculate RSS for each induction timepoint
     for i in range(0,len(induction_times)):
-        counts_plus = np.loadtxt("/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/" + directory_name + "/" + file_name + str(induction_times[i]) + "Plus", skiprows=1, usecols=3)
-        counts_minus = np.loadtxt("/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/" + directory_name + "/" + file_name + str(induction_times[i]) + "Minus", skiprows=1, usecols=3)
-        prob_histo_plus, bin_edges = np.histogram(counts_plus, bins=1000, range=(1,1001),density=True)
-        prob_histo_minus, bin_edges = np.histogram(counts_minus, bins=1000, range=(1,1001),density=True)
+        output_plus = np.loadtxt("/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/" + directory_name + "/" + file_name + str(induction_times[i]) + "Plus", skiprows=1, usecols=count_columns, ndmin=2)
+        output_minus = np.loadtxt("/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/" + directory_name + "/" + file_name + str(induction_times[i]) + "Minus", skiprows=1, usecols=count_columns, ndmin=2)
         
-        residual_plus = prob_histo_plus - count_prob_list[i]
-        residual_minus = prob_histo_minus - count_prob_list[i]
+        rss_plus[i] = count_rss(output_plus, count_prob_list[i], weighted)
+        rss_minus[i] = count_rss(output_minus, count_prob_list[i], weighted)
         
-        rss_plus[i] = np.sum(np.square(residual_plus))
-        rss_minus[i] = np.sum(np.square(residual_minus))
+        batches_plus = seed_batches(output_plus[:,0], end_seeds[i])
+        batches_minus = seed_batches(output_minus[:,0], end_seeds[i])
+        for b in range(0,replicate_batches):
+            batch_rss_plus[b,i] = count_rss(output_plus[np.where(batches_plus==b)], count_prob_list[i], weighted)
+            batch_rss_minus[b,i] = count_rss(output_minus[np.where(batches_minus==b)], count_prob_list[i], weighted)
         
-        plotter(plot_list[i], counts_plus, counts_minus, count_prob_list[i],lineages_sampled_list[i], 0)
+        plot_data.append((output_plus[:,1], output_minus[:,1], count_prob_list[i],lineages_sampled_list[i], 0))
 
         
-    rates_plus = np.loadtxt("/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/" + directory_name + "/" + file_name + "RatePlus", skiprows=1, usecols=(0,3))
-    rates_minus = np.loadtxt("/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/" + directory_name + "/" + file_name + "RateMinus", skiprows=1, usecols=(0,3))
+    #event columns: time (hpf), seed, sampled mode, P(PP), P(PD), P(DD)
+    rates_plus = np.loadtxt("/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/" + directory_name + "/" + file_name + "RatePlus", skiprows=1, usecols=(0,1,3,4,5,6), ndmin=2)
+    rates_minus = np.loadtxt("/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/" + directory_name + "/" + file_name + "RateMinus", skiprows=1, usecols=(0,1,3,4,5,6), ndmin=2)
+    
+    rate_batches_plus = seed_batches(rates_plus[:,1], end_seeds[-1])
+    rate_batches_minus = seed_batches(rates_minus[:,1], end_seeds[-1])
+    batch_lineages = np.bincount(seed_batches(np.arange(start_seed, end_seeds[-1] + 1), end_seeds[-1]), minlength=replicate_batches)
     
     for i in range (0,3):
-        mode_rate_plus = np.array(rates_plus[np.where(rates_plus[:,1]==i)])
-        mode_rate_minus = np.array(rates_minus[np.where(rates_minus[:,1]==i)])
-
-        histo_rate_plus, bin_edges = np.histogram(mode_rate_plus[:,0], rate_bin_sequence, density=False)
-        histo_rate_minus, bin_edges = np.histogram(mode_rate_minus[:,0], rate_bin_sequence, density=False)
-        
-        #hourly per-lineage probabilities
-        prob_histo_rate_plus = np.array(histo_rate_plus / ((rate_end_seed + 1)*5))
-        prob_histo_rate_minus = np.array(histo_rate_plus / ((rate_end_seed + 1)*5))
-        
-        residual_plus = prob_histo_rate_plus - event_prob_list[i]
-        residual_minus = prob_histo_rate_minus - event_prob_list[i]
+        mode_rate_plus = np.array(rates_plus[np.where(rates_plus[:,2]==i)])
+        mode_rate_minus = np.array(rates_minus[np.where(rates_minus[:,2]==i)])
         
-        #PD RESIUDAL WEIGHTING
-        if i == 1:
-            rss_plus[i+3] = np.sum(1.5*np.square(residual_plus))
-            rss_minus[i+3] = np.sum(1.5*np.square(residual_minus))
+        rss_plus[i+3] = rate_rss(rates_plus, i, rate_lineages_simulated)
+        rss_minus[i+3] = rate_rss(rates_minus, i, rate_lineages_simulated)
         
-        else:
-            rss_plus[i+3] = np.sum(np.square(residual_plus))
-            rss_minus[i+3] = np.sum(np.square(residual_minus))
+        for b in range(0,replicate_batches):
+            batch_rss_plus[b,i+3] = rate_rss(rates_plus[np.where(rate_batches_plus==b)], i, batch_lineages[b])
+            batch_rss_minus[b,i+3] = rate_rss(rates_minus[np.where(rate_batches_minus==b)], i, batch_lineages[b])
         
-        plotter(plot_list[i+3], mode_rate_plus[:,0], mode_rate_minus[:,0], event_prob_list[i],lineages_sampled_events, 1)
+        plot_data.append((mode_rate_plus[:,0], mode_rate_minus[:,0], event_prob_list[i],lineages_sampled_events, 1))
 
     AIC_plus = 2 * number_params + number_comparisons * np.log(np.sum(rss_plus))
     AIC_minus = 2 * number_params + number_comparisons * np.log(np.sum(rss_minus))
     
-    plt.show()
-    plt.savefig("/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/" +directory_name +"/" + "SDmode" + str(deterministic_mode) + "iterate" + str(k) + ".png")
+    #batch AIC differences estimate the noise in the full evaluation's difference: var(full) ~ var(batch) / batches
+    batch_AIC_plus = 2 * number_params + number_comparisons * np.log(np.sum(batch_rss_plus, axis=1))
+    batch_AIC_minus = 2 * number_params + number_comparisons * np.log(np.sum(batch_rss_minus, axis=1))
+    gradient_standard_error = np.std(batch_AIC_plus - batch_AIC_minus, ddof=1) / np.sqrt(replicate_batches)
+    
+    #the AIC difference depends on every RSS term through the same log(sum) factor, so components are compared on
+    #their RSS differences; rate modes share one run & form one component
+    batch_differences = batch_rss_plus - batch_rss_minus
+    batch_differences = np.column_stack([batch_differences[:,0:len(induction_times)], np.sum(batch_differences[:,len(induction_times):], axis=1)])
     
     log.write("theta_plus:\n")
     if deterministic_mode == 0: log.write(str(k) + "\t" + str(theta_plus[0]) + "\t" + str(theta_plus[1]) + "\t" + str(theta_plus[2]) + "\t" + str(theta_plus[3]) + "\t" + str(theta_plus[4]) + "\n")
@@ -517,11 +746,25 @@ def evaluate_AIC_gradient(k, theta_plus, theta_minus, deterministic_mode, number
     if deterministic_mode == 0: log.write(str(k) + "\t" + str(theta_minus[0]) + "\t" + str(theta_minus[1]) + "\t" + str(theta_minus[2]) + "\t" + str(theta_minus[3]) + "\t" + str(theta_minus[4]) + "\n")
     if deterministic_mode == 1: log.write(str(k) + "\t" + str(theta_minus[0]) + "\t" + str(theta_minus[1]) + "\t" + str(theta_minus[2]) + "\t" + str(theta_minus[3]) + "\t" + str(theta_minus[4]) + "\t" + str(theta_minus[5]) + "\n")
 
-    log.write("PositiveAIC: " + str(AIC_plus) + " NegativeAIC: " + str(AIC_minus) + "\n")
+    log.write("PositiveAIC: " + str(AIC_plus) + " NegativeAIC: " + str(AIC_minus) + " StandardError: " + str(gradient_standard_error) + "\n")
 
     AIC_gradient_sample = AIC_plus - AIC_minus;
 
-    return AIC_gradient_sample
+    return AIC_gradient_sample, gradient_standard_error, batch_differences, plot_data
+
+#background plotting stage: redraws an iterate's subplots with their bootstrap intervals on a new figure & saves it
+def plot_iterate(plot_data, rate_lineages, figure_filename):
+    global fig, plt0, plt1, plt2, plt3, plt4, plt5, plot_list, rate_lineages_simulated
+    plt.switch_backend('Agg')
+    rate_lineages_simulated = rate_lineages
+    
+    fig, ((plt0, plt1, plt2),(plt3, plt4, plt5)) = plt.subplots(2,3,figsize=(12,6))
+    plot_list = [plt0,plt1,plt2,plt3,plt4,plt5]
+    for i in range(0, len(plot_data)):
+        plotter(plot_list[i], *plot_data[i])
+    
+    plt.savefig(figure_filename)
+    plt.close(fig)
 
 #data plotter function for monitoring SPSA results
 def plotter(subplot,plus,minus,empirical_prob,samples,mode):
@@ -543,8 +786,8 @@ def plotter(subplot,plus,minus,empirical_prob,samples,mode):
         trim_value = rate_trim_value
         histo_plus, bin_edges = np.histogram(plus, bin_sequence, density=False)
         histo_minus, bin_edges = np.histogram(minus, bin_sequence, density=False)
-        prob_histo_plus = np.array(histo_plus / ((rate_end_seed + 1)*5))
-        prob_histo_minus = np.array(histo_plus / ((rate_end_seed + 1)*5))
+        prob_histo_plus = np.array(histo_plus / (rate_lineages_simulated*5))
+        prob_histo_minus = np.array(histo_minus / (rate_lineages_simulated*5))
     
     trimmed_prob = empirical_prob[0:trim_value]
     
@@ -592,5 +835,11 @@ def sampler(data,samples,bin_sequence):
 def execute_command(cmd):
     return subprocess.call(cmd, shell=True)
 
+# As execute_command, returning the command's wall time (s)
+def timed_command(cmd):
+    command_start = time.time()
+    subprocess.call(cmd, shell=True)
+    return time.time() - command_start
+
 if __name__ == "__main__":
     main()
@@ -0,0 +1,289 @@
+import multiprocessing
+import os
+import shutil
+import subprocess
+import datetime
+
+import numpy as np
+from scipy.stats import qmc
+
+from fixture_loss import count_prob_list, count_rss, load_rates, rate_rss
+
+###########################################################################
+# SOBOL GLOBAL SENSITIVITY ANALYSIS
+# Variance-based sensitivity of HeSimulator's or WanSimulator's outputs to their model parameters, each varied
+# uniformly over a range. Saltelli's scheme: base matrices A & B are drawn from a scrambled Sobol sequence, and each
+# AB_i is A with column i taken from B, for N(d+2) parameter points. First order indices use Saltelli's (2010)
+# estimator & total indices Jansen's, with bootstrap 95% intervals.
+# Parameter points run in parallel, one per cpu; each point's simulator output is reduced to its summaries as soon
+# as it finishes & then deleted. Every point runs the same seeds (common random numbers), which keeps simulation
+# noise from dominating the differences between A & AB_i; what noise remains inflates the total indices.
+# Phase probabilities are parameterised as pPP and the PD share of the remaining divisions (pPD = share * (1 - pPP)),
+# so every point in the unit cube is valid; indices for the PD shares are reported under "PDshare".
+# He summaries: clone size mean & sd at each induction time, expected PP/PD/DD events per lineage, and the count &
+# rate residual sums of squares against the empirical histograms (as SPSA). HeSimulator's cycle duration parameters
+# are passed with -cycle. Wan summaries: mean CMZ population at the empirical retina ages, and the standardised
+# squared error against the empirical means (as MLMC).
+# A point the simulator fails on gets a row of NaNs in the summary table; the indices & their intervals are estimated
+# from the base sample rows whose A, B & every AB_i point succeeded.
+###########################################################################
+
+he_executable = '/home/main/chaste_build/projects/ISP/apps/HeSimulator'
+wan_executable = '/home/main/chaste_build/projects/ISP/apps/WanSimulator'
+output_root = '/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/'
+
+model = 0 #0=He 2012 counts & mode rates (HeSimulator);1=Wan 2016 CMZ population (WanSimulator)
+
+if model == 0: executable = he_executable
+if model == 1: executable = wan_executable
+
+if not(os.path.isfile(executable)):
+    raise Exception('Could not find executable: ' + executable)
+
+#####################
+# SOBOL SETTINGS
+#####################
+
+base_samples = 256 #N, a power of 2 (Sobol sequence balance)
+bootstrap_resamples = 1000
+sobol_seed = 786 #traceable RNG
+
+#########################
+# SIMULATION PARAMETERS
+#########################
+
+#common random numbers: every point runs these seeds
+start_seed = 0
+end_seed = 499
+rate_end_seed = 249
+wan_end_seed = 9
+directory_name = "Sobol"
+log_name = "SobolOutput"
+fixture = 0 #0=He 2012;1=Wan 2016
+ath5founder = 0
+
+earliest_lineage_start_time = 23.0
+latest_lineage_start_time = 39.0
+induction_times = [ 24, 32, 48 ]
+end_time = 72.0
+rate_end_time = 80
+
+####################################
+# PARAMETER RANGES (simulator order)
+####################################
+
+#HE: phase lengths, phase probabilities, cycle duration shifted gamma & sister shift width
+he_names = ["phase2", "phase3", "PP1", "PDshare1", "PP2", "PDshare2", "PP3", "PDshare3", "gammaShift", "gammaShape", "gammaScale", "sisterShift"]
+he_lower = np.array([4, 0, .5, 0, 0, 0, 0, 0, 2, 1, .5, .1])
+he_upper = np.array([12, 15, 1, 1, .5, 1, .5, 1, 6, 3, 1.5, 2])
+
+#WAN: CMZ residency, starting populations, stem & progenitor cycles, He progenitor model
+wan_names = ["residencyTime", "stemDivisor", "progenitorMean", "progenitorStd", "stemGammaShift", "stemGammaShape", "stemGammaScale",
+             "progenitorGammaShift", "progenitorGammaShape", "progenitorGammaScale", "progenitorSister",
+             "phase2", "phase3", "PP1", "PDshare1", "PP2", "PDshare2", "PP3", "PDshare3"]
+wan_lower = np.array([12, 5, 600, 100, 2, 4, 2, 2, 1, .5, .1, 4, 10, .5, 0, 0, 0, 0, 0])
+wan_upper = np.array([22, 20, 1000, 250, 6, 9, 6, 6, 3, 1.5, 2, 12, 20, 1, 1, .5, 1, .5, 1])
+
+if model == 0: names, lower, upper = he_names, he_lower, he_upper
+if model == 1: names, lower, upper = wan_names, wan_lower, wan_upper
+
+##############################
+# EMPIRICAL RESULTS
+##############################
+
+#He et al. count & mode rate histograms are imported from fixture_loss
+
+#Wan CMZ population means & SDs at retina ages (hpf); simulations start at 72hpf
+wan_empirical_times = np.array([72,120,192,288,408,552,720,1440,2160,4320,8640])
+wan_empirical_mean = np.array([792.0, 768.4, 906.1, 1159.7, 1630.0, 3157.9, 3480.2, 4105.1, 1003.0, 477.2, 438.8088611111])
+wan_empirical_sd = np.array([160.1, 200.1, 244.5, 477.6, 444.3, 1414.3, 472.1, 1169.7, 422.8, 367.5, 294.8])
+
+if model == 0:
+    output_names = [statistic + str(induction_time) for induction_time in induction_times for statistic in ["MeanCount", "SDCount"]]\
+                   + ["PPPerLineage", "PDPerLineage", "DDPerLineage", "CountRSS", "RateRSS"]
+if model == 1:
+    output_names = ["CMZ" + str(t) + "hpf" for t in wan_empirical_times] + ["PopulationSSE"]
+
+#setup the log file
+log_filename = output_root + directory_name + "/" + log_name
+os.makedirs(os.path.dirname(log_filename), exist_ok=True)
+
+log = open(log_filename,"w")
+
+def main():
+    dimension = len(names)
+
+    #Saltelli sample matrices from one 2d-dimensional scrambled Sobol sequence
+    sobol_sequence = qmc.Sobol(d=2 * dimension, scramble=True, seed=sobol_seed)
+    design = sobol_sequence.random_base2(m=int(np.log2(base_samples)))
+    A = lower + design[:,0:dimension] * (upper - lower)
+    B = lower + design[:,dimension:] * (upper - lower)
+    points = [A, B]
+    for i in range(0, dimension):
+        AB_i = A.copy()
+        AB_i[:,i] = B[:,i]
+        points.append(AB_i)
+    points = np.vstack(points)
+
+    log.write("Began Sobol sensitivity analysis of model " + str(model) + " @\n" + str(datetime.datetime.now()) + "\n")
+    log.write(str(dimension) + " parameters, N = " + str(base_samples) + ", " + str(points.shape[0]) + " parameter points\n")
+
+    # Use processes equal to the number of cpus available; one point per process
+    cpu_count = multiprocessing.cpu_count()
+    pool = multiprocessing.Pool(processes=cpu_count)
+
+    #points are reduced as they finish & written to the summary table in order
+    summary_file = open(output_root + directory_name + "/SobolSummaries", "w")
+    summary_file.write("Point\tMatrix\t" + "\t".join(names) + "\t" + "\t".join(output_names) + "\n")
+    outputs = np.zeros((points.shape[0], len(output_names)))
+    jobs = [(k, points[k]) for k in range(0, points.shape[0])]
+    for k, summaries in enumerate(pool.imap(simulate_point, jobs, 1)):
+        outputs[k] = summaries
+        summary_file.write(str(k) + "\t" + matrix_name(k) + "\t" + "\t".join([str(v) for v in points[k]]) + "\t" + "\t".join([str(v) for v in summaries]) + "\n")
+        summary_file.flush()
+    summary_file.close()
+
+    failed_points = np.sum(np.any(np.isnan(outputs), axis=1))
+    if failed_points > 0: log.write(str(failed_points) + " parameter points failed\n")
+
+    write_indices(outputs, dimension)
+
+    log.write("Finished @\n" + str(datetime.datetime.now()) + "\n")
+    log.close()
+    pool.close()
+
+def matrix_name(k):
+    block = k // base_samples
+    if block == 0: return "A"
+    if block == 1: return "B"
+    return "AB_" + names[block - 2]
+
+##############################
+# SOBOL INDICES
+##############################
+
+def sobol_indices(f_A, f_B, f_AB):
+#First order (Saltelli 2010) & total (Jansen) indices of each parameter, f_AB holding one column per AB_i
+    variance = np.var(np.concatenate([f_A, f_B]))
+    if variance == 0: return np.zeros(f_AB.shape[1]), np.zeros(f_AB.shape[1])
+    first_order = np.mean(f_B[:,None] * (f_AB - f_A[:,None]), axis=0) / variance
+    total = 0.5 * np.mean(np.square(f_A[:,None] - f_AB), axis=0) / variance
+    return first_order, total
+
+def write_indices(outputs, dimension):
+    N = base_samples
+
+    #base sample rows with no failed point among A, B & the AB_i
+    valid_rows = np.flatnonzero(np.all(~np.isnan(outputs).any(axis=1).reshape(dimension + 2, N), axis=0))
+    log.write(str(valid_rows.size) + " of " + str(N) + " base sample rows used for the indices\n")
+    if valid_rows.size == 0: return
+
+    p_RNG = np.random.RandomState(seed=sobol_seed)
+    resamples = [valid_rows[p_RNG.randint(0, valid_rows.size, valid_rows.size)] for b in range(0, bootstrap_resamples)]
+
+    indices_file = open(output_root + directory_name + "/SobolIndices", "w")
+    indices_file.write("Output\tParameter\tS1\tS1Lower95\tS1Upper95\tST\tSTLower95\tSTUpper95\n")
+    for o in range(0, len(output_names)):
+        f_A = outputs[0:N,o]
+        f_B = outputs[N:2*N,o]
+        f_AB = np.array([outputs[(2+i)*N:(3+i)*N,o] for i in range(0, dimension)]).T
+        first_order, total = sobol_indices(f_A[valid_rows], f_B[valid_rows], f_AB[valid_rows])
+
+        #bootstrap over valid base sample rows, shared by A, B & every AB_i
+        bootstrap = [sobol_indices(f_A[rows], f_B[rows], f_AB[rows]) for rows in resamples]
+        first_order_interval = np.percentile([b[0] for b in bootstrap], [2.5, 97.5], axis=0)
+        total_interval = np.percentile([b[1] for b in bootstrap], [2.5, 97.5], axis=0)
+
+        for i in range(0, dimension):
+            indices_file.write(output_names[o] + "\t" + names[i] + "\t" + str(first_order[i]) + "\t" + str(first_order_interval[0,i]) + "\t" + str(first_order_interval[1,i])\
+                               + "\t" + str(total[i]) + "\t" + str(total_interval[0,i]) + "\t" + str(total_interval[1,i]) + "\n")
+
+        #the log gets each output's most influential parameter
+        log.write(output_names[o] + ": largest total index " + names[np.argmax(total)] + " (" + str(np.max(total)) + ")\n")
+    indices_file.close()
+
+##############################
+# PARAMETER POINT SIMULATION
+##############################
+
+def probability_string(point):
+#PP, PD share pairs from the end of the point, as simulator pPP pPD arguments
+    probabilities = []
+    for phase in range(0, 3):
+        pPP = point[-6 + 2*phase]
+        probabilities += [pPP, point[-5 + 2*phase] * (1 - pPP)]
+    return " ".join([str(v) for v in probabilities])
+
+def simulate_point(job):
+#Run one point's simulations, reduce them to the summaries & delete them
+    k, point = job
+    file_name = "Point" + str(k)
+
+    #a point the simulator rejects or fails on gets a row of NaNs rather than stopping the analysis
+    failures = 0
+    if model == 0:
+        parameters = str(point[0]) + " " + str(point[1]) + " " + probability_string(point[0:8]) + " -cycle " + " ".join([str(v) for v in point[8:12]])
+        for induction_time in induction_times:
+            failures += execute_command(executable+" "+directory_name+" "+file_name+"Count"+str(induction_time)+" 0 0 "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                            +str(start_seed)+" "+str(end_seed)+" "+str(induction_time)+" "+str(earliest_lineage_start_time)+" "\
+                            +str(latest_lineage_start_time)+" "+str(end_time)+" "+parameters)
+        failures += execute_command(executable+" "+directory_name+" "+file_name+"Rate 1 0 "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                        +str(start_seed)+" "+str(rate_end_seed)+" "+str(earliest_lineage_start_time)+" "+str(earliest_lineage_start_time)+" "\
+                        +str(latest_lineage_start_time)+" "+str(rate_end_time)+" "+parameters)
+        if failures != 0:
+            remove_he_output(file_name)
+            return np.full(len(output_names), np.nan)
+        return he_summaries(file_name)
+
+    if model == 1:
+        parameters = " ".join([str(v) for v in point[0:13]]) + " " + probability_string(point[13:19])
+        failures += execute_command(executable+" "+directory_name+"/"+file_name+" "+str(start_seed)+" "+str(wan_end_seed)+" "+parameters)
+        if failures != 0:
+            shutil.rmtree(output_root + directory_name + "/" + file_name, ignore_errors=True)
+            return np.full(len(output_names), np.nan)
+        return wan_summaries(file_name)
+
+def remove_he_output(file_name):
+    for output_name in [file_name + "Count" + str(induction_time) for induction_time in induction_times] + [file_name + "Rate"]:
+        if os.path.isfile(output_root + directory_name + "/" + output_name): os.remove(output_root + directory_name + "/" + output_name)
+        shutil.rmtree(output_root + "UnusedSimOutput" + output_name, ignore_errors=True)
+
+def he_summaries(file_name):
+    summaries = []
+    total_count_rss = 0
+    for i in range(0, len(induction_times)):
+        output = output_root + directory_name + "/" + file_name + "Count" + str(induction_times[i])
+        counts = np.loadtxt(output, skiprows=1, usecols=3, ndmin=1)
+        summaries += [np.mean(counts), np.std(counts)]
+        total_count_rss += count_rss(counts, count_prob_list[i])
+        os.remove(output)
+        shutil.rmtree(output_root + "UnusedSimOutput" + file_name + "Count" + str(induction_times[i]), ignore_errors=True)
+
+    output = output_root + directory_name + "/" + file_name + "Rate"
+    rates = load_rates(output)
+    summaries += [np.sum(rates[:,2+i]) / (rate_end_seed + 1) for i in range(0, 3)]
+    total_rate_rss = np.sum(rate_rss(rates, rate_end_seed + 1))
+    os.remove(output)
+    shutil.rmtree(output_root + "UnusedSimOutput" + file_name + "Rate", ignore_errors=True)
+
+    return np.array(summaries + [total_count_rss, total_rate_rss])
+
+def wan_summaries(file_name):
+    #per seed: CMZ (transit) population at the empirical retina ages; simulations stop once no RPCs are left
+    sample_times = wan_empirical_times - wan_empirical_times[0]
+    populations = np.zeros((wan_end_seed - start_seed + 1, sample_times.size))
+    for s in range(0, populations.shape[0]):
+        results = np.loadtxt(output_root + directory_name + "/" + file_name + "/Seed" + str(start_seed + s) + "Results/results_from_time_0/celltypes.dat", usecols=(0,2), ndmin=2)
+        rows = np.searchsorted(results[:,0], sample_times + 1e-9, side='right') - 1
+        populations[s,:] = np.where(sample_times <= results[-1,0] + 1e-9, results[np.maximum(rows,0),1], 0)
+    shutil.rmtree(output_root + directory_name + "/" + file_name, ignore_errors=True)
+
+    mean_population = np.mean(populations, axis=0)
+    return np.append(mean_population, np.sum(np.square((mean_population - wan_empirical_mean) / wan_empirical_sd)))
+
+# This is a helper function for run_simulation that runs bash commands in separate processes
+def execute_command(cmd):
+    return subprocess.call(cmd, shell=True)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,245 @@
+import multiprocessing
+import os
+import shutil
+import subprocess
+import datetime
+
+import numpy as np
+from scipy.stats import qmc
+
+from fixture_loss import count_prob_list, count_rss, load_rates, rate_rss, aic, number_comparisons_per_induction, number_rate_comparisons
+
+###########################################################################
+# SPACE-FILLING PARAMETER SWEEP
+# Runs HeSimulator or WanSimulator over a Latin hypercube or scrambled Sobol design across the given parameter
+# ranges (a parameter is held fixed by giving it equal bounds), in place of He_output_fixture.py's &
+# Wan_output_fixture.py's hand-picked parameter sets. Phase probabilities are swept as pPP and the PD share of the
+# remaining divisions, so every design point is valid; the table records the simulated pPP & pPD.
+# Each design point's output is reduced to a row of summaries (clone size histogram moments & loss terms for He;
+# CMZ population moments & loss for Wan) in the single SweepSummaries table, and then deleted. Each worker process
+# reuses its own simulator file names, so the transient output never exceeds one point's files per cpu however many
+# points are swept.
+# Rows are appended as points finish (in any order, keyed by point number). The design is regenerated from its seed,
+# so rerunning the fixture with unchanged design settings resumes a sweep, skipping points already in the table.
+###########################################################################
+
+he_executable = '/home/main/chaste_build/projects/ISP/apps/HeSimulator'
+wan_executable = '/home/main/chaste_build/projects/ISP/apps/WanSimulator'
+output_root = '/home/main/git/chaste/projects/ISP/python_fixtures/testoutput/'
+
+model = 0 #0=He 2012 counts & mode rates (HeSimulator);1=Wan 2016 CMZ population (WanSimulator)
+
+if model == 0: executable = he_executable
+if model == 1: executable = wan_executable
+
+if not(os.path.isfile(executable)):
+    raise Exception('Could not find executable: ' + executable)
+
+#####################
+# SWEEP SETTINGS
+#####################
+
+design_points = 10000
+design_type = 0 #0=Latin hypercube;1=scrambled Sobol sequence
+design_seed = 786 #traceable RNG
+
+#########################
+# SIMULATION PARAMETERS
+#########################
+
+start_seed = 0
+end_seed = 499
+rate_end_seed = 249
+wan_end_seed = 9
+directory_name = "Sweep"
+log_name = "SweepOutput"
+table_name = "SweepSummaries"
+fixture = 0 #0=He 2012;1=Wan 2016
+ath5founder = 0
+
+earliest_lineage_start_time = 23.0
+latest_lineage_start_time = 39.0
+induction_times = [ 24, 32, 48 ]
+end_time = 72.0
+rate_end_time = 80
+
+####################################
+# PARAMETER RANGES (simulator order)
+####################################
+
+#HE: phase lengths, phase probabilities, cycle duration shifted gamma & sister shift width (HeSimulator -cycle)
+he_names = ["phase2", "phase3", "PP1", "PDshare1", "PP2", "PDshare2", "PP3", "PDshare3", "gammaShift", "gammaShape", "gammaScale", "sisterShift"]
+he_lower = np.array([4, 0, 1, 0, 0, 0, 0, 0, 4, 2, 1, 1])
+he_upper = np.array([12, 15, 1, 0, 1, 1, 1, 0, 4, 2, 1, 1])
+
+#WAN: CMZ residency, starting populations, stem & progenitor cycles, He progenitor model
+wan_names = ["residencyTime", "stemDivisor", "progenitorMean", "progenitorStd", "stemGammaShift", "stemGammaShape", "stemGammaScale",
+             "progenitorGammaShift", "progenitorGammaShape", "progenitorGammaScale", "progenitorSister",
+             "phase2", "phase3", "PP1", "PDshare1", "PP2", "PDshare2", "PP3", "PDshare3"]
+wan_lower = np.array([17, 10, 792, 160, 4, 4, 2, 4, 2, 1, 1, 8, 15, 1, 0, 0, 0, 0, 0])
+wan_upper = np.array([17, 10, 792, 160, 4, 9, 6, 4, 2, 1, 1, 8, 15, 1, 0, 1, 1, 1, 0])
+
+#entries holding the PP, PD share pairs of phases 1-3
+he_probabilities = slice(2, 8)
+wan_probabilities = slice(13, 19)
+
+if model == 0: names, lower, upper, probabilities = he_names, he_lower, he_upper, he_probabilities
+if model == 1: names, lower, upper, probabilities = wan_names, wan_lower, wan_upper, wan_probabilities
+simulator_names = list(names)
+simulator_names[probabilities] = ["pPP1", "pPD1", "pPP2", "pPD2", "pPP3", "pPD3"]
+
+##############################
+# EMPIRICAL RESULTS
+##############################
+
+#He et al. count & mode rate histograms are imported from fixture_loss
+he_model_params = 15
+
+#Wan CMZ population means & SDs at retina ages (hpf); simulations start at 72hpf
+wan_empirical_times = np.array([72,120,192,288,408,552,720,1440,2160,4320,8640])
+wan_empirical_mean = np.array([792.0, 768.4, 906.1, 1159.7, 1630.0, 3157.9, 3480.2, 4105.1, 1003.0, 477.2, 438.8088611111])
+wan_empirical_sd = np.array([160.1, 200.1, 244.5, 477.6, 444.3, 1414.3, 472.1, 1169.7, 422.8, 367.5, 294.8])
+
+if model == 0:
+    summary_names = [statistic + str(induction_time) for induction_time in induction_times for statistic in ["MeanCount", "VarCount", "SkewCount", "KurtCount", "CountRSS"]]\
+                    + [mode + statistic for statistic in ["PerLineage", "MeanTime", "RateRSS"] for mode in ["PP", "PD", "DD"]] + ["AIC"]
+if model == 1:
+    summary_names = [statistic + str(t) + "hpf" for t in wan_empirical_times for statistic in ["MeanCMZ", "SDCMZ"]] + ["PopulationSSE"]
+
+#setup the log file
+log_filename = output_root + directory_name + "/" + log_name
+table_filename = output_root + directory_name + "/" + table_name
+os.makedirs(os.path.dirname(log_filename), exist_ok=True)
+
+log = open(log_filename,"a")
+
+def main():
+    dimension = len(names)
+
+    if design_type == 0:
+        unit_design = qmc.LatinHypercube(d=dimension, seed=design_seed).random(design_points)
+    else:
+        unit_design = qmc.Sobol(d=dimension, scramble=True, seed=design_seed).random(design_points)
+    design = np.array([simulator_parameters(lower + point * (upper - lower)) for point in unit_design])
+
+    #resume: skip points already in the table
+    completed = set()
+    if os.path.isfile(table_filename):
+        completed = set(np.loadtxt(table_filename, skiprows=1, usecols=0, ndmin=1).astype(int))
+        table_file = open(table_filename, "a")
+    else:
+        table_file = open(table_filename, "w")
+        table_file.write("Point\t" + "\t".join(simulator_names) + "\t" + "\t".join(summary_names) + "\n")
+    jobs = [(k, design[k]) for k in range(0, design_points) if k not in completed]
+
+    log.write("Began " + ("Latin hypercube" if design_type == 0 else "Sobol") + " sweep of model " + str(model) + " @\n" + str(datetime.datetime.now()) + "\n")
+    log.write(str(design_points) + " design points, " + str(len(completed)) + " already in the table\n")
+    log.flush()
+
+    # Use processes equal to the number of cpus available; one point per process
+    cpu_count = multiprocessing.cpu_count()
+    pool = multiprocessing.Pool(processes=cpu_count)
+
+    for n, (k, summaries) in enumerate(pool.imap_unordered(simulate_point, jobs, 1)):
+        table_file.write(str(k) + "\t" + "\t".join([str(v) for v in design[k]]) + "\t" + "\t".join([str(v) for v in summaries]) + "\n")
+        table_file.flush()
+        if (n + 1) % 100 == 0: print(str(n + 1) + " of " + str(len(jobs)) + " points swept")
+
+    table_file.close()
+    pool.close()
+
+    log.write("Finished @\n" + str(datetime.datetime.now()) + "\n")
+    log.close()
+
+def simulator_parameters(point):
+#The point's PP, PD share pairs to simulator pPP, pPD arguments
+    parameters = point.copy()
+    shares = point[probabilities]
+    converted = shares.copy()
+    for phase in range(0, 3):
+        converted[1 + 2*phase] = shares[1 + 2*phase] * (1 - shares[2*phase])
+    parameters[probabilities] = converted
+    return parameters
+
+def simulate_point(job):
+#Run one point's simulations under the worker's file names & reduce them to summaries
+    k, point = job
+    file_name = "Worker" + str(os.getpid())
+
+    #a point the simulator rejects or fails on gets a row of NaNs rather than stopping the sweep
+    failures = 0
+    if model == 0:
+        parameters = " ".join([str(v) for v in point[0:8]]) + " -cycle " + " ".join([str(v) for v in point[8:12]])
+        for induction_time in induction_times:
+            failures += execute_command(executable+" "+directory_name+" "+file_name+"Count"+str(induction_time)+" 0 0 "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                            +str(start_seed)+" "+str(end_seed)+" "+str(induction_time)+" "+str(earliest_lineage_start_time)+" "\
+                            +str(latest_lineage_start_time)+" "+str(end_time)+" "+parameters)
+        failures += execute_command(executable+" "+directory_name+" "+file_name+"Rate 1 0 "+str(fixture)+" "+str(ath5founder)+" 0 "\
+                        +str(start_seed)+" "+str(rate_end_seed)+" "+str(earliest_lineage_start_time)+" "+str(earliest_lineage_start_time)+" "\
+                        +str(latest_lineage_start_time)+" "+str(rate_end_time)+" "+parameters)
+        if failures != 0:
+            remove_he_output(file_name)
+            return k, np.full(len(summary_names), np.nan)
+        return k, he_summaries(file_name)
+
+    if model == 1:
+        failures += execute_command(executable+" "+directory_name+"/"+file_name+" "+str(start_seed)+" "+str(wan_end_seed)+" "+" ".join([str(v) for v in point]))
+        if failures != 0:
+            shutil.rmtree(output_root + directory_name + "/" + file_name, ignore_errors=True)
+            return k, np.full(len(summary_names), np.nan)
+        return k, wan_summaries(file_name)
+
+def remove_he_output(file_name):
+    for output_name in [file_name + "Count" + str(induction_time) for induction_time in induction_times] + [file_name + "Rate"]:
+        if os.path.isfile(output_root + directory_name + "/" + output_name): os.remove(output_root + directory_name + "/" + output_name)
+        shutil.rmtree(output_root + "UnusedSimOutput" + output_name, ignore_errors=True)
+
+def moments(values):
+#Mean, variance, skewness & excess kurtosis
+    mean = np.mean(values)
+    variance = np.var(values)
+    if variance == 0: return [mean, 0, 0, 0]
+    standardised = (values - mean) / np.sqrt(variance)
+    return [mean, variance, np.mean(standardised**3), np.mean(standardised**4) - 3]
+
+def he_summaries(file_name):
+    summaries = []
+    rss = 0
+    for i in range(0, len(induction_times)):
+        output = output_root + directory_name + "/" + file_name + "Count" + str(induction_times[i])
+        counts = np.loadtxt(output, skiprows=1, usecols=3, ndmin=1)
+        induction_rss = count_rss(counts, count_prob_list[i])
+        summaries += moments(counts) + [induction_rss]
+        rss += induction_rss
+
+    output = output_root + directory_name + "/" + file_name + "Rate"
+    rates = load_rates(output)
+    per_lineage = [np.sum(rates[:,2+i]) / (rate_end_seed + 1) for i in range(0, 3)]
+    mean_time = [np.sum(rates[:,0] * rates[:,2+i]) / np.sum(rates[:,2+i]) if np.sum(rates[:,2+i]) > 0 else 0 for i in range(0, 3)]
+    mode_rss = list(rate_rss(rates, rate_end_seed + 1))
+    rss += np.sum(mode_rss)
+    remove_he_output(file_name)
+
+    number_comparisons = number_comparisons_per_induction * len(induction_times) + number_rate_comparisons
+    return np.array(summaries + per_lineage + mean_time + mode_rss + [aic(rss, he_model_params, number_comparisons)])
+
+def wan_summaries(file_name):
+    #per seed: CMZ (transit) population at the empirical retina ages; simulations stop once no RPCs are left
+    sample_times = wan_empirical_times - wan_empirical_times[0]
+    populations = np.zeros((wan_end_seed - start_seed + 1, sample_times.size))
+    for s in range(0, populations.shape[0]):
+        results = np.loadtxt(output_root + directory_name + "/" + file_name + "/Seed" + str(start_seed + s) + "Results/results_from_time_0/celltypes.dat", usecols=(0,2), ndmin=2)
+        rows = np.searchsorted(results[:,0], sample_times + 1e-9, side='right') - 1
+        populations[s,:] = np.where(sample_times <= results[-1,0] + 1e-9, results[np.maximum(rows,0),1], 0)
+    shutil.rmtree(output_root + directory_name + "/" + file_name, ignore_errors=True)
+
+    mean_population = np.mean(populations, axis=0)
+    summaries = np.column_stack([mean_population, np.std(populations, axis=0)]).flatten()
+    return np.append(summaries, np.sum(np.square((mean_population - wan_empirical_mean) / wan_empirical_sd)))
+
+# This is a helper function for run_simulation that runs bash commands in separate processes
+def execute_command(cmd):
+    return subprocess.call(cmd, shell=True)
+
+if __name__ == "__main__":
+    main()
@@ -20,7 +20,7 @@ if not(os.path.isfile(executable)):
 #No. simulated CMZs per run
 #unique sequence of RNG results for each lineage
 start_seed = 0
-end_seed = 99 #total seeds should be divisible by # cores
+end_seed = 99
 
 output_directory = "WanOutput"
 
@@ -65,40 +65,18 @@ stochastic_theta_string = str(mitotic_mode_phase_2) + " " + str(mitotic_mode_pha
 
 def main():
 
-    command_list = []
-
-    # Use processes equal to the number of cpus available
+    # Use MPI ranks equal to the number of cpus available; WanSimulator splits the seed range across ranks
     cpu_count = multiprocessing.cpu_count()
-    seeds_per_command = (end_seed + 1) / cpu_count
-    base_command = executable + " " + output_directory
-    
-    for i in range(0,cpu_count):
-        curr_start_seed = i * seeds_per_command
-        curr_end_seed = curr_start_seed + (seeds_per_command - 1)
-        
-        command = base_command + " "\
-            +str(curr_start_seed) + " "\
-            +str(curr_end_seed) + " "\
-            +cmz_theta_string + " "\
-            +stochastic_theta_string
-        
-        #command_list.append(command)
-        
-    command_list.append("/home/main/chaste_build/projects/ISP/apps/WanSimulator WanOutput 18.0 24.0 17.0 10 792 160 4 6.5 4 4 2 1 1 8 15 1.0 0.0 0.2 0.4 0.2 0.0")
-    command_list.append("/home/main/chaste_build/projects/ISP/apps/WanSimulator WanOutput 42.0 49.0 17.0 10 792 160 4 6.5 4 4 2 1 1 8 15 1.0 0.0 0.2 0.4 0.2 0.0")
-    command_list.append("/home/main/chaste_build/projects/ISP/apps/WanSimulator WanOutput 51.0 57.0 17.0 10 792 160 4 6.5 4 4 2 1 1 8 15 1.0 0.0 0.2 0.4 0.2 0.0")
-    command_list.append("/home/main/chaste_build/projects/ISP/apps/WanSimulator WanOutput 94.0 99.0 17.0 10 792 160 4 6.5 4 4 2 1 1 8 15 1.0 0.0 0.2 0.4 0.2 0.0")
-    command_list.append("/home/main/chaste_build/projects/ISP/apps/WanSimulator WanOutput 58.0 64.0 17.0 10 792 160 4 6.5 4 4 2 1 1 8 15 1.0 0.0 0.2 0.4 0.2 0.0")
-    command_list.append("/home/main/chaste_build/projects/ISP/apps/WanSimulator WanOutput 65.0 70.0 17.0 10 792 160 4 6.5 4 4 2 1 1 8 15 1.0 0.0 0.2 0.4 0.2 0.0")
-    command_list.append("/home/main/chaste_build/projects/ISP/apps/WanSimulator WanOutput 71.0 74.0 17.0 10 792 160 4 6.5 4 4 2 1 1 8 15 1.0 0.0 0.2 0.4 0.2 0.0")
-
-    print("Starting simulations with " + str(cpu_count) + " processes")
-   
-    # Generate a pool of workers
-    pool = multiprocessing.Pool(processes=cpu_count)
-
-    # Pass the list of bash commands to the pool, block until pool is complete
-    pool.map(execute_command, command_list, 1)
+
+    command = "mpirun -np " + str(cpu_count) + " " + executable + " " + output_directory + " "\
+        +str(start_seed) + " "\
+        +str(end_seed) + " "\
+        +cmz_theta_string + " "\
+        +stochastic_theta_string
+
+    print("Starting simulations with " + str(cpu_count) + " MPI ranks")
+
+    execute_command(command)
 
 
 # This is a helper function for run_simulation that runs bash commands in separate processes
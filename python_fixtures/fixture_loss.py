@@ -0,0 +1,66 @@
+import numpy as np
+
+###########################################################################
+# FIXTURE LOSS
+# He et al. 2012 empirical histograms & the SPSA fixture's residual sum of squares loss, shared by the fitting,
+# inference & sensitivity fixtures (import from the fixture, eg. from fixture_loss import count_rss).
+# count_prob_list: per induction time (24, 32, 48 hpf), clone size probabilities of counts 1-1000
+# event_prob_list: per mode (PP, PD, DD), hourly per-lineage division probabilities in 5 h bins from 30 hpf
+# AIC = 2 * parameters + comparisons * log(RSS); PD rate residuals are weighted 1.5, as SPSA.
+###########################################################################
+
+empirical_counts_file = '/home/main/git/chaste/projects/ISP/empirical_data/empirical_counts.csv'
+empirical_lineages_file = '/home/main/git/chaste/projects/ISP/empirical_data/empirical_lineages.csv'
+
+number_comparisons_per_induction = 1000 #count histogram bins, counts 1-1000
+number_rate_comparisons = 30 #10 rate bins per mode
+rate_bin_sequence = np.arange(30,85,5)
+lineages_sampled_events = 60
+
+##############################
+# HE ET AL EMPIRICAL RESULTS
+##############################
+
+raw_counts = np.loadtxt(empirical_counts_file, skiprows=1, usecols=(3,4,5,6,7,8,9,10)) #collect the per-cell-type counts
+raw_counts_list = [raw_counts[0:64,:], raw_counts[64:233,:], raw_counts[233:396,:]]
+
+count_prob_list = []
+for raw_induction_counts in raw_counts_list:
+    prob_induction,bin_edges = np.histogram(np.sum(raw_induction_counts,axis=1),np.arange(1,32,1),density=True)
+    #extend histogram to 1000 - allows large simulated lineages to be included in the comparison
+    count_prob_list.append(np.concatenate([prob_induction, np.zeros(number_comparisons_per_induction - prob_induction.size)]))
+
+raw_events = np.loadtxt(empirical_lineages_file, skiprows=1, usecols=(3,5,8))
+observed_events = raw_events[np.where(raw_events[:,2]==1)] #exclude any mitosis whose time was too early for recording
+
+#hourly per-lineage probabilities- NOT probability density function
+event_prob_list = []
+for i in range(0,3):
+    histo_mode,bin_edges = np.histogram(observed_events[np.where(observed_events[:,0]==i)][:,1],rate_bin_sequence,density=False)
+    event_prob_list.append(np.array((histo_mode/lineages_sampled_events)/5))
+
+##############################
+# RESIDUALS & AIC
+##############################
+
+def count_rss(counts, empirical_prob):
+#RSS of a simulated count sample's probability histogram against an entry of count_prob_list
+    prob_histo, bin_edges = np.histogram(counts, bins=1000, range=(1,1001), density=True)
+    return np.sum(np.square(prob_histo - empirical_prob))
+
+def load_rates(output):
+#event columns: time (hpf), sampled mode, P(PP), P(PD), P(DD); each division contributes its mode probabilities
+    return np.loadtxt(output, skiprows=1, usecols=(0,3,4,5,6), ndmin=2)
+
+def rate_rss(rates, lineages):
+#Per mode RSS of load_rates() rows from this many simulated lineages against event_prob_list
+    rss = np.zeros(3)
+    for i in range(0, 3):
+        histo_rate, bin_edges = np.histogram(rates[:,0], rate_bin_sequence, weights=rates[:,2+i], density=False)
+        residual = np.array(histo_rate / (lineages*5)) - event_prob_list[i]
+        #PD residual weighting, as SPSA
+        rss[i] = np.sum((1.5 if i == 1 else 1) * np.square(residual))
+    return rss
+
+def aic(rss, number_params, number_comparisons):
+    return 2 * number_params + number_comparisons * np.log(rss)
@@ -4,7 +4,7 @@ BoijeCellCycleModel::BoijeCellCycleModel() :
         AbstractSimpleCellCycleModel(), mOutput(false), mEventStartTime(), mSequenceSampler(false), mSeqSamplerLabelSister(
                 false), mDebug(false), mTimeID(), mVarIDs(), mDebugWriter(), mGeneration(0), mPhase2gen(3), mPhase3gen(
                 5), mprobAtoh7(0.32), mprobPtf1a(0.30), mprobng(0.80), mAtoh7Signal(false), mPtf1aSignal(false), mNgSignal(
-                false), mMitoticMode(0), mSeed(0), mp_PostMitoticType(), mp_RGC_Type(), mp_AC_HC_Type(), mp_PR_BC_Type(), mp_label_Type()
+                false), mMitoticMode(0), mSeed(0), mp_PostMitoticType(), mp_RGC_Type(), mp_AC_HC_Type(), mp_PR_BC_Type(), mp_label_Type(), mPropertyFlags(0)
 {
 }
 
@@ -17,7 +17,7 @@ BoijeCellCycleModel::BoijeCellCycleModel(const BoijeCellCycleModel& rModel) :
                 rModel.mAtoh7Signal), mPtf1aSignal(rModel.mPtf1aSignal), mNgSignal(rModel.mNgSignal), mMitoticMode(
                 rModel.mMitoticMode), mSeed(rModel.mSeed), mp_PostMitoticType(rModel.mp_PostMitoticType), mp_RGC_Type(
                 rModel.mp_RGC_Type), mp_AC_HC_Type(rModel.mp_AC_HC_Type), mp_PR_BC_Type(rModel.mp_PR_BC_Type), mp_label_Type(
-                rModel.mp_label_Type)
+                rModel.mp_label_Type), mPropertyFlags(rModel.mPropertyFlags)
 {
 }
 
@@ -29,7 +29,7 @@ AbstractCellCycleModel* BoijeCellCycleModel::CreateCellCycleModel()
 void BoijeCellCycleModel::SetCellCycleDuration()
 {
 
-    if (mpCell->GetCellProliferativeType()->IsType<DifferentiatedCellProliferativeType>())
+    if (mPropertyFlags & CellPropertyFlags::POSTMITOTIC)
     {
         mCellCycleDuration = DBL_MAX;
     }
@@ -108,6 +108,7 @@ void BoijeCellCycleModel::ResetForDivision()
         mMitoticMode = 2;
         mpCell->SetCellProliferativeType(mp_PostMitoticType);
         mpCell->AddCellProperty(mp_AC_HC_Type);
+        mPropertyFlags |= CellPropertyFlags::POSTMITOTIC | CellPropertyFlags::AC_HC_FATE;
     }
 
     if (mPtf1aSignal == false && mAtoh7Signal == false && mNgSignal == true) //ng alone gives a symmetrical postmitotic PR/BC division
@@ -115,6 +116,7 @@ void BoijeCellCycleModel::ResetForDivision()
         mMitoticMode = 2;
         mpCell->SetCellProliferativeType(mp_PostMitoticType);
         mpCell->AddCellProperty(mp_PR_BC_Type);
+        mPropertyFlags |= CellPropertyFlags::POSTMITOTIC | CellPropertyFlags::PR_BC_FATE;
     }
 
     /****************
@@ -142,14 +144,15 @@ void BoijeCellCycleModel::ResetForDivision()
     //50% chance of each daughter cell from a mitosis inheriting the label
     if (mSequenceSampler)
     {
-        if (mpCell->HasCellProperty<CellLabel>())
+        if (mPropertyFlags & CellPropertyFlags::LABEL)
         {
-            (*LogFile::Instance()) << mMitoticMode;
+            (*EventOutputBuffer::Instance()) << mMitoticMode;
             double labelRV = p_random_number_generator->ranf();
             if (labelRV <= .5)
             {
                 mSeqSamplerLabelSister = true;
                 mpCell->RemoveCellProperty<CellLabel>();
+                mPropertyFlags &= ~CellPropertyFlags::LABEL;
             }
             else
             {
@@ -164,6 +167,14 @@ void BoijeCellCycleModel::ResetForDivision()
     }
 }
 
+void BoijeCellCycleModel::Initialise()
+{
+    //the only property collection scan this model makes; kept current by the model from here on
+    mPropertyFlags = CellPropertyFlags::ReadCellPropertyFlags(mpCell);
+
+    AbstractSimpleCellCycleModel::Initialise();
+}
+
 void BoijeCellCycleModel::InitialiseDaughterCell()
 {
     //Asymmetric specification rules
@@ -174,11 +185,13 @@ void BoijeCellCycleModel::InitialiseDaughterCell()
         {
             mpCell->SetCellProliferativeType(mp_PostMitoticType);
             mpCell->AddCellProperty(mp_AC_HC_Type);
+            mPropertyFlags |= CellPropertyFlags::POSTMITOTIC | CellPropertyFlags::AC_HC_FATE;
         }
         else
         {
             mpCell->SetCellProliferativeType(mp_PostMitoticType);
             mpCell->AddCellProperty(mp_RGC_Type);
+            mPropertyFlags |= CellPropertyFlags::POSTMITOTIC | CellPropertyFlags::RGC_FATE;
         }
     }
 
@@ -190,11 +203,13 @@ void BoijeCellCycleModel::InitialiseDaughterCell()
         if (mSeqSamplerLabelSister)
         {
             mpCell->AddCellProperty(mp_label_Type);
+            mPropertyFlags |= CellPropertyFlags::LABEL;
             mSeqSamplerLabelSister = false;
         }
-        else
+        else if (mPropertyFlags & CellPropertyFlags::LABEL)
         {
             mpCell->RemoveCellProperty<CellLabel>();
+            mPropertyFlags &= ~CellPropertyFlags::LABEL;
         }
     }
 }
@@ -245,7 +260,21 @@ void BoijeCellCycleModel::WriteModeEventOutput()
     double currentTime = SimulationTime::Instance()->GetTime() + mEventStartTime;
     CellPtr currentCell = GetCell();
     double currentCellID = (double) currentCell->GetCellId();
-    (*LogFile::Instance()) << currentTime << "\t" << mSeed << "\t" << currentCellID << "\t" << mMitoticMode << "\n";
+
+    //mode probabilities at this generation: Atoh7 gives PD; otherwise Ptf1a or ng give DD
+    double pPP = 1.0, pPD = 0.0;
+    if (mGeneration > mPhase2gen && mGeneration <= mPhase3gen)
+    {
+        pPD = mprobAtoh7;
+        pPP = (1.0 - mprobAtoh7) * (1.0 - mprobPtf1a) * (1.0 - mprobng);
+    }
+    if (mGeneration > mPhase3gen)
+    {
+        pPP = 1.0 - mprobng;
+    }
+
+    (*EventOutputBuffer::Instance()) << currentTime << "\t" << mSeed << "\t" << currentCellID << "\t" << mMitoticMode << "\t"
+            << pPP << "\t" << pPD << "\t" << 1.0 - pPP - pPD << "\n";
 }
 
 void BoijeCellCycleModel::EnableSequenceSampler(boost::shared_ptr<AbstractCellProperty> label)
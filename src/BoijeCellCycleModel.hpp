@@ -8,7 +8,9 @@
 #include "SmartPointers.hpp"
 #include "ColumnDataWriter.hpp"
 #include "LogFile.hpp"
+#include "EventOutputBuffer.hpp"
 #include "CellLabel.hpp"
+#include "CellPropertyFlags.hpp"
 
 #include "BoijeRetinalNeuralFates.hpp"
 
@@ -26,13 +28,14 @@
 * to clocktime!!
  *
  * 2 per-model-event output modes:
- * EnableModeEventOutput() enables mitotic mode event logging-all cells will write to the singleton log file
+ * EnableModeEventOutput() enables mitotic mode event logging-all cells will write to the worker's EventOutputBuffer,
+ * merged into the singleton log file by the simulator
  * EnableModelDebugOutput() enables more detailed debug output, each seed will have its own file written to
  * by a ColumnDataWriter passed to it from the test
  * (eg. by the SetupDebugOutput helper function in the project simulator)
  *
  * 1 mitotic-event-sequence sampler (only samples one "path" through the lineage):
- * EnableSequenceSampler() - one "sequence" of progenitors writes mitotic event type to a string in the singleton log file
+ * EnableSequenceSampler() - one "sequence" of progenitors writes mitotic event type to a string in the EventOutputBuffer
  *
  *********************************/
 
@@ -93,6 +96,8 @@ protected:
     boost::shared_ptr<AbstractCellProperty> mp_AC_HC_Type;
     boost::shared_ptr<AbstractCellProperty> mp_PR_BC_Type;
     boost::shared_ptr<AbstractCellProperty> mp_label_Type;
+    //cached cell property flags (see CellPropertyFlags.hpp)
+    unsigned mPropertyFlags;
 
     /**
      * Protected copy-constructor for use by CreateCellCycleModel().
@@ -135,6 +140,12 @@ public:
      * Contains general mitotic mode logic
      **/
     void ResetForDivision();
+
+    /**
+     * Overridden Initialise() method.
+     * Reads the cell's property flags, then sets the cell cycle duration as usual
+     **/
+    void Initialise();
     
     /**
      * Overridden InitialiseDaughterCell() method.
@@ -168,7 +179,7 @@ public:
     void SetSpecifiedTypes(boost::shared_ptr<AbstractCellProperty> p_RGC_Type, boost::shared_ptr<AbstractCellProperty> p_AC_HC_Type, boost::shared_ptr<AbstractCellProperty> p_PR_BC_Type);
     
     //Functions to enable per-cell mitotic mode logging for mode rate & sequence sampling fixtures
-    //Uses singleton logfile
+    //Uses the worker's EventOutputBuffer (see EventOutputBuffer.hpp)
     void EnableModeEventOutput(double eventStart, unsigned seed);
     void EnableSequenceSampler(boost::shared_ptr<AbstractCellProperty> label);
 
@@ -0,0 +1,144 @@
+#include "BoijeGenerationSolver.hpp"
+
+#include <cmath>
+
+#include "DiscreteFourierTransform.hpp"
+
+BoijeGenerationSolver::BoijeGenerationSolver(unsigned maxCount) :
+        mTransformLength(1), mPhase2gen(), mPhase3gen(), mprobAtoh7(), mprobPtf1a(), mprobng()
+{
+    while (mTransformLength < maxCount + 1)
+    {
+        mTransformLength <<= 1;
+    }
+    SetModelParameters();
+}
+
+void BoijeGenerationSolver::SetModelParameters(unsigned phase2gen, unsigned phase3gen, double probAtoh7,
+                                               double probPtf1a, double probng)
+{
+    mPhase2gen = phase2gen;
+    mPhase3gen = phase3gen;
+    mprobAtoh7 = probAtoh7;
+    mprobPtf1a = probPtf1a;
+    mprobng = probng;
+}
+
+BoijeGenerationSolver::DivisionProbabilities BoijeGenerationSolver::GetDivisionProbabilities(unsigned generation) const
+{
+    DivisionProbabilities probabilities = { 1.0, 0.0, 0.0, 0.0, 0.0 };
+
+    if (generation > mPhase2gen && generation <= mPhase3gen)
+    {
+        //Atoh7 gives PD (Ptf1a specifies the daughter AC/HC, otherwise RGC); Ptf1a alone DD AC/HC; ng alone DD PR/BC
+        probabilities.mPD_RGC = mprobAtoh7 * (1.0 - mprobPtf1a);
+        probabilities.mPD_AC_HC = mprobAtoh7 * mprobPtf1a;
+        probabilities.mDD_AC_HC = (1.0 - mprobAtoh7) * mprobPtf1a;
+        probabilities.mDD_PR_BC = (1.0 - mprobAtoh7) * (1.0 - mprobPtf1a) * mprobng;
+    }
+    if (generation > mPhase3gen)
+    {
+        probabilities.mDD_PR_BC = mprobng;
+    }
+
+    probabilities.mPP = 1.0 - probabilities.mPD_RGC - probabilities.mPD_AC_HC - probabilities.mDD_AC_HC
+            - probabilities.mDD_PR_BC;
+    return probabilities;
+}
+
+std::vector<double> BoijeGenerationSolver::GetCountDistribution(CountType countType, unsigned endGeneration) const
+{
+    //evaluate at roots of unity z_j = exp(2 pi i j / N) & the aliasing check point; F(conj z) = conj F(z)
+    std::vector<std::complex<double> > points = GetPGFPoints(mTransformLength);
+    std::vector<std::complex<double> > pgf(points.size());
+
+    for (unsigned j = 0; j < points.size(); j++)
+    {
+        const std::complex<double>& z = points[j];
+        std::complex<double> proliferative = (countType == CLONE_SIZE) ? z : 1.0;
+        std::complex<double> rgc = (countType == CLONE_SIZE || countType == RGC_COUNT) ? z : 1.0;
+        std::complex<double> acHC = (countType == CLONE_SIZE || countType == AC_HC_COUNT) ? z : 1.0;
+        std::complex<double> prBC = (countType == CLONE_SIZE || countType == PR_BC_COUNT) ? z : 1.0;
+
+        //cells still proliferative after the end generation count as themselves
+        std::complex<double> clone = proliferative;
+        for (unsigned generation = endGeneration; generation >= 1; generation--)
+        {
+            DivisionProbabilities p = GetDivisionProbabilities(generation);
+            clone = p.mPP * clone * clone + (p.mPD_RGC * rgc + p.mPD_AC_HC * acHC) * clone
+                    + p.mDD_AC_HC * acHC * acHC + p.mDD_PR_BC * prBC * prBC;
+        }
+        pgf[j] = clone;
+    }
+
+    return InvertPGF(pgf, mTransformLength);
+}
+
+std::vector<std::vector<double> > BoijeGenerationSolver::GetExpectedModeEvents(unsigned endGeneration) const
+{
+    std::vector<std::vector<double> > events(endGeneration + 1, std::vector<double>(3, 0.0));
+
+    //expected proliferative cells dividing at each generation
+    double proliferative = 1.0;
+    for (unsigned generation = 1; generation <= endGeneration; generation++)
+    {
+        DivisionProbabilities p = GetDivisionProbabilities(generation);
+        double pPD = p.mPD_RGC + p.mPD_AC_HC;
+        events[generation][0] = proliferative * p.mPP;
+        events[generation][1] = proliferative * pPD;
+        events[generation][2] = proliferative * (p.mDD_AC_HC + p.mDD_PR_BC);
+        proliferative *= 2.0 * p.mPP + pPD;
+    }
+
+    return events;
+}
+
+void BoijeGenerationSolver::ExtendSequence(unsigned generation, unsigned endGeneration, const std::string& sequence,
+                                           double probability, double minProbability,
+                                           std::map<std::string, double>& rSequences) const
+{
+    if (generation > endGeneration)
+    {
+        rSequences[sequence] += probability;
+        return;
+    }
+
+    DivisionProbabilities p = GetDivisionProbabilities(generation);
+    double pPD = p.mPD_RGC + p.mPD_AC_HC;
+    double pDD = p.mDD_AC_HC + p.mDD_PR_BC;
+
+    //PP: the label stays on a proliferative cell
+    if (p.mPP * probability >= minProbability)
+    {
+        ExtendSequence(generation + 1, endGeneration, sequence + "0", p.mPP * probability, minProbability,
+                       rSequences);
+    }
+    //PD: the label passes to the postmitotic daughter half of the time
+    if (pPD * probability >= minProbability)
+    {
+        rSequences[sequence + "1"] += 0.5 * pPD * probability;
+        if (0.5 * pPD * probability >= minProbability)
+        {
+            ExtendSequence(generation + 1, endGeneration, sequence + "1", 0.5 * pPD * probability, minProbability,
+                           rSequences);
+        }
+    }
+    //DD: the labelled path ends
+    if (pDD * probability >= minProbability)
+    {
+        rSequences[sequence + "2"] += pDD * probability;
+    }
+}
+
+std::map<std::string, double> BoijeGenerationSolver::GetSequenceDistribution(unsigned endGeneration,
+                                                                             double minProbability) const
+{
+    std::map<std::string, double> sequences;
+    ExtendSequence(1, endGeneration, "", 1.0, minProbability, sequences);
+    return sequences;
+}
+
+unsigned BoijeGenerationSolver::GetCountRange() const
+{
+    return mTransformLength;
+}
@@ -0,0 +1,121 @@
+#ifndef BOIJEGENERATIONSOLVER_HPP_
+#define BOIJEGENERATIONSOLVER_HPP_
+
+#include <complex>
+#include <map>
+#include <string>
+#include <vector>
+
+/***********************************
+ * BOIJE GENERATION SOLVER
+ * Exact per-generation clone-size, fate composition, mitotic mode and sequence sampler distributions for the
+ * BoijeCellCycleModel lineage, without Monte Carlo.
+ *
+ * USE: Construct with the largest count to resolve, set the same parameters as BoijeCellCycleModel::SetModelParameters(),
+ * then request distributions for an end generation (BoijeSimulator's endGeneration).
+ *
+ * Boije cells divide synchronously once per generation and each division's outcome depends only on its generation
+ * and independent Atoh7/Ptf1a/ng draws. Per proliferative cell at generation g:
+ * PP: 1 - (PD_RGC + PD_AC/HC + DD_AC/HC + DD_PR/BC)
+ * PD, RGC daughter: pAtoh7 (1 - pPtf1a)       PD, AC/HC daughter: pAtoh7 pPtf1a
+ * DD, AC/HC: (1 - pAtoh7) pPtf1a             DD, PR/BC: (1 - pAtoh7)(1 - pPtf1a) png
+ * in phase 2; phase 1 is all PP, and phase 3 is DD PR/BC with probability png, otherwise PP.
+ * The clone PGF then follows the generation recursion
+ *
+ * F_g(s) = pPP F_(g+1)^2 + (pPD_RGC s_RGC + pPD_AC/HC s_AC/HC) F_(g+1) + pDD_AC/HC s_AC/HC^2 + pDD_PR/BC s_PR/BC^2
+ *
+ * with F_(end + 1) = s_P for cells still proliferative at the end. F is evaluated at the roots of unity and inverted by
+ * FFT, throwing if more than 1e-6 of the probability lies beyond the count range. Sequence sampler paths are
+ * enumerated by a recursion over the labelled cell, truncated below a probability.
+ ************************************/
+
+class BoijeGenerationSolver
+{
+public:
+    /** Counted quantities; CLONE_SIZE counts all cells, the fates count postmitotic cells of each fate */
+    enum CountType
+    {
+        CLONE_SIZE = 0,
+        RGC_COUNT,
+        AC_HC_COUNT,
+        PR_BC_COUNT
+    };
+
+private:
+    unsigned mTransformLength;
+    //model parameters
+    unsigned mPhase2gen;
+    unsigned mPhase3gen;
+    double mprobAtoh7;
+    double mprobPtf1a;
+    double mprobng;
+
+    /** Division outcome probabilities at one generation */
+    struct DivisionProbabilities
+    {
+        double mPP;
+        double mPD_RGC;
+        double mPD_AC_HC;
+        double mDD_AC_HC;
+        double mDD_PR_BC;
+    };
+
+    /**
+     * @param generation the dividing cell's generation (the first division is generation 1)
+     * @return the division outcome probabilities, as BoijeCellCycleModel::ResetForDivision()
+     */
+    DivisionProbabilities GetDivisionProbabilities(unsigned generation) const;
+
+    /**
+     * Extend the sequence sampler recursion from a labelled proliferative cell.
+     *
+     * @param generation the labelled cell's next division
+     * @param endGeneration last generation simulated
+     * @param sequence the modes written so far
+     * @param probability the probability of the path so far
+     * @param minProbability paths less likely than this are dropped
+     * @param rSequences sequence probabilities, added to
+     */
+    void ExtendSequence(unsigned generation, unsigned endGeneration, const std::string& sequence, double probability,
+                        double minProbability, std::map<std::string, double>& rSequences) const;
+
+public:
+
+    /**
+     * Constructor, with BoijeCellCycleModel's default parameters.
+     *
+     * @param maxCount largest count resolved; the count range is rounded up to a power of 2
+     */
+    BoijeGenerationSolver(unsigned maxCount = 255);
+
+    /**
+     * Model parameters, as BoijeCellCycleModel::SetModelParameters()
+     */
+    void SetModelParameters(unsigned phase2gen = 3, unsigned phase3gen = 5, double probAtoh7 = 0.32,
+                            double probPtf1a = 0.3, double probng = 0.8);
+
+    /**
+     * @param countType the counted quantity
+     * @param endGeneration last generation simulated (divisions at the end generation are counted)
+     * @return P(count = m) for m = 0 ... count range - 1; throws if the range misses more than 1e-6 of the mass
+     */
+    std::vector<double> GetCountDistribution(CountType countType, unsigned endGeneration) const;
+
+    /**
+     * @param endGeneration last generation simulated
+     * @return expected PP, PD, DD divisions per lineage at generations 1 ... endGeneration (index 0 unused)
+     */
+    std::vector<std::vector<double> > GetExpectedModeEvents(unsigned endGeneration) const;
+
+    /**
+     * @param endGeneration last generation simulated
+     * @param minProbability sequences less likely than this are dropped
+     * @return probabilities of the sequences written by BoijeCellCycleModel's sequence sampler
+     */
+    std::map<std::string, double> GetSequenceDistribution(unsigned endGeneration, double minProbability = 1e-12) const;
+
+    /** @return the number of counts resolved by GetCountDistribution() */
+    unsigned GetCountRange() const;
+};
+
+#endif /* BOIJEGENERATIONSOLVER_HPP_ */
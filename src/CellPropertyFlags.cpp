@@ -0,0 +1,26 @@
+#include "CellPropertyFlags.hpp"
+#include "CellLabel.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "HeAth5Mo.hpp"
+#include "GomesRetinalNeuralFates.hpp"
+#include "BoijeRetinalNeuralFates.hpp"
+
+unsigned CellPropertyFlags::ReadCellPropertyFlags(CellPtr pCell)
+{
+    unsigned flags = 0;
+
+    if (pCell->HasCellProperty<CellLabel>()) flags |= LABEL;
+    if (pCell->HasCellProperty<Ath5Mo>()) flags |= ATH5MO;
+    if (pCell->HasCellProperty<DifferentiatedCellProliferativeType>()) flags |= POSTMITOTIC;
+
+    if (pCell->HasCellProperty<RodPhotoreceptor>()) flags |= RPH_FATE;
+    if (pCell->HasCellProperty<AmacrineCell>()) flags |= AC_FATE;
+    if (pCell->HasCellProperty<BipolarCell>()) flags |= BC_FATE;
+    if (pCell->HasCellProperty<MullerGlia>()) flags |= MG_FATE;
+
+    if (pCell->HasCellProperty<RetinalGanglion>()) flags |= RGC_FATE;
+    if (pCell->HasCellProperty<AmacrineHorizontal>()) flags |= AC_HC_FATE;
+    if (pCell->HasCellProperty<ReceptorBipolar>()) flags |= PR_BC_FATE;
+
+    return flags;
+}
@@ -0,0 +1,43 @@
+#ifndef CELLPROPERTYFLAGS_HPP_
+#define CELLPROPERTYFLAGS_HPP_
+
+#include "Cell.hpp"
+
+/*******************************
+ * CELL PROPERTY FLAGS
+ * Compact per-cell cache of the cell properties consulted by the retinal cell cycle models at division.
+ *
+ * USE: A model reads its cell's flags once with ReadCellPropertyFlags() when it is initialised, then updates them
+ * alongside every property it adds to or removes from the cell. Daughter models inherit the parent's flags through
+ * their copy-constructor, which mirrors the CellPropertyCollection copy Cell::Divide() gives the daughter cell.
+ * Division-time property logic is then a bit test rather than a dynamic-cast scan of the property collection.
+ *
+ * NB: properties added to or removed from a cell by anything other than its cell cycle model after initialisation
+ * are not seen by the cache!
+ *******************************/
+
+namespace CellPropertyFlags
+{
+    const unsigned LABEL = 1u << 0; //CellLabel (sequence sampler)
+    const unsigned ATH5MO = 1u << 1; //Ath5Mo (ath5 morphant)
+    const unsigned POSTMITOTIC = 1u << 2; //DifferentiatedCellProliferativeType
+    //Gomes model fates
+    const unsigned RPH_FATE = 1u << 3;
+    const unsigned AC_FATE = 1u << 4;
+    const unsigned BC_FATE = 1u << 5;
+    const unsigned MG_FATE = 1u << 6;
+    //Boije model fates
+    const unsigned RGC_FATE = 1u << 7;
+    const unsigned AC_HC_FATE = 1u << 8;
+    const unsigned PR_BC_FATE = 1u << 9;
+
+    /**
+     * Scan a cell's property collection and build its flags. Only intended for use when a model is initialised.
+     *
+     * @param pCell the cell to read
+     * @return the bitwise OR of the flags for each property the cell carries
+     */
+    unsigned ReadCellPropertyFlags(CellPtr pCell);
+}
+
+#endif /* CELLPROPERTYFLAGS_HPP_ */
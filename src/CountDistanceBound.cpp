@@ -0,0 +1,85 @@
+#include "CountDistanceBound.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <fstream>
+
+#include "Exception.hpp"
+
+CountDistanceBound::CountDistanceBound(unsigned numLineages, double tolerance) :
+        mReference(), mCounts(), mNumLineages(numLineages), mNumAdded(0), mTolerance(tolerance)
+{
+    if (numLineages == 0)
+    {
+        EXCEPTION("Count distance bound needs at least one lineage");
+    }
+}
+
+void CountDistanceBound::ReadReference(const std::string& rFilename)
+{
+    std::ifstream referenceFile(rFilename.c_str());
+    if (!referenceFile.is_open())
+    {
+        EXCEPTION("Could not open reference file " + rFilename);
+    }
+
+    mReference.clear();
+    double probability;
+    while (referenceFile >> probability)
+    {
+        mReference.push_back(probability);
+    }
+    if (mReference.empty())
+    {
+        EXCEPTION("Reference file " + rFilename + " holds no probabilities");
+    }
+    mCounts.assign(mReference.size(), 0);
+}
+
+void CountDistanceBound::AddLineage(unsigned count)
+{
+    //counts outside the reference histogram's range do not enter the distance
+    if (count >= 1 && count <= mCounts.size())
+    {
+        mCounts[count - 1]++;
+    }
+    mNumAdded++;
+}
+
+double CountDistanceBound::GetLowerBound() const
+{
+    //d = q - c/N; the lineages still to run add at most mass s, to any counts (including counts off the histogram)
+    std::vector<double> difference(mReference.size());
+    for (unsigned k = 0; k < mReference.size(); k++)
+    {
+        difference[k] = mReference[k] - (double) mCounts[k] / mNumLineages;
+    }
+    double remaining = (mNumAdded < mNumLineages) ? (double) (mNumLineages - mNumAdded) / mNumLineages : 0.0;
+
+    //projection onto {x >= 0, sum x <= s} is x = max(d - tau, 0): tau = 0 if the positive d fit in s, otherwise
+    //the simplex threshold from the sorted differences
+    std::vector<double> sorted(difference);
+    std::sort(sorted.begin(), sorted.end(), std::greater<double>());
+    double tau = 0.0;
+    double cumulative = 0.0;
+    for (unsigned j = 0; j < sorted.size(); j++)
+    {
+        cumulative += sorted[j];
+        double candidate = (cumulative - remaining) / (j + 1);
+        if (sorted[j] < candidate) break;
+        tau = std::max(tau, candidate);
+    }
+
+    double bound = 0.0;
+    for (unsigned k = 0; k < difference.size(); k++)
+    {
+        double residual = std::max(difference[k] - tau, 0.0) - difference[k];
+        bound += residual * residual;
+    }
+    return bound;
+}
+
+bool CountDistanceBound::IsExceeded() const
+{
+    return GetLowerBound() > mTolerance;
+}
@@ -0,0 +1,66 @@
+#ifndef COUNTDISTANCEBOUND_HPP_
+#define COUNTDISTANCEBOUND_HPP_
+
+#include <string>
+#include <vector>
+
+/*******************************
+ * COUNT DISTANCE BOUND
+ * Early abort of count runs whose histogram cannot come within a distance tolerance of a reference histogram.
+ *
+ * USE: Construct with the number of lineages in the full seed range and the tolerance, read the reference with
+ * ReadReference(), then AddLineage() each simulated count. Once IsExceeded(), the run's final distance is certain to
+ * exceed the tolerance, and the simulator may stop (exiting with ABORT_EXIT_CODE).
+ *
+ * The distance is the fitting fixtures' count RSS: sum over counts 1,2,... of (p_k - q_k)^2, where p is the final
+ * count histogram (probability per count) and q the reference. With c_k of the n lineages seen so far having count
+ * k, every completion of the run has p_k >= c_k/N, and the N - n lineages still to run add at most (N - n)/N in
+ * total; counts beyond the reference are dropped from the histogram. GetLowerBound() is the minimum RSS over that set:
+ * the Euclidean projection of q - c/N onto {x >= 0, sum x <= (N - n)/N}. The bound holds whatever the remaining
+ * lineages' counts, so each MPI shard may apply it to its own lineages alone.
+ *******************************/
+
+class CountDistanceBound
+{
+private:
+    //reference probability of count k at index k-1
+    std::vector<double> mReference;
+    //lineages seen so far with count k at index k-1
+    std::vector<unsigned> mCounts;
+    unsigned mNumLineages;
+    unsigned mNumAdded;
+    double mTolerance;
+
+public:
+
+    /** Simulator exit code for runs stopped by the bound */
+    static const int ABORT_EXIT_CODE = 3;
+
+    /**
+     * Constructor.
+     *
+     * @param numLineages the number of lineages the final histogram is made from
+     * @param tolerance the count RSS above which the run is abandoned
+     */
+    CountDistanceBound(unsigned numLineages, double tolerance);
+
+    /**
+     * Read the reference histogram from a text file of whitespace-separated probabilities for counts 1,2,...
+     *
+     * @param rFilename path to the reference file
+     */
+    void ReadReference(const std::string& rFilename);
+
+    /**
+     * @param count a simulated lineage's count
+     */
+    void AddLineage(unsigned count);
+
+    /** @return the smallest count RSS any completion of the run can reach */
+    double GetLowerBound() const;
+
+    /** @return whether the final count RSS is certain to exceed the tolerance */
+    bool IsExceeded() const;
+};
+
+#endif /* COUNTDISTANCEBOUND_HPP_ */
@@ -0,0 +1,237 @@
+#include "CycleDurationSampler.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <boost/math/special_functions/gamma.hpp>
+
+#include "Exception.hpp"
+
+namespace
+{
+    //ziggurat base strip parameters for 128 layers (Marsaglia & Tsang 2000, layout as Doornik 2005)
+    const double ZIG_R = 3.442619855899;
+    const double ZIG_V = 9.91256303526217e-3;
+
+    inline uint64_t Rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    inline uint64_t SplitMix64(uint64_t& rState)
+    {
+        uint64_t z = (rState += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+}
+
+CycleDurationSampler::CycleDurationSampler(unsigned seed, unsigned blockSize) :
+        mBlockSize(((blockSize > LANES ? blockSize : LANES) + LANES - 1) / LANES * LANES), mRawBuffer(mBlockSize), mRawIndex(
+                mBlockSize), mNormalBuffer(mBlockSize), mNormalIndex(mBlockSize), mGammaTable(), mTableShape(0.0), mTableScale(
+                0.0)
+{
+    Reseed(seed);
+
+    //ziggurat layer boundaries
+    double f = exp(-0.5 * ZIG_R * ZIG_R);
+    mZigX[0] = ZIG_V / f;
+    mZigX[1] = ZIG_R;
+    mZigX[ZIG_LAYERS] = 0.0;
+    for (unsigned i = 2; i < ZIG_LAYERS; i++)
+    {
+        mZigX[i] = sqrt(-2.0 * log(ZIG_V / mZigX[i - 1] + f));
+        f = exp(-0.5 * mZigX[i] * mZigX[i]);
+    }
+    for (unsigned i = 0; i < ZIG_LAYERS; i++)
+    {
+        mZigRatio[i] = mZigX[i + 1] / mZigX[i];
+    }
+}
+
+void CycleDurationSampler::Reseed(unsigned seed)
+{
+    uint64_t splitMixState = seed;
+    for (unsigned lane = 0; lane < LANES; lane++)
+    {
+        for (unsigned word = 0; word < 4; word++)
+        {
+            mState[word][lane] = SplitMix64(splitMixState);
+        }
+    }
+    mRawIndex = mBlockSize;
+    mNormalIndex = mBlockSize;
+}
+
+void CycleDurationSampler::RefillRaw()
+{
+    uint64_t* s0 = mState[0];
+    uint64_t* s1 = mState[1];
+    uint64_t* s2 = mState[2];
+    uint64_t* s3 = mState[3];
+
+    //the inner loop is independent across lanes, so each xoshiro256** step is vectorised over LANES generators
+    for (unsigned i = 0; i < mBlockSize; i += LANES)
+    {
+        uint64_t* p_out = &mRawBuffer[i];
+        for (unsigned lane = 0; lane < LANES; lane++)
+        {
+            p_out[lane] = Rotl(s1[lane] * 5, 7) * 9;
+            uint64_t t = s1[lane] << 17;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = Rotl(s3[lane], 45);
+        }
+    }
+    mRawIndex = 0;
+}
+
+void CycleDurationSampler::RefillNormal()
+{
+    for (unsigned i = 0; i < mBlockSize; i++)
+    {
+        mNormalBuffer[i] = ZigguratNormal();
+    }
+    mNormalIndex = 0;
+}
+
+double CycleDurationSampler::ZigguratNormal()
+{
+    for (;;)
+    {
+        //layer index from the low bits, signed uniform from the upper 53 bits of the same draw
+        uint64_t raw = NextRaw();
+        unsigned layer = raw & (ZIG_LAYERS - 1);
+        double u = 2.0 * (((raw >> 11) + 0.5) * (1.0 / 9007199254740992.0)) - 1.0;
+
+        //fast path: inside the layer's rectangle (~99% of draws)
+        if (fabs(u) < mZigRatio[layer])
+        {
+            return u * mZigX[layer];
+        }
+        if (layer == 0)
+        {
+            return ZigguratTail(u < 0);
+        }
+
+        //wedge rejection test
+        double x = u * mZigX[layer];
+        double f0 = exp(-0.5 * (mZigX[layer] * mZigX[layer] - x * x));
+        double f1 = exp(-0.5 * (mZigX[layer + 1] * mZigX[layer + 1] - x * x));
+        if (f1 + NextUniform() * (f0 - f1) < 1.0)
+        {
+            return x;
+        }
+    }
+}
+
+double CycleDurationSampler::ZigguratTail(bool negative)
+{
+    double x, y;
+    do
+    {
+        x = log(NextUniform()) / ZIG_R;
+        y = log(NextUniform());
+    }
+    while (-2.0 * y < x * x);
+    return negative ? x - ZIG_R : ZIG_R - x;
+}
+
+double CycleDurationSampler::MarsagliaTsangGamma(double shape)
+{
+    //shape < 1 boost: Gamma(a) = Gamma(a+1) * U^(1/a)
+    if (shape < 1.0)
+    {
+        return MarsagliaTsangGamma(shape + 1.0) * pow(NextUniform(), 1.0 / shape);
+    }
+
+    double d = shape - 1.0 / 3.0;
+    double c = 1.0 / sqrt(9.0 * d);
+    for (;;)
+    {
+        double x, v;
+        do
+        {
+            x = StandardNormal();
+            v = 1.0 + c * x;
+        }
+        while (v <= 0.0);
+        v = v * v * v;
+
+        double u = NextUniform();
+        double xSq = x * x;
+        if (u < 1.0 - 0.0331 * xSq * xSq) //squeeze
+        {
+            return d * v;
+        }
+        if (log(u) < 0.5 * xSq + d * (1.0 - v + log(v)))
+        {
+            return d * v;
+        }
+    }
+}
+
+double CycleDurationSampler::TableGamma(double u)
+{
+    //table entries are the quantiles at (k + 0.5)/N, interpolate between bracketing entries
+    unsigned resolution = mGammaTable.size();
+    double position = u * resolution - 0.5;
+
+    if (position < 0.0 || position >= resolution - 1)
+    {
+        //outermost half-bins (probability 1/N) have no bracketing entries; invert the CDF exactly
+        return ExactGammaQuantile(mTableShape, mTableScale, u);
+    }
+
+    unsigned index = unsigned(position);
+    double fraction = position - index;
+    return mGammaTable[index] + fraction * (mGammaTable[index + 1] - mGammaTable[index]);
+}
+
+double CycleDurationSampler::Gamma(double shape, double scale)
+{
+    if (!mGammaTable.empty() && shape == mTableShape && scale == mTableScale)
+    {
+        return TableGamma(NextUniform());
+    }
+    return MarsagliaTsangGamma(shape) * scale;
+}
+
+double CycleDurationSampler::GammaQuantile(double shape, double scale, double u)
+{
+    if (!mGammaTable.empty() && shape == mTableShape && scale == mTableScale)
+    {
+        return TableGamma(u);
+    }
+    return ExactGammaQuantile(shape, scale, u);
+}
+
+double CycleDurationSampler::ExactGammaQuantile(double shape, double scale, double u)
+{
+    //ranf() deviates may be exactly 0, so their mirrors may be exactly 1
+    u = std::min(std::max(u, DBL_MIN), 1.0 - DBL_EPSILON / 2);
+    return boost::math::gamma_p_inv(shape, u) * scale;
+}
+
+void CycleDurationSampler::SetGammaTable(double shape, double scale, unsigned resolution)
+{
+    if (shape <= 0.0 || scale <= 0.0 || resolution < 2)
+    {
+        EXCEPTION("Gamma table requires shape > 0, scale > 0 and resolution >= 2");
+    }
+    if (shape == mTableShape && scale == mTableScale && resolution == mGammaTable.size())
+    {
+        return;
+    }
+
+    mTableShape = shape;
+    mTableScale = scale;
+    mGammaTable.resize(resolution);
+    for (unsigned k = 0; k < resolution; k++)
+    {
+        mGammaTable[k] = boost::math::gamma_p_inv(shape, (k + 0.5) / resolution) * scale;
+    }
+}
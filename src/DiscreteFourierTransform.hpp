@@ -0,0 +1,126 @@
+#ifndef DISCRETEFOURIERTRANSFORM_HPP_
+#define DISCRETEFOURIERTRANSFORM_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "Exception.hpp"
+
+/*******************************
+ * DISCRETE FOURIER TRANSFORM
+ * Radix-2 FFT used by the generating function solvers to invert PGFs evaluated at the roots of unity.
+ *
+ * Counts >= N alias onto count mod N, so InvertPGF also takes the PGF at one real point r inside the unit circle
+ * (GetPGFPoints()) and throws if the mass beyond the count range is not negligible.
+ *******************************/
+
+/**
+ * In-place iterative radix-2 FFT, X_m = sum_j x_j exp(-2 pi i j m / N).
+ *
+ * @param rData the sequence to transform; its length must be a power of 2
+ */
+inline void ForwardFFT(std::vector<std::complex<double> >& rData)
+{
+    unsigned n = rData.size();
+
+    //bit reversal permutation
+    for (unsigned i = 1, j = 0; i < n; i++)
+    {
+        unsigned bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) std::swap(rData[i], rData[j]);
+    }
+
+    for (unsigned length = 2; length <= n; length <<= 1)
+    {
+        double angle = -2.0 * M_PI / length;
+        std::complex<double> rootStep(cos(angle), sin(angle));
+        for (unsigned start = 0; start < n; start += length)
+        {
+            std::complex<double> root(1.0, 0.0);
+            for (unsigned k = 0; k < length / 2; k++)
+            {
+                std::complex<double> even = rData[start + k];
+                std::complex<double> odd = rData[start + k + length / 2] * root;
+                rData[start + k] = even + odd;
+                rData[start + k + length / 2] = even - odd;
+                root *= rootStep;
+            }
+        }
+    }
+}
+
+/**
+ * Points at which the solvers evaluate their PGFs for InvertPGF: z_j = exp(2 pi i j / N), j = 0 ... N/2, then the
+ * aliasing check point r = 2^(-1/N).
+ *
+ * @param transformLength N, a power of 2
+ * @return the N/2 + 2 evaluation points
+ */
+inline std::vector<std::complex<double> > GetPGFPoints(unsigned transformLength)
+{
+    unsigned numPoints = transformLength / 2 + 1;
+    std::vector<std::complex<double> > points(numPoints + 1);
+    for (unsigned j = 0; j < numPoints; j++)
+    {
+        points[j] = std::polar(1.0, 2.0 * M_PI * j / transformLength);
+    }
+    points[numPoints] = pow(0.5, 1.0 / transformLength);
+    return points;
+}
+
+/**
+ * Recover count probabilities from a PGF evaluated at GetPGFPoints(N).
+ * PGFs have real coefficients, so the remaining roots of unity are the conjugates.
+ *
+ * @param rValues the PGF at the points given by GetPGFPoints(transformLength)
+ * @param transformLength N, a power of 2
+ * @param aliasTolerance largest probability mass at counts >= N accepted
+ * @return P(count = m), m = 0 ... N-1
+ */
+inline std::vector<double> InvertPGF(const std::vector<std::complex<double> >& rValues, unsigned transformLength,
+                                     double aliasTolerance = 1e-6)
+{
+    unsigned numPoints = transformLength / 2 + 1;
+    std::vector<std::complex<double> > values(transformLength);
+    for (unsigned j = 0; j < transformLength; j++)
+    {
+        values[j] = (j < numPoints) ? rValues[j] : std::conj(rValues[transformLength - j]);
+    }
+
+    //P(m) = (1/N) sum_j F(z_j) z_j^-m; with mass beyond the range, this is u_m = sum_k P(m + kN)
+    ForwardFFT(values);
+    std::vector<double> distribution(transformLength);
+    for (unsigned m = 0; m < transformLength; m++)
+    {
+        distribution[m] = values[m].real() / transformLength;
+    }
+
+    //sum_m u_m r^m - F(r) = sum_{k>0,m} P(m + kN) r^m (1 - r^kN), at least r^(N-1)(1 - r^N) = 1/(4r) of the tail
+    double r = pow(0.5, 1.0 / transformLength);
+    double folded = 0.0;
+    for (unsigned m = transformLength; m-- > 0;)
+    {
+        folded = folded * r + distribution[m];
+    }
+    double aliasedMass = std::min(1.0, 4.0 * r * (folded - rValues[numPoints].real()));
+    if (aliasedMass > aliasTolerance)
+    {
+        EXCEPTION("Up to " << aliasedMass << " probability lies beyond the largest count resolved ("
+                  << transformLength - 1 << "); increase -max_count");
+    }
+
+    for (unsigned m = 0; m < transformLength; m++)
+    {
+        distribution[m] = std::max(0.0, distribution[m]);
+    }
+    return distribution;
+}
+
+#endif /* DISCRETEFOURIERTRANSFORM_HPP_ */
@@ -0,0 +1,81 @@
+#include "EventOutputBuffer.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+#include "LogFile.hpp"
+
+namespace
+{
+    //guards worker registration only; appends never lock
+    std::mutex registryMutex;
+}
+
+bool EventOutputBuffer::ChunkPrecedes(const Chunk& rA, const Chunk& rB)
+{
+    if (rA.mSeed != rB.mSeed) return rA.mSeed < rB.mSeed;
+    if (rA.mWorker != rB.mWorker) return rA.mWorker < rB.mWorker;
+    return rA.mOrder < rB.mOrder;
+}
+
+EventOutputBuffer::EventOutputBuffer(unsigned worker) :
+        mWorker(worker), mCurrentSeed(0), mCurrentRows(), mChunks()
+{
+}
+
+std::vector<EventOutputBuffer*>& EventOutputBuffer::rGetWorkerBuffers()
+{
+    static std::vector<EventOutputBuffer*> workerBuffers;
+    return workerBuffers;
+}
+
+EventOutputBuffer* EventOutputBuffer::Instance()
+{
+    thread_local EventOutputBuffer* p_instance = NULL;
+    if (p_instance == NULL)
+    {
+        //buffers live until program exit so that MergeToLog() can run after worker threads have finished
+        std::lock_guard<std::mutex> lock(registryMutex);
+        p_instance = new EventOutputBuffer(rGetWorkerBuffers().size());
+        rGetWorkerBuffers().push_back(p_instance);
+    }
+    return p_instance;
+}
+
+void EventOutputBuffer::CloseChunk()
+{
+    std::string rows = mCurrentRows.str();
+    if (!rows.empty())
+    {
+        Chunk chunk = { mCurrentSeed, mWorker, (unsigned) mChunks.size(), rows };
+        mChunks.push_back(chunk);
+        mCurrentRows.str("");
+    }
+}
+
+void EventOutputBuffer::BeginSeed(unsigned seed)
+{
+    CloseChunk();
+    mCurrentSeed = seed;
+}
+
+void EventOutputBuffer::MergeToLog()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    std::vector<Chunk> allChunks;
+    for (EventOutputBuffer* p_buffer : rGetWorkerBuffers())
+    {
+        p_buffer->CloseChunk();
+        allChunks.insert(allChunks.end(), p_buffer->mChunks.begin(), p_buffer->mChunks.end());
+        p_buffer->mChunks.clear();
+    }
+
+    std::sort(allChunks.begin(), allChunks.end(), ChunkPrecedes);
+
+    LogFile* p_log = LogFile::Instance();
+    for (const Chunk& rChunk : allChunks)
+    {
+        *p_log << rChunk.mRows;
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef EVENTOUTPUTBUFFER_HPP_
+#define EVENTOUTPUTBUFFER_HPP_
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*******************************
+ * EVENT OUTPUT BUFFER
+ * Per-worker, seed-tagged append buffer for simulator row output (mode events, sequences, counts).
+ *
+ * USE: Instance() returns the calling thread's own buffer, so concurrent lineages never share a writer.
+ * A worker calls BeginSeed(seed) before simulating a seed; everything streamed into its buffer with << until the next
+ * BeginSeed() forms that seed's chunk. MergeToLog() (called from one thread once the workers are idle) writes all
+ * workers' chunks to the singleton LogFile in seed order, then clears the buffers. Chunks for the same seed keep
+ * their write order, so the merged file is identical to a serial run writing directly to the LogFile.
+ * Serial simulators merge after each seed, holding one seed's rows at a time; threaded callers merge once every
+ * worker has finished its seeds.
+ *
+ * Values are formatted with default ostream settings, as in LogFile.
+ *******************************/
+
+class EventOutputBuffer
+{
+private:
+    /** One seed's rows from one worker */
+    struct Chunk
+    {
+        unsigned mSeed;
+        unsigned mWorker;
+        unsigned mOrder;
+        std::string mRows;
+    };
+
+    unsigned mWorker;
+    unsigned mCurrentSeed;
+    std::ostringstream mCurrentRows;
+    std::vector<Chunk> mChunks;
+
+    explicit EventOutputBuffer(unsigned worker);
+
+    //Move the current seed's rows into the chunk list
+    void CloseChunk();
+
+    //Merge ordering: seed, then worker, then write order
+    static bool ChunkPrecedes(const Chunk& rA, const Chunk& rB);
+
+    //Every worker's buffer, registered on the worker's first Instance() call
+    static std::vector<EventOutputBuffer*>& rGetWorkerBuffers();
+
+public:
+
+    /** @return the calling thread's buffer */
+    static EventOutputBuffer* Instance();
+
+    /**
+     * Start a new chunk; subsequent output belongs to this seed
+     *
+     * @param seed the simulation seed about to be run
+     */
+    void BeginSeed(unsigned seed);
+
+    /**
+     * Append to the current seed's chunk
+     *
+     * @param rValue the value to write
+     * @return this buffer
+     */
+    template<typename T>
+    EventOutputBuffer& operator<<(const T& rValue)
+    {
+        mCurrentRows << rValue;
+        return *this;
+    }
+
+    /**
+     * Write all workers' buffered chunks to the singleton LogFile in seed order, then clear them.
+     * Not thread safe- call while no worker is writing.
+     */
+    static void MergeToLog();
+};
+
+#endif /* EVENTOUTPUTBUFFER_HPP_ */
@@ -3,20 +3,21 @@
 
 GomesCellCycleModel::GomesCellCycleModel() :
         AbstractSimpleCellCycleModel(), mOutput(false), mEventStartTime(), mSequenceSampler(false), mSeqSamplerLabelSister(
-                false), mDebug(false), mTimeID(), mVarIDs(), mDebugWriter(), mNormalMu(3.9716), mNormalSigma(0.32839), mPP(
-                .055), mPD(0.221), mpBC(.128), mpAC(.106), mpMG(.028), mMitoticMode(), mSeed(), mp_PostMitoticType(), mp_RPh_Type(), mp_BC_Type(), mp_AC_Type(), mp_MG_Type(), mp_label_Type()
+                false), mMirroredDraws(false), mDebug(false), mTimeID(), mVarIDs(), mDebugWriter(), mNormalMu(3.9716), mNormalSigma(0.32839), mPP(
+                .055), mPD(0.221), mpBC(.128), mpAC(.106), mpMG(.028), mMitoticMode(), mSeed(), mp_PostMitoticType(), mp_RPh_Type(), mp_BC_Type(), mp_AC_Type(), mp_MG_Type(), mp_label_Type(), mPropertyFlags(0), mpDurationSampler()
 {
 }
 
 GomesCellCycleModel::GomesCellCycleModel(const GomesCellCycleModel& rModel) :
         AbstractSimpleCellCycleModel(rModel), mOutput(rModel.mOutput), mEventStartTime(rModel.mEventStartTime), mSequenceSampler(
-                rModel.mSequenceSampler), mSeqSamplerLabelSister(rModel.mSeqSamplerLabelSister), mDebug(rModel.mDebug), mTimeID(
+                rModel.mSequenceSampler), mSeqSamplerLabelSister(rModel.mSeqSamplerLabelSister), mMirroredDraws(
+                rModel.mMirroredDraws), mDebug(rModel.mDebug), mTimeID(
                 rModel.mTimeID), mVarIDs(rModel.mVarIDs), mDebugWriter(rModel.mDebugWriter), mNormalMu(
                 rModel.mNormalMu), mNormalSigma(rModel.mNormalSigma), mPP(rModel.mPP), mPD(rModel.mPD), mpBC(
                 rModel.mpBC), mpAC(rModel.mpAC), mpMG(rModel.mpMG), mMitoticMode(rModel.mMitoticMode), mSeed(
                 rModel.mSeed), mp_PostMitoticType(rModel.mp_PostMitoticType), mp_RPh_Type(rModel.mp_RPh_Type), mp_BC_Type(
                 rModel.mp_BC_Type), mp_AC_Type(rModel.mp_AC_Type), mp_MG_Type(rModel.mp_MG_Type), mp_label_Type(
-                rModel.mp_label_Type)
+                rModel.mp_label_Type), mPropertyFlags(rModel.mPropertyFlags), mpDurationSampler(rModel.mpDurationSampler)
 {
 }
 
@@ -31,10 +32,20 @@ void GomesCellCycleModel::SetCellCycleDuration()
      * CELL CYCLE DURATION RANDOM VARIABLE
      *************************************/
 
-    RandomNumberGenerator* p_random_number_generator = RandomNumberGenerator::Instance();
-
     //Gomes cell cycle length determined by lognormal distribution with default mean 56 hr, std 18.9 hrs.
-    mCellCycleDuration = exp(p_random_number_generator->NormalRandomDeviate(mNormalMu, mNormalSigma));
+    double standardNormal;
+    if (mpDurationSampler)
+    {
+        standardNormal = mpDurationSampler->StandardNormal();
+    }
+    else
+    {
+        RandomNumberGenerator* p_random_number_generator = RandomNumberGenerator::Instance();
+        standardNormal = p_random_number_generator->StandardNormalRandomDeviate();
+    }
+    //the normal quantile is symmetric, so the mirrored draw of an antithetic pair is the negated deviate
+    if (mMirroredDraws) standardNormal = -standardNormal;
+    mCellCycleDuration = exp(mNormalMu + mNormalSigma * standardNormal);
 }
 
 void GomesCellCycleModel::ResetForDivision()
@@ -52,6 +63,7 @@ void GomesCellCycleModel::ResetForDivision()
      ******************************/
     //initialise mitoticmode random variable, set mitotic mode appropriately after comparing to mode probability array
     double mitoticModeRV = p_random_number_generator->ranf();
+    if (mMirroredDraws) mitoticModeRV = 1.0 - mitoticModeRV;
 
     if (mitoticModeRV > mPP && mitoticModeRV <= mPP + mPD)
     {
@@ -89,6 +101,7 @@ void GomesCellCycleModel::ResetForDivision()
     if (mMitoticMode == 2)
     {
         mpCell->SetCellProliferativeType(mp_PostMitoticType);
+        mPropertyFlags |= CellPropertyFlags::POSTMITOTIC;
         mCellCycleDuration = DBL_MAX;
         /*****************************
          * SPECIFICATION RANDOM VARIABLE
@@ -97,18 +110,22 @@ void GomesCellCycleModel::ResetForDivision()
         if (specificationRV <= mpMG)
         {
             mpCell->AddCellProperty(mp_MG_Type);
+            mPropertyFlags |= CellPropertyFlags::MG_FATE;
         }
         if (specificationRV > mpMG && specificationRV <= mpMG + mpAC)
         {
             mpCell->AddCellProperty(mp_AC_Type);
+            mPropertyFlags |= CellPropertyFlags::AC_FATE;
         }
         if (specificationRV > mpMG + mpAC && specificationRV <= mpMG + mpAC + mpBC)
         {
             mpCell->AddCellProperty(mp_BC_Type);
+            mPropertyFlags |= CellPropertyFlags::BC_FATE;
         }
         if (specificationRV > mpMG + mpAC + mpBC)
         {
             mpCell->AddCellProperty(mp_RPh_Type);
+            mPropertyFlags |= CellPropertyFlags::RPH_FATE;
         }
     }
 
@@ -119,14 +136,15 @@ void GomesCellCycleModel::ResetForDivision()
     //50% chance of each daughter cell from a mitosis inheriting the label
     if (mSequenceSampler)
     {
-        if (mpCell->HasCellProperty<CellLabel>())
+        if (mPropertyFlags & CellPropertyFlags::LABEL)
         {
-            (*LogFile::Instance()) << mMitoticMode;
+            (*EventOutputBuffer::Instance()) << mMitoticMode;
             double labelRV = p_random_number_generator->ranf();
             if (labelRV <= .5)
             {
                 mSeqSamplerLabelSister = true;
                 mpCell->RemoveCellProperty<CellLabel>();
+                mPropertyFlags &= ~CellPropertyFlags::LABEL;
             }
             else
             {
@@ -141,6 +159,14 @@ void GomesCellCycleModel::ResetForDivision()
     }
 }
 
+void GomesCellCycleModel::Initialise()
+{
+    //the only property collection scan this model makes; kept current by the model from here on
+    mPropertyFlags = CellPropertyFlags::ReadCellPropertyFlags(mpCell);
+
+    AbstractSimpleCellCycleModel::Initialise();
+}
+
 void GomesCellCycleModel::InitialiseDaughterCell()
 {
     if (mMitoticMode == 0)
@@ -157,6 +183,7 @@ void GomesCellCycleModel::InitialiseDaughterCell()
     {
         RandomNumberGenerator* p_random_number_generator = RandomNumberGenerator::Instance();
         mpCell->SetCellProliferativeType(mp_PostMitoticType);
+        mPropertyFlags |= CellPropertyFlags::POSTMITOTIC;
         mCellCycleDuration = DBL_MAX;
         /*********************
          * SPECIFICATION RULES
@@ -165,18 +192,22 @@ void GomesCellCycleModel::InitialiseDaughterCell()
         if (specificationRV <= mpMG)
         {
             mpCell->AddCellProperty(mp_MG_Type);
+            mPropertyFlags |= CellPropertyFlags::MG_FATE;
         }
         if (specificationRV > mpMG && specificationRV <= mpMG + mpAC)
         {
             mpCell->AddCellProperty(mp_AC_Type);
+            mPropertyFlags |= CellPropertyFlags::AC_FATE;
         }
         if (specificationRV > mpMG + mpAC && specificationRV <= mpMG + mpAC + mpBC)
         {
             mpCell->AddCellProperty(mp_BC_Type);
+            mPropertyFlags |= CellPropertyFlags::BC_FATE;
         }
         if (specificationRV > mpMG + mpAC + mpBC)
         {
             mpCell->AddCellProperty(mp_RPh_Type);
+            mPropertyFlags |= CellPropertyFlags::RPH_FATE;
         }
     }
 
@@ -186,6 +217,8 @@ void GomesCellCycleModel::InitialiseDaughterCell()
         //remove the fate assigned to the parent cell in ResetForDivision, then assign the sister fate as usual
         mpCell->RemoveCellProperty<AbstractCellProperty>();
         mpCell->SetCellProliferativeType(mp_PostMitoticType);
+        //the removal above is by collection order rather than type, so resynchronise the flags (DD sisters only)
+        mPropertyFlags = CellPropertyFlags::ReadCellPropertyFlags(mpCell);
 
         /*********************
          * SPECIFICATION RULES
@@ -194,18 +227,22 @@ void GomesCellCycleModel::InitialiseDaughterCell()
         if (specificationRV <= mpMG)
         {
             mpCell->AddCellProperty(mp_MG_Type);
+            mPropertyFlags |= CellPropertyFlags::MG_FATE;
         }
         if (specificationRV > mpMG && specificationRV <= mpMG + mpAC)
         {
             mpCell->AddCellProperty(mp_AC_Type);
+            mPropertyFlags |= CellPropertyFlags::AC_FATE;
         }
         if (specificationRV > mpMG + mpAC && specificationRV <= mpMG + mpAC + mpBC)
         {
             mpCell->AddCellProperty(mp_BC_Type);
+            mPropertyFlags |= CellPropertyFlags::BC_FATE;
         }
         if (specificationRV > mpMG + mpAC + mpBC)
         {
             mpCell->AddCellProperty(mp_RPh_Type);
+            mPropertyFlags |= CellPropertyFlags::RPH_FATE;
         }
     }
 
@@ -217,11 +254,13 @@ void GomesCellCycleModel::InitialiseDaughterCell()
         if (mSeqSamplerLabelSister)
         {
             mpCell->AddCellProperty(mp_label_Type);
+            mPropertyFlags |= CellPropertyFlags::LABEL;
             mSeqSamplerLabelSister = false;
         }
-        else
+        else if (mPropertyFlags & CellPropertyFlags::LABEL)
         {
             mpCell->RemoveCellProperty<CellLabel>();
+            mPropertyFlags &= ~CellPropertyFlags::LABEL;
         }
     }
 }
@@ -268,7 +307,18 @@ void GomesCellCycleModel::WriteModeEventOutput()
     double currentTime = SimulationTime::Instance()->GetTime() + mEventStartTime;
     CellPtr currentCell = GetCell();
     double currentCellID = (double) currentCell->GetCellId();
-    (*LogFile::Instance()) << currentTime << "\t" << mSeed << "\t" << currentCellID << "\t" << mMitoticMode << "\n";
+    (*EventOutputBuffer::Instance()) << currentTime << "\t" << mSeed << "\t" << currentCellID << "\t" << mMitoticMode << "\t"
+            << mPP << "\t" << mPD << "\t" << 1.0 - mPP - mPD << "\n";
+}
+
+void GomesCellCycleModel::EnableFastDurationSampler(boost::shared_ptr<CycleDurationSampler> p_sampler)
+{
+    mpDurationSampler = p_sampler;
+}
+
+void GomesCellCycleModel::EnableAntitheticDraws()
+{
+    mMirroredDraws = true;
 }
 
 void GomesCellCycleModel::EnableSequenceSampler(boost::shared_ptr<AbstractCellProperty> label)
@@ -9,7 +9,10 @@
 #include "SmartPointers.hpp"
 #include "ColumnDataWriter.hpp"
 #include "LogFile.hpp"
+#include "EventOutputBuffer.hpp"
 #include "CellLabel.hpp"
+#include "CellPropertyFlags.hpp"
+#include "CycleDurationSampler.hpp"
 
 /*******************************************
  * GOMES CELL CYCLE MODEL
@@ -25,13 +28,20 @@
  * Set AbstractCellProperties for differentiated neural types with SetModelProperties();
  *
  * 2 per-model-event output modes:
- * EnableModeEventOutput() enables mitotic mode event logging-all cells will write to the singleton log file
+ * EnableModeEventOutput() enables mitotic mode event logging-all cells will write to the worker's EventOutputBuffer,
+ * merged into the singleton log file by the simulator
  * EnableModelDebugOutput() enables more detailed debug output, each seed will have its own file written to
  * by a ColumnDataWriter passed to it from the test
  * (eg. by the SetupDebugOutput helper function in the project simulator)
  *
  * 1 mitotic-event-sequence sampler (only samples one "path" through the lineage):
- * EnableSequenceSampler() - one "sequence" of progenitors writes mitotic event type to a string in the singleton log file
+ * EnableSequenceSampler() - one "sequence" of progenitors writes mitotic event type to a string in the EventOutputBuffer
+ *
+ * EnableFastDurationSampler() draws lognormal cycle durations from a shared CycleDurationSampler
+ * instead of the RandomNumberGenerator singleton
+ *
+ * EnableAntitheticDraws() makes the lineage the mirrored member of an antithetic pair replaying its partner's seed:
+ * mitotic mode RVs are 1-U and cycle durations use the mirrored lognormal quantile exp(2mu - ln(duration))
  *
  **********************************************/
 
@@ -70,6 +80,7 @@ protected:
     double mEventStartTime;
     bool mSequenceSampler;
     bool mSeqSamplerLabelSister;
+    bool mMirroredDraws;
     //debug writer stuff
     bool mDebug;
     int mTimeID;
@@ -91,6 +102,10 @@ protected:
     boost::shared_ptr<AbstractCellProperty> mp_AC_Type;
     boost::shared_ptr<AbstractCellProperty> mp_MG_Type;
     boost::shared_ptr<AbstractCellProperty> mp_label_Type;
+    //cached cell property flags (see CellPropertyFlags.hpp)
+    unsigned mPropertyFlags;
+    //optional buffered cycle duration stream, shared by all models in a simulation
+    boost::shared_ptr<CycleDurationSampler> mpDurationSampler;
 
     /**
      * Protected copy-constructor for use by CreateCellCycleModel().
@@ -134,6 +149,12 @@ public:
      **/
     void ResetForDivision();
 
+    /**
+     * Overridden Initialise() method.
+     * Reads the cell's property flags, then sets the cell cycle duration as usual
+     **/
+    void Initialise();
+
     /** Overridden InitialiseDaughterCell() method. Used to implement asymmetric mitotic mode*/
     void InitialiseDaughterCell();
 
@@ -156,10 +177,16 @@ public:
     void SetPostMitoticType(boost::shared_ptr<AbstractCellProperty> p_PostMitoticType);
 
     //Functions to enable per-cell mitotic mode logging for mode rate & sequence sampling fixtures
-    //Uses singleton logfile
+    //Uses the worker's EventOutputBuffer (see EventOutputBuffer.hpp)
     void EnableModeEventOutput(double eventStart, unsigned seed);
     void EnableSequenceSampler(boost::shared_ptr<AbstractCellProperty> label);
 
+    //Function to draw cycle durations from a buffered sampler shared by the simulation's models (see CycleDurationSampler.hpp)
+    void EnableFastDurationSampler(boost::shared_ptr<CycleDurationSampler> p_sampler);
+
+    //Function to mirror mitotic mode & cycle duration draws, for the second member of an antithetic pair
+    void EnableAntitheticDraws();
+
     //More detailed debug output. Needs a ColumnDataWriter passed to it
     //Only declare ColumnDataWriter directory, filename, etc; do not set up otherwise
     void EnableModelDebugOutput(boost::shared_ptr<ColumnDataWriter> debugWriter);
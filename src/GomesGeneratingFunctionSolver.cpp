@@ -0,0 +1,149 @@
+#include "GomesGeneratingFunctionSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <boost/math/special_functions/erf.hpp>
+
+#include "Exception.hpp"
+#include "DiscreteFourierTransform.hpp"
+
+namespace
+{
+    //cycle length pmf is truncated once the survival probability falls below this
+    const double LIFETIME_TAIL = 1e-15;
+}
+
+GomesGeneratingFunctionSolver::GomesGeneratingFunctionSolver(double dt, unsigned maxCount) :
+        mDt(dt), mTransformLength(1), mNormalMu(), mNormalSigma(), mPP(), mPD(), mpBC(), mpAC(), mpMG(), mLifetimePmf()
+{
+    if (dt <= 0)
+    {
+        EXCEPTION("Solver timestep must be > 0");
+    }
+    while (mTransformLength < maxCount + 1)
+    {
+        mTransformLength <<= 1;
+    }
+    SetModelParameters();
+}
+
+void GomesGeneratingFunctionSolver::SetModelParameters(double normalMu, double normalSigma, double PP, double PD,
+                                                       double pBC, double pAC, double pMG)
+{
+    mNormalMu = normalMu;
+    mNormalSigma = normalSigma;
+    mPP = PP;
+    mPD = PD;
+    mpBC = pBC;
+    mpAC = pAC;
+    mpMG = pMG;
+    SetupLifetimePmf();
+}
+
+double GomesGeneratingFunctionSolver::GetCycleSurvival(unsigned n) const
+{
+    if (n == 0)
+    {
+        return 1.0;
+    }
+    //P(exp(N(mu, sigma)) > n*dt)
+    double z = (log(n * mDt) - mNormalMu) / mNormalSigma;
+    return 0.5 * boost::math::erfc(z / M_SQRT2);
+}
+
+void GomesGeneratingFunctionSolver::SetupLifetimePmf()
+{
+    //a cell divides at the first step at which its age reaches the drawn duration: cycle = ceil(duration/dt) steps
+    mLifetimePmf.assign(1, 0.0);
+    double previousSurvival = 1.0;
+    for (unsigned k = 1; previousSurvival > LIFETIME_TAIL; k++)
+    {
+        double survival = GetCycleSurvival(k);
+        mLifetimePmf.push_back(previousSurvival - survival);
+        previousSurvival = survival;
+    }
+}
+
+std::vector<std::complex<double> > GomesGeneratingFunctionSolver::EvaluatePGF(
+        const std::vector<std::complex<double> >& rProliferativeMarks,
+        const std::vector<std::complex<double> >& rPostMitoticMarks, unsigned endStep) const
+{
+    unsigned numPoints = rProliferativeMarks.size();
+    unsigned maxLifetime = mLifetimePmf.size() - 1;
+    double pDD = 1.0 - mPP - mPD;
+
+    //offspring PGF of a division at each step, H_m = pPP F_m^2 + pPD F_m g + pDD g^2
+    std::vector<std::vector<std::complex<double> > > offspring(endStep + 1,
+                                                               std::vector<std::complex<double> >(numPoints));
+    std::vector<std::complex<double> > current(numPoints);
+
+    for (unsigned n = 0; n <= endStep; n++)
+    {
+        //cells that have not divided by step n are still proliferative
+        double survival = GetCycleSurvival(n);
+        for (unsigned j = 0; j < numPoints; j++)
+        {
+            current[j] = survival * rProliferativeMarks[j];
+        }
+
+        //renewal sum over the first division step k
+        unsigned kMax = std::min(n, maxLifetime);
+        for (unsigned k = 1; k <= kMax; k++)
+        {
+            double pk = mLifetimePmf[k];
+            const std::vector<std::complex<double> >& r_offspring = offspring[n - k];
+            for (unsigned j = 0; j < numPoints; j++)
+            {
+                current[j] += pk * r_offspring[j];
+            }
+        }
+
+        for (unsigned j = 0; j < numPoints; j++)
+        {
+            const std::complex<double>& g = rPostMitoticMarks[j];
+            offspring[n][j] = mPP * current[j] * current[j] + mPD * current[j] * g + pDD * g * g;
+        }
+    }
+
+    return current;
+}
+
+std::vector<double> GomesGeneratingFunctionSolver::GetCountDistribution(CountType countType, double endTime) const
+{
+    unsigned endStep = (unsigned) floor(endTime / mDt + 1e-9);
+
+    //probabilities of the fate counted, if any
+    double pFate = 0.0;
+    if (countType == RPH_COUNT) pFate = 1.0 - mpBC - mpAC - mpMG;
+    if (countType == AC_COUNT) pFate = mpAC;
+    if (countType == BC_COUNT) pFate = mpBC;
+    if (countType == MG_COUNT) pFate = mpMG;
+
+    //evaluate at roots of unity z_j = exp(2 pi i j / N) & the aliasing check point; F(conj z) = conj F(z)
+    std::vector<std::complex<double> > points = GetPGFPoints(mTransformLength);
+    unsigned numPoints = points.size();
+    std::vector<std::complex<double> > proliferativeMarks(numPoints);
+    std::vector<std::complex<double> > postMitoticMarks(numPoints);
+    for (unsigned j = 0; j < numPoints; j++)
+    {
+        const std::complex<double>& z = points[j];
+        if (countType == CLONE_SIZE)
+        {
+            proliferativeMarks[j] = z;
+            postMitoticMarks[j] = z;
+        }
+        else
+        {
+            proliferativeMarks[j] = 1.0;
+            postMitoticMarks[j] = 1.0 + pFate * (z - 1.0);
+        }
+    }
+
+    std::vector<std::complex<double> > values = EvaluatePGF(proliferativeMarks, postMitoticMarks, endStep);
+    return InvertPGF(values, mTransformLength);
+}
+
+unsigned GomesGeneratingFunctionSolver::GetCountRange() const
+{
+    return mTransformLength;
+}
@@ -0,0 +1,99 @@
+#ifndef GOMESGENERATINGFUNCTIONSOLVER_HPP_
+#define GOMESGENERATINGFUNCTIONSOLVER_HPP_
+
+#include <complex>
+#include <vector>
+
+/***********************************
+ * GOMES GENERATING FUNCTION SOLVER
+ * Exact clone-size and fate-count distributions for the GomesCellCycleModel lineage, without Monte Carlo.
+ *
+ * USE: Construct with the simulator timestep and the largest count to resolve, set the same parameters as
+ * GomesCellCycleModel::SetModelParameters(), then request distributions at a simulation end time.
+ *
+ * The Gomes lineage is an age-dependent (Bellman-Harris) branching process: independent lognormal cycles, fixed
+ * PP/PD/DD probabilities, independent fate draws for each postmitotic cell. On the simulator's timestep grid the
+ * cycle length is the whole number of steps at which a cell's age first reaches its drawn duration, so the
+ * discretised renewal equation for a proliferative cell's probability generating function F
+ *
+ * F_n(s) = s_P * P(cycle > n) + sum_k P(cycle = k) * [pPP F_(n-k)^2 + pPD F_(n-k) g(s) + pDD g(s)^2]
+ *
+ * (g = postmitotic fate PGF) is exact for the discrete-time simulation. F is evaluated at the roots of unity and
+ * inverted by FFT, giving count probabilities to rounding error, provided the count range covers the clone sizes;
+ * InvertPGF throws if more than 1e-6 of the probability lies beyond it.
+ * Divisions at the end time are counted, as in OffLatticeSimulation's final population update.
+ ************************************/
+
+class GomesGeneratingFunctionSolver
+{
+public:
+    /** Counted quantities; CLONE_SIZE counts all cells, the fates count postmitotic cells specified to each fate */
+    enum CountType
+    {
+        CLONE_SIZE = 0,
+        RPH_COUNT,
+        AC_COUNT,
+        BC_COUNT,
+        MG_COUNT
+    };
+
+private:
+    double mDt;
+    unsigned mTransformLength;
+    //model parameters
+    double mNormalMu;
+    double mNormalSigma;
+    double mPP;
+    double mPD;
+    double mpBC;
+    double mpAC;
+    double mpMG;
+    //cycle length in timesteps: mLifetimePmf[k] = P(cycle = k steps), k >= 1
+    std::vector<double> mLifetimePmf;
+
+    //Discretise the lognormal cycle onto the timestep grid
+    void SetupLifetimePmf();
+
+    /**
+     * Evaluate the founder's PGF at endStep for a set of points, all points advanced together.
+     *
+     * @param rProliferativeMarks the proliferative cell argument s_P at each point
+     * @param rPostMitoticMarks the postmitotic fate PGF g(s) at each point
+     * @param endStep number of timesteps simulated
+     * @return F_endStep at each point
+     */
+    std::vector<std::complex<double> > EvaluatePGF(const std::vector<std::complex<double> >& rProliferativeMarks,
+                                                   const std::vector<std::complex<double> >& rPostMitoticMarks,
+                                                   unsigned endStep) const;
+
+    /** @return P(cycle > n steps) */
+    double GetCycleSurvival(unsigned n) const;
+
+public:
+
+    /**
+     * Constructor, with GomesCellCycleModel's default parameters.
+     *
+     * @param dt simulator timestep (GomesSimulator uses 0.25 h)
+     * @param maxCount largest count resolved; the count range is rounded up to a power of 2
+     */
+    GomesGeneratingFunctionSolver(double dt = 0.25, unsigned maxCount = 255);
+
+    /**
+     * Model parameters, as GomesCellCycleModel::SetModelParameters()
+     */
+    void SetModelParameters(double normalMu = 3.9716, double normalSigma = 0.32839, double PP = .055,
+                            double PD = .221, double pBC = .128, double pAC = .106, double pMG = .028);
+
+    /**
+     * @param countType the counted quantity
+     * @param endTime simulation end time (h)
+     * @return P(count = m) for m = 0 ... count range - 1; throws if the range misses more than 1e-6 of the mass
+     */
+    std::vector<double> GetCountDistribution(CountType countType, double endTime) const;
+
+    /** @return the number of counts resolved by GetCountDistribution() */
+    unsigned GetCountRange() const;
+};
+
+#endif /* GOMESGENERATINGFUNCTIONSOLVER_HPP_ */
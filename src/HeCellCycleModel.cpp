@@ -2,10 +2,13 @@
 
 HeCellCycleModel::HeCellCycleModel() :
         AbstractSimpleCellCycleModel(), mKillSpecified(false), mDeterministic(false), mOutput(false), mEventStartTime(
-                24.0), mSequenceSampler(false), mSeqSamplerLabelSister(false), mDebug(false), mTimeID(), mVarIDs(), mDebugWriter(), mTiLOffset(
+                24.0), mSequenceSampler(false), mSeqSamplerLabelSister(false), mAntitheticDraws(false), mMirroredDraws(false), mDebug(false), mTimeID(), mVarIDs(), mDebugWriter(), mTiLOffset(
                 0.0), mGammaShift(4.0), mGammaShape(2.0), mGammaScale(1.0), mSisterShiftWidth(1), mMitoticModePhase2(
                 8.0), mMitoticModePhase3(15.0), mPhaseShiftWidth(2.0), mPhase1PP(1.0), mPhase1PD(0.0), mPhase2PP(0.2), mPhase2PD(
-                0.4), mPhase3PP(0.2), mPhase3PD(0.0), mMitoticMode(0), mSeed(0), mTimeDependentCycleDuration(false), mPeakRateTime(), mIncreasingRateSlope(), mDecreasingRateSlope(), mBaseGammaScale()
+                0.4), mPhase3PP(0.2), mPhase3PD(0.0), mMitoticMode(0), mSeed(0), mTimeDependentCycleDuration(false), mPeakRateTime(), mIncreasingRateSlope(), mDecreasingRateSlope(), mBaseGammaScale(), mPropertyFlags(
+                0), mp_TransitType(CellPropertyRegistry::Instance()->Get<TransitCellProliferativeType>()), mp_PostMitoticType(
+                CellPropertyRegistry::Instance()->Get<DifferentiatedCellProliferativeType>()), mp_label_Type(
+                CellPropertyRegistry::Instance()->Get<CellLabel>()), mpDurationSampler(), mpLikelihoodRecorder()
 {
     mReadyToDivide = true; //He model begins with a first division
 }
@@ -13,7 +16,8 @@ HeCellCycleModel::HeCellCycleModel() :
 HeCellCycleModel::HeCellCycleModel(const HeCellCycleModel& rModel) :
         AbstractSimpleCellCycleModel(rModel), mKillSpecified(rModel.mKillSpecified), mDeterministic(
                 rModel.mDeterministic), mOutput(rModel.mOutput), mEventStartTime(rModel.mEventStartTime), mSequenceSampler(
-                rModel.mSequenceSampler), mSeqSamplerLabelSister(rModel.mSeqSamplerLabelSister), mDebug(rModel.mDebug), mTimeID(
+                rModel.mSequenceSampler), mSeqSamplerLabelSister(rModel.mSeqSamplerLabelSister), mAntitheticDraws(
+                rModel.mAntitheticDraws), mMirroredDraws(rModel.mMirroredDraws), mDebug(rModel.mDebug), mTimeID(
                 rModel.mTimeID), mVarIDs(rModel.mVarIDs), mDebugWriter(rModel.mDebugWriter), mTiLOffset(
                 rModel.mTiLOffset), mGammaShift(rModel.mGammaShift), mGammaShape(rModel.mGammaShape), mGammaScale(
                 rModel.mGammaScale), mSisterShiftWidth(rModel.mSisterShiftWidth), mMitoticModePhase2(
@@ -23,7 +27,9 @@ HeCellCycleModel::HeCellCycleModel(const HeCellCycleModel& rModel) :
                 rModel.mPhase3PD), mMitoticMode(rModel.mMitoticMode), mSeed(rModel.mSeed), mTimeDependentCycleDuration(
                 rModel.mTimeDependentCycleDuration), mPeakRateTime(rModel.mPeakRateTime), mIncreasingRateSlope(
                 rModel.mIncreasingRateSlope), mDecreasingRateSlope(rModel.mDecreasingRateSlope), mBaseGammaScale(
-                rModel.mBaseGammaScale)
+                rModel.mBaseGammaScale), mPropertyFlags(rModel.mPropertyFlags), mp_TransitType(rModel.mp_TransitType), mp_PostMitoticType(
+                rModel.mp_PostMitoticType), mp_label_Type(rModel.mp_label_Type), mpDurationSampler(rModel.mpDurationSampler), mpLikelihoodRecorder(
+                rModel.mpLikelihoodRecorder)
 {
 }
 
@@ -34,8 +40,6 @@ AbstractCellCycleModel* HeCellCycleModel::CreateCellCycleModel()
 
 void HeCellCycleModel::SetCellCycleDuration()
 {
-    RandomNumberGenerator* p_random_number_generator = RandomNumberGenerator::Instance();
-
     /**************************************
      * CELL CYCLE DURATION RANDOM VARIABLE
      *************************************/
@@ -43,7 +47,7 @@ void HeCellCycleModel::SetCellCycleDuration()
     if (!mTimeDependentCycleDuration) //Normal operation, cell cycle length stays constant
     {
         //He cell cycle length determined by shifted gamma distribution reflecting 4 hr refractory period followed by gamma pdf
-        mCellCycleDuration = mGammaShift + p_random_number_generator->GammaRandomDeviate(mGammaShape, mGammaScale);
+        mCellCycleDuration = DrawGammaCycleDuration();
     }
 
     /****
@@ -65,7 +69,7 @@ void HeCellCycleModel::SetCellCycleDuration()
                             + (mBaseGammaScale + (currTime - mPeakRateTime) * mDecreasingRateSlope)),
                     .0000000000001);
         }
-        mCellCycleDuration = mGammaShift + p_random_number_generator->GammaRandomDeviate(mGammaShape, mGammaScale);
+        mCellCycleDuration = DrawGammaCycleDuration();
     }
 
 }
@@ -81,75 +85,53 @@ void HeCellCycleModel::ResetForDivision()
 
     /*Rule logic defaults to phase 1 behaviour, checks for currentTiL > phaseBoundaries and changes
      currentPhase and subsequently mMitoticMode as appropriate*/
-    unsigned currentPhase = 1;
+    unsigned currentPhase = GetMitoticModePhase(currentTiL);
     mMitoticMode = 0;
 
-    //Check time in lineage and determine current mitotic mode phase
     /**************
-     * Phase boundary & deterministic mitotic mode rules
+     * Deterministic mitotic mode rules
      **************/
-    if (currentTiL > mMitoticModePhase2 && currentTiL < mMitoticModePhase3)
+    if (mDeterministic && currentPhase == 2)
     {
-        //if current TiL is > phase 2 boundary time, set the currentPhase appropriately
-        currentPhase = 2;
-
         //if deterministic mode is enabled, PD divisions are guaranteed unless this is an Ath5 morphant
-        if (mDeterministic)
+        mMitoticMode = 1; //0=PP;1=PD;2=DD
+        if (mPropertyFlags & CellPropertyFlags::ATH5MO) //Ath5 morphants undergo PP rather than PD divisions in 80% of cases
         {
-            mMitoticMode = 1; //0=PP;1=PD;2=DD
-            if (mpCell->HasCellProperty<Ath5Mo>()) //Ath5 morphants undergo PP rather than PD divisions in 80% of cases
+            double ath5RV = p_random_number_generator->ranf();
+            if (ath5RV <= .8)
             {
-                double ath5RV = p_random_number_generator->ranf();
-                if (ath5RV <= .8)
-                {
-                    mMitoticMode = 0;
-                }
+                mMitoticMode = 0;
             }
         }
     }
 
-    if (currentTiL > mMitoticModePhase3)
+    if (mDeterministic && currentPhase == 3)
     {
-        //if current TiL is > phase 3 boundary time, set the currentPhase appropriately
-        currentPhase = 3;
-        if (mDeterministic)
-        {
-            //if deterministic mode is enabled, DD divisions are guaranteed
-            mMitoticMode = 2;
-        }
+        //if deterministic mode is enabled, DD divisions are guaranteed
+        mMitoticMode = 2;
     }
 
     /******************************
      * MITOTIC MODE RANDOM VARIABLE
      ******************************/
-    //initialise mitoticmode random variable, set mitotic mode appropriately after comparing to mode probability matrix
-    double mitoticModeRV = p_random_number_generator->ranf(); //0-1 evenly distributed RV
+    //initialise mitoticmode random variable, set mitotic mode appropriately after comparing to phase mode probabilities
+    double mitoticModeRV = DrawMitoticModeRV(); //0-1 evenly distributed RV
 
     if (!mDeterministic)
     {
-        //construct 3x2 matrix of mode probabilities arranged by phase
-        double modeProbabilityMatrix[3][2] = { { mPhase1PP, mPhase1PD }, { mPhase2PP, mPhase2PD }, { mPhase3PP,
-                                                                                                     mPhase3PD } };
-
-        //if the RV is > currentPhasePP && <= currentPhasePD, change mMitoticMode from PP to PD
-        if (mitoticModeRV > modeProbabilityMatrix[currentPhase - 1][0]
-                && mitoticModeRV
-                        <= modeProbabilityMatrix[currentPhase - 1][0] + modeProbabilityMatrix[currentPhase - 1][1])
+        mMitoticMode = GetStochasticMitoticMode(currentPhase, mitoticModeRV);
+        if (mMitoticMode == 1 && (mPropertyFlags & CellPropertyFlags::ATH5MO)) //Ath5 morphants undergo PP rather than PD divisions in 80% of cases
         {
-            mMitoticMode = 1;
-            if (mpCell->HasCellProperty<Ath5Mo>()) //Ath5 morphants undergo PP rather than PD divisions in 80% of cases
+            double ath5RV = p_random_number_generator->ranf();
+            if (ath5RV <= .8)
             {
-                double ath5RV = p_random_number_generator->ranf();
-                if (ath5RV <= .8)
-                {
-                    mMitoticMode = 0;
-                }
+                mMitoticMode = 0;
             }
         }
-        //if the RV is > currentPhasePP + currentPhasePD, change mMitoticMode from PP to DD
-        if (mitoticModeRV > modeProbabilityMatrix[currentPhase - 1][0] + modeProbabilityMatrix[currentPhase - 1][1])
+
+        if (mpLikelihoodRecorder)
         {
-            mMitoticMode = 2;
+            mpLikelihoodRecorder->RecordDivision(currentPhase, mMitoticMode);
         }
     }
 
@@ -163,7 +145,9 @@ void HeCellCycleModel::ResetForDivision()
 
     if (mOutput)
     {
-        WriteModeEventOutput();
+        double pPP, pPD;
+        GetMitoticModeProbabilities(currentPhase, mDeterministic, pPP, pPD);
+        WriteModeEventOutput(pPP, pPD);
     }
 
     //set new cell cycle length (will be overwritten with DBL_MAX for DD divisions)
@@ -175,9 +159,8 @@ void HeCellCycleModel::ResetForDivision()
      * *************/
     if (mMitoticMode == 2)
     {
-        boost::shared_ptr<AbstractCellProperty> p_PostMitoticType =
-                mpCell->rGetCellPropertyCollection().GetCellPropertyRegistry()->Get<DifferentiatedCellProliferativeType>();
-        mpCell->SetCellProliferativeType(p_PostMitoticType);
+        mpCell->SetCellProliferativeType(mp_PostMitoticType);
+        mPropertyFlags |= CellPropertyFlags::POSTMITOTIC;
         mCellCycleDuration = DBL_MAX;
 
         if(mKillSpecified)
@@ -193,14 +176,15 @@ void HeCellCycleModel::ResetForDivision()
     //50% chance of each daughter cell from a mitosis inheriting the label
     if (mSequenceSampler)
     {
-        if (mpCell->HasCellProperty<CellLabel>())
+        if (mPropertyFlags & CellPropertyFlags::LABEL)
         {
-            (*LogFile::Instance()) << mMitoticMode;
+            (*EventOutputBuffer::Instance()) << mMitoticMode;
             double labelRV = p_random_number_generator->ranf();
             if (labelRV <= .5)
             {
                 mSeqSamplerLabelSister = true;
                 mpCell->RemoveCellProperty<CellLabel>();
+                mPropertyFlags &= ~CellPropertyFlags::LABEL;
             }
             else
             {
@@ -217,9 +201,10 @@ void HeCellCycleModel::ResetForDivision()
 
 void HeCellCycleModel::Initialise()
 {
-    boost::shared_ptr<AbstractCellProperty> p_Transit =
-            mpCell->rGetCellPropertyCollection().GetCellPropertyRegistry()->Get<TransitCellProliferativeType>();
-    mpCell->SetCellProliferativeType(p_Transit);
+    mpCell->SetCellProliferativeType(mp_TransitType);
+
+    //the only property collection scan this model makes; kept current by the model from here on
+    mPropertyFlags = CellPropertyFlags::ReadCellPropertyFlags(mpCell);
 
     if (mTiLOffset == 0) //the "regular" case, set cycle duration normally
     {
@@ -236,8 +221,6 @@ void HeCellCycleModel::Initialise()
     {
         mReadyToDivide = false;
 
-        RandomNumberGenerator* p_random_number_generator = RandomNumberGenerator::Instance();
-
         /**
          * This calculation "runs time forward" by subtracting appropriately generated cell lengths from TiLOffset
          * Ultimately c is subtracted from a final cell length calculation to give the appropriate reduced cycle length
@@ -246,11 +229,10 @@ void HeCellCycleModel::Initialise()
         double c = mTiLOffset;
         while (c > 0)
         {
-            c = c - (mGammaShift + p_random_number_generator->GammaRandomDeviate(mGammaShape, mGammaScale));
+            c = c - DrawGammaCycleDuration();
         }
 
-        mCellCycleDuration = (mGammaShift + p_random_number_generator->GammaRandomDeviate(mGammaShape, mGammaScale))
-                + c;
+        mCellCycleDuration = DrawGammaCycleDuration() + c;
     }
 
 }
@@ -265,9 +247,8 @@ void HeCellCycleModel::InitialiseDaughterCell()
 
     if (mMitoticMode == 1) //RPC becomes specified retinal neuron in asymmetric PD mitosis
     {
-        boost::shared_ptr<AbstractCellProperty> p_PostMitoticType =
-                mpCell->rGetCellPropertyCollection().GetCellPropertyRegistry()->Get<DifferentiatedCellProliferativeType>();
-        mpCell->SetCellProliferativeType(p_PostMitoticType);
+        mpCell->SetCellProliferativeType(mp_PostMitoticType);
+        mPropertyFlags |= CellPropertyFlags::POSTMITOTIC;
         mCellCycleDuration = DBL_MAX;
 
         if(mKillSpecified)
@@ -279,7 +260,7 @@ void HeCellCycleModel::InitialiseDaughterCell()
     //daughter cell's mCellCycleDuration is copied from parent; modified by a normally distributed shift if it remains proliferative
     if (mMitoticMode == 0)
     {
-        double sisterShift = p_random_number_generator->NormalRandomDeviate(0, mSisterShiftWidth); //random variable mean 0 SD 1 by default
+        double sisterShift = DrawSisterShift(); //random variable mean 0 SD 1 by default
         mCellCycleDuration = std::max(mGammaShift, mCellCycleDuration + sisterShift); // sister shift respects 4 hour refractory period
     }
 
@@ -299,14 +280,14 @@ void HeCellCycleModel::InitialiseDaughterCell()
     {
         if (mSeqSamplerLabelSister)
         {
-            boost::shared_ptr<AbstractCellProperty> p_label_type =
-                    mpCell->rGetCellPropertyCollection().GetCellPropertyRegistry()->Get<CellLabel>();
-            mpCell->AddCellProperty(p_label_type);
+            mpCell->AddCellProperty(mp_label_Type);
+            mPropertyFlags |= CellPropertyFlags::LABEL;
             mSeqSamplerLabelSister = false;
         }
-        else
+        else if (mPropertyFlags & CellPropertyFlags::LABEL)
         {
             mpCell->RemoveCellProperty<CellLabel>();
+            mPropertyFlags &= ~CellPropertyFlags::LABEL;
         }
     }
 
@@ -370,20 +351,44 @@ void HeCellCycleModel::EnableModeEventOutput(double eventStart, unsigned seed)
     mSeed = seed;
 }
 
-void HeCellCycleModel::WriteModeEventOutput()
+void HeCellCycleModel::WriteModeEventOutput(double pPP, double pPD)
 {
     double currentTime = SimulationTime::Instance()->GetTime() + mEventStartTime;
     CellPtr currentCell = GetCell();
     double currentCellID = (double) currentCell->GetCellId();
-    (*LogFile::Instance()) << currentTime << "\t" << mSeed << "\t" << currentCellID << "\t" << mMitoticMode << "\n";
+    (*EventOutputBuffer::Instance()) << currentTime << "\t" << mSeed << "\t" << currentCellID << "\t" << mMitoticMode << "\t"
+            << pPP << "\t" << pPD << "\t" << 1.0 - pPP - pPD << "\n";
+}
+
+void HeCellCycleModel::EnableFastDurationSampler(boost::shared_ptr<CycleDurationSampler> p_sampler, bool tabulateGamma)
+{
+    mpDurationSampler = p_sampler;
+    if (tabulateGamma)
+    {
+        mpDurationSampler->SetGammaTable(mGammaShape, mGammaScale);
+    }
+}
+
+void HeCellCycleModel::EnableAntitheticDraws(bool mirrored)
+{
+    mAntitheticDraws = true;
+    mMirroredDraws = mirrored;
+}
+
+void HeCellCycleModel::EnableLikelihoodRecorder(boost::shared_ptr<HeModeLikelihoodRecorder> p_recorder)
+{
+    mpLikelihoodRecorder = p_recorder;
 }
 
 void HeCellCycleModel::EnableSequenceSampler()
 {
     mSequenceSampler = true;
-    boost::shared_ptr<AbstractCellProperty> p_label_type =
-            mpCell->rGetCellPropertyCollection().GetCellPropertyRegistry()->Get<CellLabel>();
-    mpCell->AddCellProperty(p_label_type);
+    //the founder may not have been given its cell yet; if so, the simulator labels it & Initialise() reads the label
+    if (mpCell)
+    {
+        mpCell->AddCellProperty(mp_label_Type);
+        mPropertyFlags |= CellPropertyFlags::LABEL;
+    }
 }
 
 void HeCellCycleModel::PassDebugWriter(boost::shared_ptr<ColumnDataWriter> debugWriter, int timeID,
@@ -420,7 +425,7 @@ void HeCellCycleModel::WriteDebugData(double currentTiL, unsigned phase, double
     double currentTime = SimulationTime::Instance()->GetTime();
     double currentCellID = mpCell->GetCellId();
     unsigned label = 0;
-    if (mpCell->HasCellProperty<CellLabel>()) label = 1;
+    if (mPropertyFlags & CellPropertyFlags::LABEL) label = 1;
 
     mDebugWriter->PutVariable(mTimeID, currentTime);
     mDebugWriter->PutVariable(mVarIDs[0], currentCellID);
@@ -9,8 +9,13 @@
 #include "SmartPointers.hpp"
 #include "ColumnDataWriter.hpp"
 #include "LogFile.hpp"
+#include "EventOutputBuffer.hpp"
 #include "CellLabel.hpp"
 #include "HeAth5Mo.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "CellPropertyFlags.hpp"
+#include "CycleDurationSampler.hpp"
+#include "HeModeLikelihoodRecorder.hpp"
 
 /***********************************
  * HE CELL CYCLE MODEL
@@ -26,13 +31,27 @@
  * Enable deterministic model alternative with EnableDeterministicMode(<params>);
  *
  * 2 per-model-event output modes:
- * EnableModeEventOutput() enables mitotic mode event logging-all cells will write to the singleton log file
+ * EnableModeEventOutput() enables mitotic mode event logging-all cells will write to the worker's EventOutputBuffer,
+ * merged into the singleton log file by the simulator
  * EnableModelDebugOutput() enables more detailed debug output, each seed will have its own file written to
  * by a ColumnDataWriter passed to it from the test
  * (eg. by the SetupDebugOutput helper function in the project simulator)
  *
  * 1 mitotic-event-sequence sampler (only samples one "path" through the lineage):
- * EnableSequenceSampler() - one "sequence" of progenitors writes mitotic event type to a string in the singleton log file
+ * EnableSequenceSampler() - one "sequence" of progenitors writes mitotic event type to a string in the EventOutputBuffer
+ *
+ * EnableFastDurationSampler() draws cycle durations & sister shifts from a shared CycleDurationSampler
+ * instead of the RandomNumberGenerator singleton
+ *
+ * EnableAntitheticDraws() runs the lineage as one member of an antithetic pair: both members draw cycle durations by
+ * gamma inversion, and the mirrored member uses 1-U for mitotic mode RVs & cycle duration quantiles and negated
+ * sister shifts. The pair replays the same seed, so its draws match until the lineages diverge.
+ *
+ * EnableLikelihoodRecorder() records each stochastic mitotic mode decision in a recorder shared by the lineage,
+ * for likelihood-ratio reweighting to other phase probabilities (see HeModeLikelihoodRecorder.hpp)
+ *
+ * Division-time property checks (label, Ath5Mo, postmitotic) use the model's cached CellPropertyFlags and
+ * registry property pointers, resolved once per model rather than per division.
  *
  ************************************/
 
@@ -62,7 +81,6 @@ private:
     }
 
     //Private write functions for models
-    void WriteModeEventOutput();
     void WriteDebugData(double currTiL, unsigned phase, double percentile);
 
 protected:
@@ -73,6 +91,8 @@ protected:
     double mEventStartTime;
     bool mSequenceSampler;
     bool mSeqSamplerLabelSister;
+    bool mAntitheticDraws;
+    bool mMirroredDraws;
     //debug writer stuff
     bool mDebug;
     int mTimeID;
@@ -100,6 +120,15 @@ protected:
     double mIncreasingRateSlope;
     double mDecreasingRateSlope;
     double mBaseGammaScale;
+    //cached cell property flags & registry properties (see CellPropertyFlags.hpp)
+    unsigned mPropertyFlags;
+    boost::shared_ptr<AbstractCellProperty> mp_TransitType;
+    boost::shared_ptr<AbstractCellProperty> mp_PostMitoticType;
+    boost::shared_ptr<AbstractCellProperty> mp_label_Type;
+    //optional buffered cycle duration stream, shared by all models in a simulation
+    boost::shared_ptr<CycleDurationSampler> mpDurationSampler;
+    //optional record of the lineage's stochastic mitotic mode decisions, shared by all models in a lineage
+    boost::shared_ptr<HeModeLikelihoodRecorder> mpLikelihoodRecorder;
 
     /**
      * Protected copy-constructor for use by CreateCellCycleModel().
@@ -117,6 +146,142 @@ protected:
      */
     HeCellCycleModel(const HeCellCycleModel& rModel);
 
+    /**
+     * Mode event write function, shared with the policy kernel in HePolicyCellCycleModel.hpp
+     * Rows carry the sampled mode and the probabilities it was drawn from, for expected-rate estimates
+     *
+     * @param pPP the division's probability of PP
+     * @param pPD the division's probability of PD
+     */
+    void WriteModeEventOutput(double pPP, double pPD);
+
+    /**
+     * Cycle duration draws, from the duration sampler if one is enabled, otherwise the RandomNumberGenerator
+     *
+     * @return a shifted gamma cell cycle duration
+     */
+    double DrawGammaCycleDuration()
+    {
+        if (mAntitheticDraws) //inversion, so that mirrored uniforms give mirrored quantiles
+        {
+            double quantileRV = mpDurationSampler ? mpDurationSampler->Uniform() : RandomNumberGenerator::Instance()->ranf();
+            if (mMirroredDraws) quantileRV = 1.0 - quantileRV;
+            if (mpDurationSampler)
+            {
+                return mGammaShift + mpDurationSampler->GammaQuantile(mGammaShape, mGammaScale, quantileRV);
+            }
+            return mGammaShift + CycleDurationSampler::ExactGammaQuantile(mGammaShape, mGammaScale, quantileRV);
+        }
+        if (mpDurationSampler)
+        {
+            return mGammaShift + mpDurationSampler->Gamma(mGammaShape, mGammaScale);
+        }
+        return mGammaShift + RandomNumberGenerator::Instance()->GammaRandomDeviate(mGammaShape, mGammaScale);
+    }
+
+    /**
+     * @return a normally distributed sister cycle length shift, mean 0, SD mSisterShiftWidth
+     */
+    double DrawSisterShift()
+    {
+        double sisterShift;
+        if (mpDurationSampler)
+        {
+            sisterShift = mpDurationSampler->Normal(0, mSisterShiftWidth);
+        }
+        else
+        {
+            sisterShift = RandomNumberGenerator::Instance()->NormalRandomDeviate(0, mSisterShiftWidth);
+        }
+        return mMirroredDraws ? -sisterShift : sisterShift;
+    }
+
+    /**
+     * @return the 0-1 evenly distributed mitotic mode RV, mirrored in the mirrored member of an antithetic pair
+     */
+    double DrawMitoticModeRV()
+    {
+        double mitoticModeRV = RandomNumberGenerator::Instance()->ranf();
+        return mMirroredDraws ? 1.0 - mitoticModeRV : mitoticModeRV;
+    }
+
+    /**
+     * Division rule helpers shared by ResetForDivision() and HePolicyCellCycleModel.
+     * Defined here so that the policy kernels can inline them.
+     *
+     * @param currentTiL the dividing cell's current time in lineage
+     * @return the mitotic mode phase (1-3) in effect at currentTiL
+     */
+    unsigned GetMitoticModePhase(double currentTiL) const
+    {
+        unsigned phase = 1;
+        if (currentTiL > mMitoticModePhase2 && currentTiL < mMitoticModePhase3) phase = 2;
+        if (currentTiL > mMitoticModePhase3) phase = 3;
+        return phase;
+    }
+
+    /**
+     * @param phase the current mitotic mode phase (1-3)
+     * @param deterministic whether the deterministic mode rules apply
+     * @param rPP set to the probability of PP, after any Ath5 morphant adjustment
+     * @param rPD set to the probability of PD, after any Ath5 morphant adjustment
+     */
+    void GetMitoticModeProbabilities(unsigned phase, bool deterministic, double& rPP, double& rPD) const
+    {
+        if (deterministic)
+        {
+            rPP = (phase == 1) ? 1.0 : 0.0;
+            rPD = (phase == 2) ? 1.0 : 0.0;
+        }
+        else
+        {
+            rPP = mPhase1PP;
+            rPD = mPhase1PD;
+            if (phase == 2)
+            {
+                rPP = mPhase2PP;
+                rPD = mPhase2PD;
+            }
+            else if (phase == 3)
+            {
+                rPP = mPhase3PP;
+                rPD = mPhase3PD;
+            }
+        }
+
+        if (mPropertyFlags & CellPropertyFlags::ATH5MO) //Ath5 morphants undergo PP rather than PD divisions in 80% of cases
+        {
+            rPP += .8 * rPD;
+            rPD *= .2;
+        }
+    }
+
+    /**
+     * @param phase the current mitotic mode phase (1-3)
+     * @param mitoticModeRV a 0-1 evenly distributed RV
+     * @return the stochastic model's mitotic mode for this RV (0=PP;1=PD;2=DD), before any Ath5 morphant adjustment
+     */
+    unsigned GetStochasticMitoticMode(unsigned phase, double mitoticModeRV) const
+    {
+        double pPP = mPhase1PP;
+        double pPD = mPhase1PD;
+        if (phase == 2)
+        {
+            pPP = mPhase2PP;
+            pPD = mPhase2PD;
+        }
+        else if (phase == 3)
+        {
+            pPP = mPhase3PP;
+            pPD = mPhase3PD;
+        }
+
+        //if the RV is > currentPhasePP && <= currentPhasePD, PD; if the RV is > currentPhasePP + currentPhasePD, DD
+        if (mitoticModeRV > pPP + pPD) return 2;
+        if (mitoticModeRV > pPP) return 1;
+        return 0;
+    }
+
 public:
 
     /**
@@ -177,10 +342,20 @@ public:
     void EnableKillSpecified();
 
     //Functions to enable per-cell mitotic mode logging for mode rate & sequence sampling fixtures
-    //Uses singleton logfile
+    //Uses the worker's EventOutputBuffer (see EventOutputBuffer.hpp)
     void EnableModeEventOutput(double eventStart, unsigned seed);
     void EnableSequenceSampler();
 
+    //Function to draw cycle durations from a buffered sampler shared by the simulation's models (see CycleDurationSampler.hpp)
+    //tabulateGamma precomputes the sampler's gamma table for the model's current parameters; call after parameter setup
+    void EnableFastDurationSampler(boost::shared_ptr<CycleDurationSampler> p_sampler, bool tabulateGamma = false);
+
+    //Function to run the lineage as one member of an antithetic pair; mirrored = true for the second member
+    void EnableAntitheticDraws(bool mirrored);
+
+    //Function to record the lineage's stochastic mitotic mode decisions for likelihood-ratio reweighting
+    void EnableLikelihoodRecorder(boost::shared_ptr<HeModeLikelihoodRecorder> p_recorder);
+
     //More detailed debug output. Needs a ColumnDataWriter passed to it
     //Only declare ColumnDataWriter directory, filename, etc; do not set up otherwise
     //Use PassDebugWriter if the writer is already enabled elsewhere (ie. in a Wan stem cell cycle model)
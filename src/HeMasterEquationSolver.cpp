@@ -0,0 +1,390 @@
+#include "HeMasterEquationSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <boost/math/special_functions/erf.hpp>
+#include <boost/math/special_functions/gamma.hpp>
+
+#include "Exception.hpp"
+#include "DiscreteFourierTransform.hpp"
+
+namespace
+{
+    //cycle length pmfs are truncated once the remaining probability falls below this
+    const double LIFETIME_TAIL = 1e-10;
+    //sister shifts beyond this many standard deviations are dropped
+    const double SISTER_SHIFT_RANGE = 6.0;
+    //sister pair probabilities below this are dropped from the edges of each parent cycle's band
+    const double SISTER_BAND_TAIL = 1e-12;
+    //quadrature points per timestep for the parent cycle when discretising the PP sister pair
+    const unsigned SISTER_QUADRATURE = 8;
+    //the founder's forward run is resolved on a grid this much finer than the solver timestep
+    const unsigned FORWARD_RUN_REFINEMENT = 8;
+    //tolerance when placing times on the timestep grid
+    const double GRID_TOLERANCE = 1e-9;
+}
+
+HeMasterEquationSolver::HeMasterEquationSolver(double dt, unsigned maxCount) :
+        mDt(dt), mTransformLength(1), mMitoticModePhase2(), mMitoticModePhase3(), mPhase1PP(), mPhase1PD(), mPhase2PP(), mPhase2PD(), mPhase3PP(), mPhase3PD(), mGammaShift(), mGammaShape(), mGammaScale(), mSisterShiftWidth(), mAth5Founder(
+                false), mLifetimePmf(), mSisterStart(), mSisterPmf(), mSisterLifetimePmf(), mCountDistribution(), mModeRates(), mRateStartHour(
+                0.0)
+{
+    if (dt <= 0)
+    {
+        EXCEPTION("Solver timestep must be > 0");
+    }
+    while (mTransformLength < maxCount + 1)
+    {
+        mTransformLength <<= 1;
+    }
+    SetModelParameters();
+}
+
+void HeMasterEquationSolver::SetModelParameters(double mitoticModePhase2, double mitoticModePhase3, double phase1PP,
+                                                double phase1PD, double phase2PP, double phase2PD, double phase3PP,
+                                                double phase3PD, double gammaShift, double gammaShape, double gammaScale,
+                                                double sisterShift)
+{
+    mMitoticModePhase2 = mitoticModePhase2;
+    mMitoticModePhase3 = mitoticModePhase3;
+    mPhase1PP = phase1PP;
+    mPhase1PD = phase1PD;
+    mPhase2PP = phase2PP;
+    mPhase2PD = phase2PD;
+    mPhase3PP = phase3PP;
+    mPhase3PD = phase3PD;
+    mGammaShift = gammaShift;
+    mGammaShape = gammaShape;
+    mGammaScale = gammaScale;
+    mSisterShiftWidth = sisterShift;
+    SetupLifetimePmfs();
+}
+
+void HeMasterEquationSolver::SetAth5Founder(bool ath5Founder)
+{
+    mAth5Founder = ath5Founder;
+}
+
+double HeMasterEquationSolver::GetCycleCdf(double duration) const
+{
+    if (duration <= mGammaShift)
+    {
+        return 0.0;
+    }
+    return boost::math::gamma_p(mGammaShape, (duration - mGammaShift) / mGammaScale);
+}
+
+void HeMasterEquationSolver::SetupLifetimePmfs()
+{
+    //a cell divides at the first step at which its age reaches the drawn duration: cycle = ceil(duration/dt) steps
+    mLifetimePmf.assign(1, 0.0);
+    double previousCdf = 0.0;
+    for (unsigned k = 1; previousCdf < 1.0 - LIFETIME_TAIL; k++)
+    {
+        double cdf = GetCycleCdf(k * mDt);
+        mLifetimePmf.push_back(cdf - previousCdf);
+        previousCdf = cdf;
+    }
+
+    /**
+     * PP sisters: the daughter's cycle is max(shift, parent cycle + N(0, sisterShift)).
+     * Integrate the parent cycle across each timestep by midpoint quadrature; given the parent cycle x,
+     * P(sister cycle <= y) = 0 below the shift, Phi((y - x)/sisterShift) above it.
+     */
+    unsigned maxLifetime = mLifetimePmf.size() - 1;
+    unsigned shiftRange = (unsigned) ceil(SISTER_SHIFT_RANGE * mSisterShiftWidth / mDt);
+    mSisterStart.assign(maxLifetime + 1, 0);
+    mSisterPmf.assign(maxLifetime + 1, std::vector<double>());
+    mSisterLifetimePmf.assign(maxLifetime + shiftRange + 2, 0.0);
+
+    for (unsigned j = 1; j <= maxLifetime; j++)
+    {
+        if (mLifetimePmf[j] <= 0.0) continue;
+
+        unsigned lowest = (j > shiftRange + 1) ? j - shiftRange - 1 : 1;
+        unsigned highest = j + shiftRange + 1;
+        mSisterStart[j] = lowest;
+        mSisterPmf[j].assign(highest - lowest + 1, 0.0);
+
+        for (unsigned point = 0; point < SISTER_QUADRATURE; point++)
+        {
+            double lower = (j - 1 + (double) point / SISTER_QUADRATURE) * mDt;
+            double upper = (j - 1 + (double) (point + 1) / SISTER_QUADRATURE) * mDt;
+            double weight = GetCycleCdf(upper) - GetCycleCdf(lower);
+            if (weight <= 0.0) continue;
+            double parentCycle = 0.5 * (lower + upper);
+
+            double previousSisterCdf = 0.0;
+            for (unsigned k = lowest; k <= highest; k++)
+            {
+                double y = k * mDt;
+                double sisterCdf = 0.0;
+                if (y >= mGammaShift)
+                {
+                    if (mSisterShiftWidth > 0)
+                    {
+                        sisterCdf = 0.5 * boost::math::erfc((parentCycle - y) / (mSisterShiftWidth * M_SQRT2));
+                    }
+                    else
+                    {
+                        sisterCdf = (parentCycle <= y) ? 1.0 : 0.0;
+                    }
+                }
+                double pSister = weight * (sisterCdf - previousSisterCdf);
+                mSisterPmf[j][k - lowest] += pSister;
+                mSisterLifetimePmf[k] += pSister;
+                previousSisterCdf = sisterCdf;
+            }
+        }
+
+        //trim negligible band edges, which dominate the cost of the PP sum
+        std::vector<double>& r_band = mSisterPmf[j];
+        unsigned first = 0;
+        while (first + 1 < r_band.size() && r_band[first] < SISTER_BAND_TAIL) first++;
+        unsigned last = r_band.size() - 1;
+        while (last > first && r_band[last] < SISTER_BAND_TAIL) last--;
+        r_band = std::vector<double>(r_band.begin() + first, r_band.begin() + last + 1);
+        mSisterStart[j] += first;
+    }
+}
+
+void HeMasterEquationSolver::GetModeProbabilities(double currentTiL, double& rPP, double& rPD) const
+{
+    //phase rules as HeCellCycleModel::GetMitoticModePhase()
+    rPP = mPhase1PP;
+    rPD = mPhase1PD;
+    if (currentTiL > mMitoticModePhase2 && currentTiL < mMitoticModePhase3)
+    {
+        rPP = mPhase2PP;
+        rPD = mPhase2PD;
+    }
+    if (currentTiL > mMitoticModePhase3)
+    {
+        rPP = mPhase3PP;
+        rPD = mPhase3PD;
+    }
+
+    //Ath5 morphants undergo PP rather than PD divisions in 80% of cases
+    if (mAth5Founder)
+    {
+        rPP += .8 * rPD;
+        rPD *= .2;
+    }
+}
+
+std::vector<double> HeMasterEquationSolver::GetFirstDivisionPmf(double tiLOffset) const
+{
+    if (tiLOffset <= 0.0)
+    {
+        return std::vector<double>(1, 1.0);
+    }
+
+    /**
+     * Forward run on a fine grid: renewal epochs S accumulate while S < tiLOffset; the first epoch at or past
+     * tiLOffset leaves c = tiLOffset - S, and the first cycle is a fresh draw + c
+     */
+    double fineDt = mDt / FORWARD_RUN_REFINEMENT;
+    std::vector<double> finePmf(1, 0.0);
+    double previousCdf = 0.0;
+    for (unsigned k = 1; previousCdf < 1.0 - LIFETIME_TAIL; k++)
+    {
+        double cdf = GetCycleCdf(k * fineDt);
+        finePmf.push_back(cdf - previousCdf);
+        previousCdf = cdf;
+    }
+    unsigned maxFineLifetime = finePmf.size() - 1;
+
+    //epochs before the offset: s < offsetSteps
+    unsigned offsetSteps = (unsigned) ceil(tiLOffset / fineDt - GRID_TOLERANCE);
+    std::vector<double> renewal(offsetSteps, 0.0);
+    renewal[0] = 1.0;
+    for (unsigned s = 1; s < offsetSteps; s++)
+    {
+        for (unsigned k = 1; k <= std::min(s, maxFineLifetime); k++)
+        {
+            renewal[s] += renewal[s - k] * finePmf[k];
+        }
+    }
+
+    //first epoch at or past the offset
+    std::vector<double> passage(maxFineLifetime + 1, 0.0);
+    for (unsigned s = 0; s < offsetSteps; s++)
+    {
+        if (renewal[s] <= 0.0) continue;
+        for (unsigned k = offsetSteps - s; k <= maxFineLifetime; k++)
+        {
+            passage[s + k - offsetSteps] += renewal[s] * finePmf[k];
+        }
+    }
+
+    //first cycle = fresh draw - overshoot; cycles that are already complete divide at the first step
+    std::vector<double> firstDivision;
+    double overshootBase = offsetSteps * fineDt - tiLOffset;
+    for (unsigned m = 0; m <= maxFineLifetime; m++)
+    {
+        if (passage[m] <= 0.0) continue;
+        double overshoot = overshootBase + m * fineDt;
+        for (unsigned k = 1; k <= maxFineLifetime; k++)
+        {
+            if (finePmf[k] <= 0.0) continue;
+            double duration = k * fineDt - overshoot;
+            unsigned step = (duration <= 0.0) ? 0 : (unsigned) ceil(duration / mDt - GRID_TOLERANCE);
+            if (step >= firstDivision.size()) firstDivision.resize(step + 1, 0.0);
+            firstDivision[step] += passage[m] * finePmf[k];
+        }
+    }
+
+    return firstDivision;
+}
+
+void HeMasterEquationSolver::ResetRates(double startHour, double endHour)
+{
+    mRateStartHour = floor(startHour);
+    unsigned numHours = (unsigned) ceil(endHour - mRateStartHour) + 1;
+    mModeRates.assign(numHours, std::vector<double>(3, 0.0));
+}
+
+void HeMasterEquationSolver::SolveLineage(double tiLOffset, double simulationTime, double eventStartTime,
+                                          double weight, std::vector<std::complex<double> >& rPGF)
+{
+    unsigned numPoints = rPGF.size();
+    unsigned endStep = (unsigned) floor(simulationTime / mDt + GRID_TOLERANCE);
+    unsigned maxLifetime = mSisterLifetimePmf.size() - 1;
+
+    std::vector<double> pPP(endStep + 1), pPD(endStep + 1);
+    for (unsigned n = 0; n <= endStep; n++)
+    {
+        GetModeProbabilities(tiLOffset + n * mDt, pPP[n], pPD[n]);
+    }
+
+    //clone PGF of a cell dividing at step n; cells dividing after the end step are counted as themselves
+    std::vector<std::complex<double> > marks = GetPGFPoints(mTransformLength);
+    std::vector<std::vector<std::complex<double> > > clone(endStep + maxLifetime + 1, marks);
+
+    std::vector<std::complex<double> > pdSum(numPoints), ppSum(numPoints), sisterSum(numPoints);
+    for (unsigned n = endStep + 1; n-- > 0;)
+    {
+        std::fill(pdSum.begin(), pdSum.end(), 0.0);
+        std::fill(ppSum.begin(), ppSum.end(), 0.0);
+        for (unsigned k = 1; k < mLifetimePmf.size(); k++)
+        {
+            if (mLifetimePmf[k] <= 0.0) continue;
+            const std::vector<std::complex<double> >& r_parent = clone[n + k];
+
+            if (pPD[n] > 0)
+            {
+                for (unsigned j = 0; j < numPoints; j++)
+                {
+                    pdSum[j] += mLifetimePmf[k] * r_parent[j];
+                }
+            }
+
+            if (pPP[n] > 0)
+            {
+                std::fill(sisterSum.begin(), sisterSum.end(), 0.0);
+                const std::vector<double>& r_sister = mSisterPmf[k];
+                for (unsigned i = 0; i < r_sister.size(); i++)
+                {
+                    if (r_sister[i] <= 0.0) continue;
+                    const std::vector<std::complex<double> >& r_sisterClone = clone[n + mSisterStart[k] + i];
+                    for (unsigned j = 0; j < numPoints; j++)
+                    {
+                        sisterSum[j] += r_sister[i] * r_sisterClone[j];
+                    }
+                }
+                for (unsigned j = 0; j < numPoints; j++)
+                {
+                    ppSum[j] += r_parent[j] * sisterSum[j];
+                }
+            }
+        }
+
+        double pDD = 1.0 - pPP[n] - pPD[n];
+        for (unsigned j = 0; j < numPoints; j++)
+        {
+            clone[n][j] = pPP[n] * ppSum[j] + pPD[n] * marks[j] * pdSum[j] + pDD * marks[j] * marks[j];
+        }
+    }
+
+    std::vector<double> firstDivision = GetFirstDivisionPmf(tiLOffset);
+    for (unsigned n = 0; n < firstDivision.size(); n++)
+    {
+        const std::vector<std::complex<double> >& r_founder = (n <= endStep) ? clone[n] : marks;
+        for (unsigned j = 0; j < numPoints; j++)
+        {
+            rPGF[j] += weight * firstDivision[n] * r_founder[j];
+        }
+    }
+
+    //expected divisions at each step: founder's first division + cycles begun by earlier PP & PD divisions
+    std::vector<double> divisions(endStep + 1, 0.0);
+    for (unsigned n = 0; n <= endStep; n++)
+    {
+        if (n < firstDivision.size()) divisions[n] = firstDivision[n];
+        for (unsigned k = 1; k <= std::min(n, maxLifetime); k++)
+        {
+            unsigned m = n - k;
+            double parentPmf = (k < mLifetimePmf.size()) ? mLifetimePmf[k] : 0.0;
+            divisions[n] += divisions[m] * ((pPP[m] + pPD[m]) * parentPmf + pPP[m] * mSisterLifetimePmf[k]);
+        }
+
+        unsigned hour = (unsigned) floor(eventStartTime + n * mDt - mRateStartHour + GRID_TOLERANCE);
+        mModeRates[hour][0] += weight * divisions[n] * pPP[n];
+        mModeRates[hour][1] += weight * divisions[n] * pPD[n];
+        mModeRates[hour][2] += weight * divisions[n] * (1.0 - pPP[n] - pPD[n]);
+    }
+}
+
+void HeMasterEquationSolver::SolveHeFixture(double inductionTime, double earliestLineageStartTime,
+                                            double latestLineageStartTime, double endTime, unsigned startTimeNodes)
+{
+    if (startTimeNodes == 0)
+    {
+        EXCEPTION("At least one lineage start time node is required");
+    }
+
+    ResetRates(std::min(inductionTime, earliestLineageStartTime), endTime);
+    std::vector<std::complex<double> > pgf(GetPGFPoints(mTransformLength).size(), 0.0);
+
+    double nodeWidth = (latestLineageStartTime - earliestLineageStartTime) / startTimeNodes;
+    for (unsigned node = 0; node < startTimeNodes; node++)
+    {
+        double lineageStartTime = earliestLineageStartTime + (node + 0.5) * nodeWidth;
+
+        //as HeSimulator fixture 0: lineages starting before induction are induced with TiL > 0
+        if (lineageStartTime < inductionTime)
+        {
+            SolveLineage(inductionTime - lineageStartTime, endTime - inductionTime, inductionTime,
+                         1.0 / startTimeNodes, pgf);
+        }
+        else
+        {
+            SolveLineage(0.0, endTime - lineageStartTime, lineageStartTime, 1.0 / startTimeNodes, pgf);
+        }
+    }
+
+    mCountDistribution = InvertPGF(pgf, mTransformLength);
+}
+
+void HeMasterEquationSolver::SolveValidationFixture(double inductionTime, double endTime)
+{
+    ResetRates(0.0, endTime);
+    std::vector<std::complex<double> > pgf(GetPGFPoints(mTransformLength).size(), 0.0);
+    SolveLineage(inductionTime, endTime, 0.0, 1.0, pgf);
+    mCountDistribution = InvertPGF(pgf, mTransformLength);
+}
+
+const std::vector<double>& HeMasterEquationSolver::rGetCountDistribution() const
+{
+    return mCountDistribution;
+}
+
+const std::vector<std::vector<double> >& HeMasterEquationSolver::rGetModeRates() const
+{
+    return mModeRates;
+}
+
+double HeMasterEquationSolver::GetRateStartHour() const
+{
+    return mRateStartHour;
+}
@@ -0,0 +1,154 @@
+#ifndef HEMASTEREQUATIONSOLVER_HPP_
+#define HEMASTEREQUATIONSOLVER_HPP_
+
+#include <complex>
+#include <vector>
+
+/***********************************
+ * HE MASTER EQUATION SOLVER
+ * Clone-size distributions and mitotic mode rate curves for the stochastic HeCellCycleModel lineage, without Monte Carlo.
+ *
+ * USE: Construct with a solver timestep and the largest count to resolve, set the same parameters as
+ * HeCellCycleModel::SetModelParameters() (phase 3 boundary as an absolute TiL, as HeCellCycleModel), then solve
+ * HeSimulator's fixture 0 (uniform lineage start times) or fixture 2 (fixed TiL) and read the results.
+ *
+ * Stochastic mode's mitotic mode probabilities depend only on the dividing cell's TiL, so on a timestep grid
+ * the PGF of the clone descended from a cell dividing at step n obeys the backward equation
+ *
+ * F_n(s) = pPP(n) sum_(j,k) q(j,k) F_(n+j) F_(n+k) + pPD(n) s sum_j p(j) F_(n+j) + pDD(n) s^2,   F_n = s for n > end
+ *
+ * where p is the shifted gamma cycle length pmf and q the joint pmf of the PP parent's cycle and its sister's
+ * shifted copy, max(shift, cycle + N(0, sisterShift)). F is evaluated at the roots of unity and inverted by FFT;
+ * the solve methods throw if more than 1e-6 of the probability lies beyond the count range.
+ * The founder's first division follows the model's forward run through its TiL offset; fixture 0 is a mixture over
+ * lineage start times. Expected PP/PD/DD events per lineage per hour (hpf bins) come from the matching forward
+ * renewal equation for the expected number of divisions at each step.
+ *
+ * Cycle lengths are rounded up to whole solver steps; results converge to the simulator's as dt approaches its 0.05 h.
+ * The deterministic mode's per-cell phase boundary random walk is not Markov in TiL and is not solved here.
+ ************************************/
+
+class HeMasterEquationSolver
+{
+private:
+    double mDt;
+    unsigned mTransformLength;
+    //model parameters
+    double mMitoticModePhase2;
+    double mMitoticModePhase3;
+    double mPhase1PP;
+    double mPhase1PD;
+    double mPhase2PP;
+    double mPhase2PD;
+    double mPhase3PP;
+    double mPhase3PD;
+    double mGammaShift;
+    double mGammaShape;
+    double mGammaScale;
+    double mSisterShiftWidth;
+    bool mAth5Founder;
+    //cycle length in timesteps: mLifetimePmf[k] = P(cycle = k steps), k >= 1
+    std::vector<double> mLifetimePmf;
+    //PP sister cycle lengths: mSisterPmf[j][i] = P(parent cycle = j, sister cycle = mSisterStart[j] + i)
+    std::vector<unsigned> mSisterStart;
+    std::vector<std::vector<double> > mSisterPmf;
+    //sister cycle marginal, for the expected division renewal
+    std::vector<double> mSisterLifetimePmf;
+    //results
+    std::vector<double> mCountDistribution;
+    std::vector<std::vector<double> > mModeRates;
+    double mRateStartHour;
+
+    //Discretise the shifted gamma cycle and the PP sister pair onto the timestep grid
+    void SetupLifetimePmfs();
+
+    /** @return P(shifted gamma cycle <= duration) */
+    double GetCycleCdf(double duration) const;
+
+    /**
+     * @param currentTiL the dividing cell's time in lineage
+     * @param rPP set to P(PP) at currentTiL, after any Ath5 morphant adjustment
+     * @param rPD set to P(PD) at currentTiL
+     */
+    void GetModeProbabilities(double currentTiL, double& rPP, double& rPD) const;
+
+    /**
+     * The founder's first division step. Founders with a TiL offset have their cycle forward-run through the offset,
+     * as HeCellCycleModel::Initialise(); founders at TiL 0 divide immediately.
+     *
+     * @param tiLOffset the founder's TiL at simulation start
+     * @return P(first division at step n)
+     */
+    std::vector<double> GetFirstDivisionPmf(double tiLOffset) const;
+
+    /**
+     * Solve one lineage, accumulating its weighted count PGF and mode events.
+     *
+     * @param tiLOffset the founder's TiL at simulation start
+     * @param simulationTime simulation length (h)
+     * @param eventStartTime time added to simulation time for event output (hpf)
+     * @param weight the lineage's probability in the fixture's mixture
+     * @param rPGF the count PGF at GetPGFPoints(), added to
+     */
+    void SolveLineage(double tiLOffset, double simulationTime, double eventStartTime, double weight,
+                      std::vector<std::complex<double> >& rPGF);
+
+    /** Size the rate curves to cover events between startHour and endHour */
+    void ResetRates(double startHour, double endHour);
+
+public:
+
+    /**
+     * Constructor, with HeCellCycleModel's default parameters.
+     *
+     * @param dt solver timestep (h); HeSimulator uses 0.05 h
+     * @param maxCount largest count resolved; the count range is rounded up to a power of 2
+     */
+    HeMasterEquationSolver(double dt = 0.25, unsigned maxCount = 255);
+
+    /**
+     * Model parameters, as HeCellCycleModel::SetModelParameters() without the TiL offset, which the fixtures set
+     */
+    void SetModelParameters(double mitoticModePhase2 = 8, double mitoticModePhase3 = 15, double phase1PP = 1,
+                            double phase1PD = 0, double phase2PP = .2, double phase2PD = .4, double phase3PP = .2,
+                            double phase3PD = 0, double gammaShift = 4, double gammaShape = 2, double gammaScale = 1,
+                            double sisterShift = 1);
+
+    /**
+     * @param ath5Founder whether the lineage carries the Ath5 morpholino (PD divisions become PP 80% of the time)
+     */
+    void SetAth5Founder(bool ath5Founder);
+
+    /**
+     * HeSimulator fixture 0: lineage start times evenly distributed between the earliest and latest start times,
+     * integrated by the midpoint rule.
+     *
+     * @param inductionTime (hpf)
+     * @param earliestLineageStartTime (hpf)
+     * @param latestLineageStartTime (hpf)
+     * @param endTime (hpf)
+     * @param startTimeNodes number of lineage start time nodes
+     */
+    void SolveHeFixture(double inductionTime, double earliestLineageStartTime, double latestLineageStartTime,
+                        double endTime, unsigned startTimeNodes = 32);
+
+    /**
+     * HeSimulator fixture 2: all founders start with TiL = inductionTime. HeSimulator writes no events for this
+     * fixture; rates are reported against simulation time.
+     *
+     * @param inductionTime founder TiL (h)
+     * @param endTime simulation length (h)
+     */
+    void SolveValidationFixture(double inductionTime, double endTime);
+
+    /** @return P(count = m) for m = 0 ... count range - 1, from the last fixture solved */
+    const std::vector<double>& rGetCountDistribution() const;
+
+    /** @return expected PP, PD, DD events per lineage in each hour bin, from GetRateStartHour() */
+    const std::vector<std::vector<double> >& rGetModeRates() const;
+
+    /** @return the hour at which the first rate bin starts */
+    double GetRateStartHour() const;
+};
+
+#endif /* HEMASTEREQUATIONSOLVER_HPP_ */
@@ -0,0 +1,78 @@
+#include "HeModeLikelihoodRecorder.hpp"
+
+#include <cmath>
+#include <limits>
+
+HeModeLikelihoodRecorder::HeModeLikelihoodRecorder()
+{
+    Reset();
+}
+
+void HeModeLikelihoodRecorder::Reset()
+{
+    for (unsigned phase = 0; phase < 3; phase++)
+    {
+        for (unsigned mode = 0; mode < 3; mode++)
+        {
+            mModeCounts[phase][mode] = 0;
+        }
+    }
+}
+
+unsigned HeModeLikelihoodRecorder::GetModeCount(unsigned phase, unsigned mitoticMode) const
+{
+    return mModeCounts[phase - 1][mitoticMode];
+}
+
+double HeModeLikelihoodRecorder::GetModeProbability(const std::vector<double>& rPhaseProbabilities, unsigned phase,
+                                                    unsigned mitoticMode, bool ath5)
+{
+    double pPP = rPhaseProbabilities[2 * (phase - 1)];
+    double pPD = rPhaseProbabilities[2 * (phase - 1) + 1];
+
+    //Ath5 morphants undergo PP rather than PD divisions in 80% of cases
+    if (ath5)
+    {
+        pPP += .8 * pPD;
+        pPD *= .2;
+    }
+
+    if (mitoticMode == 0) return pPP;
+    if (mitoticMode == 1) return pPD;
+    return 1.0 - pPP - pPD;
+}
+
+double HeModeLikelihoodRecorder::GetLogLikelihood(const std::vector<double>& rPhaseProbabilities, bool ath5) const
+{
+    double logLikelihood = 0.0;
+    for (unsigned phase = 1; phase <= 3; phase++)
+    {
+        for (unsigned mode = 0; mode < 3; mode++)
+        {
+            unsigned count = mModeCounts[phase - 1][mode];
+            if (count == 0) continue;
+
+            double probability = GetModeProbability(rPhaseProbabilities, phase, mode, ath5);
+            if (probability <= 0.0)
+            {
+                return -std::numeric_limits<double>::infinity();
+            }
+            logLikelihood += count * log(probability);
+        }
+    }
+    return logLikelihood;
+}
+
+std::vector<double> HeModeLikelihoodRecorder::GetTiltedProbabilities(const std::vector<double>& rPhaseProbabilities,
+                                                                     double tilt)
+{
+    std::vector<double> tiltedProbabilities(rPhaseProbabilities);
+    for (unsigned phase = 0; phase < 3; phase++)
+    {
+        double pPP = rPhaseProbabilities[2 * phase];
+        double pPD = rPhaseProbabilities[2 * phase + 1];
+        tiltedProbabilities[2 * phase] = pPP + tilt * (1.0 - pPP);
+        tiltedProbabilities[2 * phase + 1] = pPD * (1.0 - tilt);
+    }
+    return tiltedProbabilities;
+}
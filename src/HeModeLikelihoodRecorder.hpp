@@ -0,0 +1,78 @@
+#ifndef HEMODELIKELIHOODRECORDER_HPP_
+#define HEMODELIKELIHOODRECORDER_HPP_
+
+#include <vector>
+
+/*******************************
+ * HE MODE LIKELIHOOD RECORDER
+ * Records the mitotic mode decisions of one stochastic He lineage, so that the lineage's likelihood can be evaluated
+ * under other phase probability sets.
+ *
+ * USE: Reset() before each lineage, pass to the founder's HeCellCycleModel with EnableLikelihoodRecorder(); daughters
+ * share the recorder. Each division records its phase and realised mode, which are sufficient statistics: the lineage's
+ * mode log-likelihood under probabilities (pPP1, pPD1, pPP2, pPD2, pPP3, pPD3) is sum n(phase, mode) log p(phase, mode).
+ * Cycle durations do not depend on the mode probabilities and cancel from likelihood ratios.
+ *
+ * GetTiltedProbabilities() gives a PP-boosted proposal for importance sampling of large clones: lineages simulated
+ * under the proposal are weighted by exp(GetLogLikelihood(target) - GetLogLikelihood(proposal)).
+ *******************************/
+
+class HeModeLikelihoodRecorder
+{
+private:
+    //mModeCounts[phase - 1][mode]: divisions in each phase with each mode (0=PP;1=PD;2=DD)
+    unsigned mModeCounts[3][3];
+
+public:
+
+    /** Constructor, with no divisions recorded */
+    HeModeLikelihoodRecorder();
+
+    /** Clear the recorded divisions for a new lineage */
+    void Reset();
+
+    /**
+     * @param phase the dividing cell's mitotic mode phase (1-3)
+     * @param mitoticMode the realised mode (0=PP;1=PD;2=DD), after any Ath5 morphant adjustment
+     */
+    void RecordDivision(unsigned phase, unsigned mitoticMode)
+    {
+        mModeCounts[phase - 1][mitoticMode]++;
+    }
+
+    /**
+     * @param phase mitotic mode phase (1-3)
+     * @param mitoticMode 0=PP;1=PD;2=DD
+     * @return the number of recorded divisions
+     */
+    unsigned GetModeCount(unsigned phase, unsigned mitoticMode) const;
+
+    /**
+     * @param rPhaseProbabilities pPP1, pPD1, pPP2, pPD2, pPP3, pPD3
+     * @param phase mitotic mode phase (1-3)
+     * @param mitoticMode 0=PP;1=PD;2=DD
+     * @param ath5 whether the lineage is Ath5 morphant (PD divisions become PP 80% of the time)
+     * @return the probability of the realised mode
+     */
+    static double GetModeProbability(const std::vector<double>& rPhaseProbabilities, unsigned phase,
+                                     unsigned mitoticMode, bool ath5);
+
+    /**
+     * @param rPhaseProbabilities pPP1, pPD1, pPP2, pPD2, pPP3, pPD3
+     * @param ath5 whether the lineage is Ath5 morphant
+     * @return the recorded divisions' mode log-likelihood (-inf if a recorded mode has probability 0)
+     */
+    double GetLogLikelihood(const std::vector<double>& rPhaseProbabilities, bool ath5) const;
+
+    /**
+     * Importance sampling proposal. Each phase's PP probability is moved a fraction tilt of the way to 1;
+     * PD and DD probabilities are scaled by 1 - tilt, keeping their ratio. Phases with PP = 1 are unchanged.
+     *
+     * @param rPhaseProbabilities target pPP1, pPD1, pPP2, pPD2, pPP3, pPD3
+     * @param tilt proposal tilt, 0 (no tilt) <= tilt < 1
+     * @return proposal pPP1, pPD1, pPP2, pPD2, pPP3, pPD3
+     */
+    static std::vector<double> GetTiltedProbabilities(const std::vector<double>& rPhaseProbabilities, double tilt);
+};
+
+#endif /* HEMODELIKELIHOODRECORDER_HPP_ */
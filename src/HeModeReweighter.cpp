@@ -0,0 +1,185 @@
+#include "HeModeReweighter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "OutputFileHandler.hpp"
+
+namespace
+{
+    //tolerance on pPP + pPD <= 1, for probabilities read from text
+    const double PROBABILITY_TOLERANCE = 1e-12;
+
+    /** @return whether each phase's pPP & pPD lie in [0,1] with pPP + pPD <= 1 */
+    bool IsValidProbabilitySet(const std::vector<double>& rPhaseProbabilities)
+    {
+        for (unsigned phase = 0; phase < 3; phase++)
+        {
+            double pPP = rPhaseProbabilities[2 * phase];
+            double pPD = rPhaseProbabilities[2 * phase + 1];
+            if (!(pPP >= 0.0 && pPP <= 1.0 && pPD >= 0.0 && pPD <= 1.0 && pPP + pPD <= 1.0 + PROBABILITY_TOLERANCE))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+HeModeReweighter::HeModeReweighter(const std::vector<double>& rSimulatedProbabilities, bool ath5) :
+        mSimulatedProbabilities(rSimulatedProbabilities), mAth5(ath5), mAlternatives(), mWeightedCounts(), mWeightSums(), mSquaredWeightSums(), mNumLineages(
+                0)
+{
+    if (rSimulatedProbabilities.size() != 6)
+    {
+        EXCEPTION("Simulated phase probabilities must be pPP1, pPD1, pPP2, pPD2, pPP3, pPD3");
+    }
+    if (!IsValidProbabilitySet(rSimulatedProbabilities))
+    {
+        EXCEPTION("Simulated phase probabilities must lie in [0,1] with pPP + pPD <= 1 in each phase");
+    }
+}
+
+void HeModeReweighter::AddAlternative(const std::vector<double>& rAlternative)
+{
+    if (rAlternative.size() != 6)
+    {
+        EXCEPTION("Alternative phase probabilities must be pPP1, pPD1, pPP2, pPD2, pPP3, pPD3");
+    }
+    if (!IsValidProbabilitySet(rAlternative))
+    {
+        EXCEPTION("Alternative phase probabilities must lie in [0,1] with pPP + pPD <= 1 in each phase");
+    }
+    mAlternatives.push_back(rAlternative);
+    mWeightedCounts.push_back(std::vector<double>());
+    mWeightSums.push_back(0.0);
+    mSquaredWeightSums.push_back(0.0);
+}
+
+void HeModeReweighter::ReadAlternatives(const std::string& rFilename)
+{
+    std::ifstream alternativesFile(rFilename.c_str());
+    if (!alternativesFile.is_open())
+    {
+        EXCEPTION("Could not open alternatives file " + rFilename);
+    }
+
+    std::string line;
+    while (std::getline(alternativesFile, line))
+    {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream lineStream(line);
+        std::vector<double> alternative;
+        double probability;
+        while (lineStream >> probability)
+        {
+            alternative.push_back(probability);
+        }
+        if (alternative.empty()) continue;
+        AddAlternative(alternative);
+    }
+}
+
+unsigned HeModeReweighter::GetNumAlternatives() const
+{
+    return mAlternatives.size();
+}
+
+bool HeModeReweighter::IsCovered(const std::vector<double>& rAlternative) const
+{
+    for (unsigned phase = 1; phase <= 3; phase++)
+    {
+        for (unsigned mode = 0; mode < 3; mode++)
+        {
+            if (HeModeLikelihoodRecorder::GetModeProbability(rAlternative, phase, mode, mAth5) > 0.0
+                    && HeModeLikelihoodRecorder::GetModeProbability(mSimulatedProbabilities, phase, mode, mAth5) <= 0.0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void HeModeReweighter::AddLineage(const HeModeLikelihoodRecorder& rRecorder, unsigned count)
+{
+    double simulatedLogLikelihood = rRecorder.GetLogLikelihood(mSimulatedProbabilities, mAth5);
+    for (unsigned i = 0; i < mAlternatives.size(); i++)
+    {
+        double weight = exp(rRecorder.GetLogLikelihood(mAlternatives[i], mAth5) - simulatedLogLikelihood);
+        if (count >= mWeightedCounts[i].size()) mWeightedCounts[i].resize(count + 1, 0.0);
+        mWeightedCounts[i][count] += weight;
+        mWeightSums[i] += weight;
+        mSquaredWeightSums[i] += weight * weight;
+    }
+    mNumLineages++;
+}
+
+void HeModeReweighter::WriteSummary(const std::string& directory, const std::string& filename) const
+{
+    unsigned numAlternatives = mAlternatives.size();
+
+    //common histogram length across shards
+    int localLength = 0;
+    for (unsigned i = 0; i < numAlternatives; i++)
+    {
+        localLength = std::max(localLength, (int) mWeightedCounts[i].size());
+    }
+    int histogramLength = 0;
+    MPI_Allreduce(&localLength, &histogramLength, 1, MPI_INT, MPI_MAX, PETSC_COMM_WORLD);
+
+    //pack per alternative: weight sum, squared weight sum, histogram; then sum across shards
+    unsigned stride = histogramLength + 2;
+    std::vector<double> local(std::max(numAlternatives * stride, 1u), 0.0);
+    for (unsigned i = 0; i < numAlternatives; i++)
+    {
+        local[i * stride] = mWeightSums[i];
+        local[i * stride + 1] = mSquaredWeightSums[i];
+        for (unsigned m = 0; m < mWeightedCounts[i].size(); m++)
+        {
+            local[i * stride + 2 + m] = mWeightedCounts[i][m];
+        }
+    }
+    std::vector<double> total(local.size(), 0.0);
+    MPI_Reduce(&local[0], &total[0], local.size(), MPI_DOUBLE, MPI_SUM, 0, PETSC_COMM_WORLD);
+
+    unsigned localLineages = mNumLineages;
+    unsigned numLineages = 0;
+    MPI_Reduce(&localLineages, &numLineages, 1, MPI_UNSIGNED, MPI_SUM, 0, PETSC_COMM_WORLD);
+
+    if (PetscTools::GetMyRank() != 0)
+    {
+        return;
+    }
+
+    OutputFileHandler handler(directory, false);
+    std::ofstream summaryFile((handler.GetOutputDirectoryFullPath() + filename).c_str());
+    summaryFile << "Lineages\t" << numLineages << "\n";
+    summaryFile << "Alternative\tpPP1\tpPD1\tpPP2\tpPD2\tpPP3\tpPD3\tCovered\tESS\tCount\tProbability\n";
+    for (unsigned i = 0; i < numAlternatives; i++)
+    {
+        double weightSum = total[i * stride];
+        double squaredWeightSum = total[i * stride + 1];
+        double ess = (squaredWeightSum > 0.0) ? weightSum * weightSum / squaredWeightSum : 0.0;
+
+        std::ostringstream alternativeColumns;
+        alternativeColumns << i;
+        for (unsigned j = 0; j < 6; j++)
+        {
+            alternativeColumns << "\t" << mAlternatives[i][j];
+        }
+        alternativeColumns << "\t" << IsCovered(mAlternatives[i]) << "\t" << ess;
+
+        for (int m = 0; m < histogramLength; m++)
+        {
+            double probability = (weightSum > 0.0) ? total[i * stride + 2 + m] / weightSum : 0.0;
+            summaryFile << alternativeColumns.str() << "\t" << m << "\t" << probability << "\n";
+        }
+    }
+    summaryFile.close();
+}
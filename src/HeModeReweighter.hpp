@@ -0,0 +1,79 @@
+#ifndef HEMODEREWEIGHTER_HPP_
+#define HEMODEREWEIGHTER_HPP_
+
+#include <string>
+#include <vector>
+
+#include "HeModeLikelihoodRecorder.hpp"
+
+/*******************************
+ * HE MODE REWEIGHTER
+ * Importance-reweighted count histograms at alternative He phase probability sets, from one set of simulations.
+ *
+ * USE: Construct with the simulated phase probabilities, read the alternatives with ReadAlternatives(), then
+ * AddLineage() each lineage's recorder & count. WriteSummary() (collective across simulator shards) writes
+ * the self-normalised weighted histogram and effective sample size for each alternative.
+ *
+ * Lineage weights are likelihood ratios of the recorded mitotic modes, w = exp(logL_alt - logL_sim).
+ * An alternative giving nonzero probability to a mode the simulated set never produces is not covered by the
+ * simulations; it is flagged in the summary and its histogram should not be used.
+ * Effective sample size (sum w)^2 / sum w^2 falls as alternatives move away from the simulated set.
+ *******************************/
+
+class HeModeReweighter
+{
+private:
+    std::vector<double> mSimulatedProbabilities;
+    bool mAth5;
+    //alternative probability sets, each pPP1, pPD1, pPP2, pPD2, pPP3, pPD3
+    std::vector<std::vector<double> > mAlternatives;
+    //per alternative: weighted count histograms, weight & squared weight sums
+    std::vector<std::vector<double> > mWeightedCounts;
+    std::vector<double> mWeightSums;
+    std::vector<double> mSquaredWeightSums;
+    unsigned mNumLineages;
+
+    /** @return whether the simulated probabilities give every mode the alternative can produce nonzero probability */
+    bool IsCovered(const std::vector<double>& rAlternative) const;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rSimulatedProbabilities the simulations' pPP1, pPD1, pPP2, pPD2, pPP3, pPD3; each in [0,1], pPP + pPD <= 1
+     * @param ath5 whether the simulated lineages are Ath5 morphant
+     */
+    HeModeReweighter(const std::vector<double>& rSimulatedProbabilities, bool ath5);
+
+    /**
+     * @param rAlternative an alternative pPP1, pPD1, pPP2, pPD2, pPP3, pPD3; each in [0,1], with pPP + pPD <= 1
+     */
+    void AddAlternative(const std::vector<double>& rAlternative);
+
+    /**
+     * Read alternatives from a text file, one whitespace-separated set of 6 probabilities per line ('#' lines skipped)
+     *
+     * @param rFilename path to the alternatives file
+     */
+    void ReadAlternatives(const std::string& rFilename);
+
+    /** @return the number of alternatives */
+    unsigned GetNumAlternatives() const;
+
+    /**
+     * @param rRecorder the lineage's recorded mitotic modes
+     * @param count the lineage's count
+     */
+    void AddLineage(const HeModeLikelihoodRecorder& rRecorder, unsigned count);
+
+    /**
+     * Collective. Sum the shards' weighted histograms and write the summary on rank 0 as directory/filename.
+     *
+     * @param directory the output directory (relative to CHASTE_TEST_OUTPUT)
+     * @param filename the summary filename
+     */
+    void WriteSummary(const std::string& directory, const std::string& filename) const;
+};
+
+#endif /* HEMODEREWEIGHTER_HPP_ */
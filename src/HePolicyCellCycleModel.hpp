@@ -0,0 +1,261 @@
+#ifndef HEPOLICYCELLCYCLEMODEL_HPP_
+#define HEPOLICYCELLCYCLEMODEL_HPP_
+
+#include "HeCellCycleModel.hpp"
+
+/***********************************
+ * HE POLICY CELL CYCLE MODEL
+ * Compile-time configured variant of HeCellCycleModel for production runs.
+ *
+ * USE: The model variant and output modes HeCellCycleModel checks at every division are fixed by template
+ * policy parameters, so each instantiation compiles to a branch-free, inlinable division kernel:
+ * MODE_POLICY: HeStochasticMode or HeDeterministicMode
+ * OUTPUT_POLICY: HeNoModeEventOutput or HeModeEventLogOutput (EventOutputBuffer)
+ * SAMPLER_POLICY: HeNoSequenceSampler or HeSequenceSampler
+ * KILL_POLICY: HeKeepSpecified or HeKillSpecified
+ *
+ * Setup is through the usual HeCellCycleModel functions (SetModelParameters(), SetDeterministicMode(),
+ * EnableModeEventOutput(), EnableSequenceSampler()...). The mode & kill flags these set are ignored in favour of the
+ * policies, so the parameter setup must match the instantiated MODE_POLICY. Output & sampler policies only compile the
+ * feature in: as with HeCellCycleModel, events are written once EnableModeEventOutput() has been called, and sequences
+ * sampled once EnableSequenceSampler() has. Debug output is not available- use HeCellCycleModel.
+ * Random draws are made in the same order as HeCellCycleModel, so a seed gives identical lineages with either class.
+ *
+ * NB: policy models are not registered for serialization; archive simulations using HeCellCycleModel.
+ ************************************/
+
+/** Stochastic (He et al. 2012) mitotic mode rules */
+struct HeStochasticMode
+{
+    static const bool DETERMINISTIC = false;
+};
+
+/** Deterministic alternative mitotic mode rules */
+struct HeDeterministicMode
+{
+    static const bool DETERMINISTIC = true;
+};
+
+/** No per-event mitotic mode output */
+struct HeNoModeEventOutput
+{
+    static const bool ENABLED = false;
+};
+
+/** Per-event mitotic mode output to the worker's EventOutputBuffer */
+struct HeModeEventLogOutput
+{
+    static const bool ENABLED = true;
+};
+
+/** Mitotic mode sequence sampler off */
+struct HeNoSequenceSampler
+{
+    static const bool ENABLED = false;
+};
+
+/** Mitotic mode sequence sampler on */
+struct HeSequenceSampler
+{
+    static const bool ENABLED = true;
+};
+
+/** Specified (postmitotic) cells stay in the population */
+struct HeKeepSpecified
+{
+    static const bool KILL = false;
+};
+
+/** Specified (postmitotic) cells are killed & removed from the population */
+struct HeKillSpecified
+{
+    static const bool KILL = true;
+};
+
+template<class MODE_POLICY, class OUTPUT_POLICY, class SAMPLER_POLICY, class KILL_POLICY>
+class HePolicyCellCycleModel : public HeCellCycleModel
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the cell-cycle model, never used directly - boost uses this.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<HeCellCycleModel>(*this);
+    }
+
+    /** Apply the postmitotic specification rule to this model's cell */
+    void SpecifyCell()
+    {
+        mpCell->SetCellProliferativeType(mp_PostMitoticType);
+        mPropertyFlags |= CellPropertyFlags::POSTMITOTIC;
+        mCellCycleDuration = DBL_MAX;
+
+        if (KILL_POLICY::KILL)
+        {
+            mpCell->Kill();
+        }
+    }
+
+protected:
+
+    /**
+     * Protected copy-constructor for use by CreateCellCycleModel().
+     *
+     * @param rModel the cell cycle model to copy.
+     */
+    HePolicyCellCycleModel(const HePolicyCellCycleModel& rModel) :
+            HeCellCycleModel(rModel)
+    {
+    }
+
+public:
+
+    /**
+     * Constructor - just a default, mBirthTime is set in the AbstractCellCycleModel class.
+     */
+    HePolicyCellCycleModel() :
+            HeCellCycleModel()
+    {
+    }
+
+    /**
+     * Overridden builder method to create new copies of
+     * this cell-cycle model.
+     *
+     * @return new cell-cycle model
+     */
+    AbstractCellCycleModel* CreateCellCycleModel()
+    {
+        return new HePolicyCellCycleModel(*this);
+    }
+
+    /**
+     * Overridden ResetForDivision() method.
+     * Policy-resolved version of HeCellCycleModel::ResetForDivision()
+     **/
+    void ResetForDivision()
+    {
+        RandomNumberGenerator* p_random_number_generator = RandomNumberGenerator::Instance();
+
+        double currentTiL = SimulationTime::Instance()->GetTime() + mTiLOffset;
+        unsigned currentPhase = GetMitoticModePhase(currentTiL);
+        mMitoticMode = 0;
+
+        if (MODE_POLICY::DETERMINISTIC)
+        {
+            if (currentPhase == 2)
+            {
+                mMitoticMode = 1;
+                if ((mPropertyFlags & CellPropertyFlags::ATH5MO) && p_random_number_generator->ranf() <= .8)
+                {
+                    mMitoticMode = 0;
+                }
+            }
+            if (currentPhase == 3)
+            {
+                mMitoticMode = 2;
+            }
+            DrawMitoticModeRV(); //unused mitotic mode RV, drawn to keep the random sequence of HeCellCycleModel
+        }
+        else
+        {
+            mMitoticMode = GetStochasticMitoticMode(currentPhase, DrawMitoticModeRV());
+            if (mMitoticMode == 1 && (mPropertyFlags & CellPropertyFlags::ATH5MO)
+                    && p_random_number_generator->ranf() <= .8)
+            {
+                mMitoticMode = 0;
+            }
+            if (mpLikelihoodRecorder)
+            {
+                mpLikelihoodRecorder->RecordDivision(currentPhase, mMitoticMode);
+            }
+        }
+
+        if (OUTPUT_POLICY::ENABLED && mOutput)
+        {
+            double pPP, pPD;
+            GetMitoticModeProbabilities(currentPhase, MODE_POLICY::DETERMINISTIC, pPP, pPD);
+            WriteModeEventOutput(pPP, pPD);
+        }
+
+        //set new cell cycle length (will be overwritten with DBL_MAX for DD divisions)
+        AbstractSimpleCellCycleModel::ResetForDivision();
+
+        if (mMitoticMode == 2)
+        {
+            SpecifyCell();
+        }
+
+        if (SAMPLER_POLICY::ENABLED && mSequenceSampler)
+        {
+            mSeqSamplerLabelSister = false;
+            if (mPropertyFlags & CellPropertyFlags::LABEL)
+            {
+                (*EventOutputBuffer::Instance()) << mMitoticMode;
+                if (p_random_number_generator->ranf() <= .5)
+                {
+                    mSeqSamplerLabelSister = true;
+                    mpCell->RemoveCellProperty<CellLabel>();
+                    mPropertyFlags &= ~CellPropertyFlags::LABEL;
+                }
+            }
+        }
+    }
+
+    /**
+     * Overridden InitialiseDaughterCell() method.
+     * Policy-resolved version of HeCellCycleModel::InitialiseDaughterCell()
+     * */
+    void InitialiseDaughterCell()
+    {
+        RandomNumberGenerator* p_random_number_generator = RandomNumberGenerator::Instance();
+
+        if (mMitoticMode == 1) //RPC becomes specified retinal neuron in asymmetric PD mitosis
+        {
+            SpecifyCell();
+        }
+
+        if (mMitoticMode == 0) //sister shift respects refractory period
+        {
+            double sisterShift = DrawSisterShift();
+            mCellCycleDuration = std::max(mGammaShift, mCellCycleDuration + sisterShift);
+        }
+
+        if (MODE_POLICY::DETERMINISTIC) //shift phase boundaries to reflect error in "timer" after division
+        {
+            double phaseShift = p_random_number_generator->NormalRandomDeviate(0, mPhaseShiftWidth);
+            mMitoticModePhase2 = mMitoticModePhase2 + phaseShift;
+            mMitoticModePhase3 = mMitoticModePhase3 + phaseShift;
+        }
+
+        if (SAMPLER_POLICY::ENABLED && mSequenceSampler)
+        {
+            if (mSeqSamplerLabelSister)
+            {
+                mpCell->AddCellProperty(mp_label_Type);
+                mPropertyFlags |= CellPropertyFlags::LABEL;
+                mSeqSamplerLabelSister = false;
+            }
+            else if (mPropertyFlags & CellPropertyFlags::LABEL)
+            {
+                mpCell->RemoveCellProperty<CellLabel>();
+                mPropertyFlags &= ~CellPropertyFlags::LABEL;
+            }
+        }
+
+        if (KILL_POLICY::KILL && mMitoticMode == 2)
+        {
+            mpCell->Kill();
+        }
+    }
+};
+
+#endif /*HEPOLICYCELLCYCLEMODEL_HPP_*/
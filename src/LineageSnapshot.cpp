@@ -0,0 +1,81 @@
+#include "LineageSnapshot.hpp"
+
+#include <boost/cstdint.hpp>
+
+#include "DifferentiatedCellProliferativeType.hpp"
+
+LineageSnapshot::LineageSnapshot(AbstractCellPopulation<2>& rCellPopulation,
+                                 const std::vector<boost::shared_ptr<AbstractCellProperty> >& rCarriedProperties) :
+        mModelTemplates(), mProliferativeTypes(), mCarriedProperties(), mPostMitoticCount(0)
+{
+    for (AbstractCellPopulation<2>::Iterator cell_iter = rCellPopulation.Begin(); cell_iter != rCellPopulation.End();
+            ++cell_iter)
+    {
+        CellPtr p_cell = *cell_iter;
+        if (p_cell->GetCellProliferativeType()->IsType<DifferentiatedCellProliferativeType>())
+        {
+            mPostMitoticCount++;
+            continue;
+        }
+
+        mModelTemplates.push_back(p_cell->GetCellCycleModel()->CreateCellCycleModel());
+        mProliferativeTypes.push_back(p_cell->GetCellProliferativeType());
+
+        std::vector<boost::shared_ptr<AbstractCellProperty> > properties;
+        for (unsigned i = 0; i < rCarriedProperties.size(); i++)
+        {
+            if (p_cell->rGetCellPropertyCollection().HasProperty(rCarriedProperties[i]))
+            {
+                properties.push_back(rCarriedProperties[i]);
+            }
+        }
+        mCarriedProperties.push_back(properties);
+    }
+}
+
+LineageSnapshot::~LineageSnapshot()
+{
+    for (unsigned i = 0; i < mModelTemplates.size(); i++)
+    {
+        delete mModelTemplates[i];
+    }
+}
+
+unsigned LineageSnapshot::GetNumProliferativeCells() const
+{
+    return mModelTemplates.size();
+}
+
+unsigned LineageSnapshot::GetPostMitoticCount() const
+{
+    return mPostMitoticCount;
+}
+
+std::vector<CellPtr> LineageSnapshot::CreateCells(boost::shared_ptr<AbstractCellProperty> pMutationState) const
+{
+    std::vector<CellPtr> cells;
+    for (unsigned i = 0; i < mModelTemplates.size(); i++)
+    {
+        AbstractCellCycleModel* p_model = mModelTemplates[i]->CreateCellCycleModel();
+        CellPtr p_cell(new Cell(pMutationState, p_model));
+        p_cell->SetCellProliferativeType(mProliferativeTypes[i]);
+        for (unsigned j = 0; j < mCarriedProperties[i].size(); j++)
+        {
+            p_cell->AddCellProperty(mCarriedProperties[i][j]);
+        }
+        //attach the model without InitialiseCellCycleModel(), which would redraw its cycle
+        p_model->SetCell(p_cell);
+        cells.push_back(p_cell);
+    }
+    return cells;
+}
+
+unsigned LineageSnapshot::GetContinuationSeed(unsigned streamSeed, unsigned continuation)
+{
+    //splitmix64 finaliser
+    boost::uint64_t z = ((boost::uint64_t) streamSeed << 32) + continuation + 1;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z = z ^ (z >> 31);
+    return (unsigned) (z >> 32);
+}
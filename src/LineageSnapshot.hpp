@@ -0,0 +1,73 @@
+#ifndef LINEAGESNAPSHOT_HPP_
+#define LINEAGESNAPSHOT_HPP_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "AbstractCellPopulation.hpp"
+#include "AbstractCellCycleModel.hpp"
+#include "AbstractCellProperty.hpp"
+#include "Cell.hpp"
+
+/*******************************
+ * LINEAGE SNAPSHOT
+ * In-memory copy of a running lineage's proliferative cells, for forking the lineage into several continuations.
+ *
+ * USE: After solving a lineage to the split time, construct from its population; each proliferative cell's cycle model
+ * is copied with CreateCellCycleModel() (birth time, cycle duration, TiL & mode state, shared recorders & samplers)
+ * along with its proliferative type and any of the carried properties it has. Post-mitotic cells only contribute
+ * their number. For each continuation, destroy & restart SimulationTime at the split time, reseed the RNG (and any
+ * duration sampler) with GetContinuationSeed(), and build a new population from CreateCells(); the simulator must
+ * be constructed with initialiseCells = false, since the copied models are already initialised.
+ *
+ * Chaste archives would serve the same purpose, but the He models only serialize their base class state.
+ *******************************/
+
+class LineageSnapshot
+{
+private:
+    //unattached copies of the proliferative cells' models, re-copied for each continuation
+    std::vector<AbstractCellCycleModel*> mModelTemplates;
+    std::vector<boost::shared_ptr<AbstractCellProperty> > mProliferativeTypes;
+    std::vector<std::vector<boost::shared_ptr<AbstractCellProperty> > > mCarriedProperties;
+    unsigned mPostMitoticCount;
+
+public:
+
+    /**
+     * @param rCellPopulation the lineage's population at the split time
+     * @param rCarriedProperties properties copied onto the forked cells, where the original cell has them
+     */
+    LineageSnapshot(AbstractCellPopulation<2>& rCellPopulation,
+                    const std::vector<boost::shared_ptr<AbstractCellProperty> >& rCarriedProperties);
+
+    /** Destructor, deleting the model templates */
+    ~LineageSnapshot();
+
+    LineageSnapshot(const LineageSnapshot&) = delete;
+    LineageSnapshot& operator=(const LineageSnapshot&) = delete;
+
+    /** @return the number of proliferative cells copied */
+    unsigned GetNumProliferativeCells() const;
+
+    /** @return the number of post-mitotic cells at the split time, which every continuation inherits */
+    unsigned GetPostMitoticCount() const;
+
+    /**
+     * @param pMutationState the mutation state given to the forked cells
+     * @return new cells, each with a fresh copy of the corresponding model
+     */
+    std::vector<CellPtr> CreateCells(boost::shared_ptr<AbstractCellProperty> pMutationState) const;
+
+    /**
+     * Independent RNG substream seeds for the continuations of a lineage; a 64 bit finaliser mix of the lineage's
+     * stream seed and the continuation index, so continuation streams are unrelated to the simulator's seed range
+     *
+     * @param streamSeed the lineage's RNG seed
+     * @param continuation continuation index
+     * @return the continuation's RNG seed
+     */
+    static unsigned GetContinuationSeed(unsigned streamSeed, unsigned continuation);
+};
+
+#endif /* LINEAGESNAPSHOT_HPP_ */
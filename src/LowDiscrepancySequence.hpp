@@ -0,0 +1,72 @@
+#ifndef LOWDISCREPANCYSEQUENCE_HPP_
+#define LOWDISCREPANCYSEQUENCE_HPP_
+
+#include <stdint.h>
+
+/*******************************
+ * LOW DISCREPANCY SEQUENCE
+ * Owen-scrambled base 2 van der Corput sequence (the first Sobol dimension) for stratified sampling of
+ * a simulator covariate, eg. lineage start times or TiL offsets, across a seed range.
+ *
+ * USE: Construct with a scramble key, then GetSample(i) for the i-th sample in [0,1).
+ * Any 2^k consecutive samples from 0 put exactly one point in each 1/2^k stratum, and every prefix is close to
+ * evenly spread, so seed ranges of any size (and contiguous simulator shards) are stratified. The nested uniform
+ * scramble (hash-based, after Burley 2020) keeps each sample marginally uniform, so estimates stay unbiased;
+ * different keys give independent randomisations.
+ *******************************/
+
+class LowDiscrepancySequence
+{
+private:
+    uint32_t mScrambleKey;
+
+    /** @return x with its 32 bits in reverse order */
+    static uint32_t ReverseBits(uint32_t x)
+    {
+        x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+        x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+        x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+        x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+        return (x >> 16) | (x << 16);
+    }
+
+    /** Laine-Karras style hash: each output bit depends only on the input bits below it */
+    static uint32_t LaineKarrasPermutation(uint32_t x, uint32_t key)
+    {
+        x += key;
+        x ^= x * 0x6c50b47cu;
+        x ^= x * 0xb82f1e52u;
+        x ^= x * 0xc7afe638u;
+        x ^= x * 0x8d22f6e6u;
+        return x;
+    }
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param scrambleSeed seed for the scramble; hashed, so consecutive seeds give unrelated scrambles
+     */
+    LowDiscrepancySequence(unsigned scrambleSeed)
+    {
+        //splitmix-style finaliser
+        uint64_t z = scrambleSeed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        mScrambleKey = (uint32_t) (z ^ (z >> 31));
+    }
+
+    /**
+     * @param index sample index
+     * @return the scrambled radical inverse of index, in [0,1)
+     */
+    double GetSample(unsigned index) const
+    {
+        //van der Corput = bit-reversed index; hashing the index before reversal nests the scramble over strata
+        uint32_t scrambled = ReverseBits(LaineKarrasPermutation(index, mScrambleKey));
+        return (scrambled + 0.5) / 4294967296.0;
+    }
+};
+
+#endif /* LOWDISCREPANCYSEQUENCE_HPP_ */
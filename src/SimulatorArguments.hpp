@@ -0,0 +1,42 @@
+#ifndef SIMULATORARGUMENTS_HPP_
+#define SIMULATORARGUMENTS_HPP_
+
+#include <cctype>
+#include "CommandLineArguments.hpp"
+
+/*******************************
+ * SIMULATOR ARGUMENTS
+ * Project simulators take a fixed list of positional arguments, optionally followed by Chaste-style
+ * "-option [value]" flags. Options are read with CommandLineArguments::Instance() (set up by ExecutableSupport).
+ *******************************/
+
+/**
+ * Count the positional arguments, ie. everything before the first option flag.
+ * Negative numeric arguments ("-0.5") are positional; options begin with '-' followed by a letter.
+ *
+ * @param argc main()'s argc
+ * @param argv main()'s argv
+ * @return the argc of the positional argument list, to be checked against the simulator's usage
+ */
+inline int CountPositionalArguments(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (argv[i][0] == '-' && std::isalpha(static_cast<unsigned char>(argv[i][1])))
+        {
+            return i;
+        }
+    }
+    return argc;
+}
+
+/**
+ * @param option the option flag, eg. "-fast_rng"
+ * @return whether the flag was passed to the simulator
+ */
+inline bool SimulatorOptionExists(const std::string& option)
+{
+    return CommandLineArguments::Instance()->OptionExists(option);
+}
+
+#endif /* SIMULATORARGUMENTS_HPP_ */
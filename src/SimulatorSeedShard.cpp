@@ -0,0 +1,97 @@
+#include "SimulatorSeedShard.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "PetscTools.hpp"
+#include "OutputFileHandler.hpp"
+
+SimulatorSeedShard::SimulatorSeedShard(unsigned startSeed, unsigned endSeed) :
+        mGlobalStartSeed(startSeed), mStartSeed(startSeed), mStopSeed(endSeed + 1), mRank(PetscTools::GetMyRank()), mNumProcs(
+                PetscTools::GetNumProcs())
+{
+    //each rank runs its own serial simulations; output handlers and barriers no longer synchronise across ranks
+    PetscTools::IsolateProcesses(true);
+
+    //contiguous blocks, the first (numSeeds % numProcs) ranks take one extra seed
+    unsigned numSeeds = endSeed - startSeed + 1;
+    unsigned baseCount = numSeeds / mNumProcs;
+    unsigned remainder = numSeeds % mNumProcs;
+
+    mStartSeed = startSeed + mRank * baseCount + std::min(mRank, remainder);
+    mStopSeed = mStartSeed + baseCount + (mRank < remainder ? 1 : 0);
+}
+
+unsigned SimulatorSeedShard::GetStartSeed() const
+{
+    return mStartSeed;
+}
+
+unsigned SimulatorSeedShard::GetStopSeed() const
+{
+    return mStopSeed;
+}
+
+unsigned SimulatorSeedShard::GetFirstEntry() const
+{
+    return mStartSeed - mGlobalStartSeed + 1;
+}
+
+bool SimulatorSeedShard::IsFirstShard() const
+{
+    return mRank == 0;
+}
+
+std::string SimulatorSeedShard::GetShardName(const std::string& name) const
+{
+    if (mNumProcs == 1)
+    {
+        return name;
+    }
+    return name + "_shard" + std::to_string(mRank);
+}
+
+void SimulatorSeedShard::GatherShardFiles(const std::string& directory, const std::string& filename) const
+{
+    if (mNumProcs == 1)
+    {
+        return;
+    }
+
+    //read & remove this rank's shard
+    OutputFileHandler handler(directory, false);
+    std::string shardPath = handler.GetOutputDirectoryFullPath() + GetShardName(filename);
+    std::ifstream shardFile(shardPath.c_str(), std::ios::binary);
+    std::stringstream shardStream;
+    shardStream << shardFile.rdbuf();
+    shardFile.close();
+    std::remove(shardPath.c_str());
+    std::string shardRows = shardStream.str();
+
+    //gather shard lengths, then the shards themselves, in rank order
+    int shardLength = shardRows.size();
+    std::vector<int> lengths(mNumProcs, 0);
+    MPI_Gather(&shardLength, 1, MPI_INT, &lengths[0], 1, MPI_INT, 0, PETSC_COMM_WORLD);
+
+    std::vector<int> offsets(mNumProcs, 0);
+    int totalLength = 0;
+    for (unsigned i = 0; i < mNumProcs; i++)
+    {
+        offsets[i] = totalLength;
+        totalLength += lengths[i];
+    }
+
+    std::vector<char> allRows(std::max(totalLength, 1));
+    MPI_Gatherv(const_cast<char*>(shardRows.data()), shardLength, MPI_CHAR, &allRows[0], &lengths[0], &offsets[0],
+                MPI_CHAR, 0, PETSC_COMM_WORLD);
+
+    if (mRank == 0)
+    {
+        std::ofstream outputFile((handler.GetOutputDirectoryFullPath() + filename).c_str(), std::ios::binary);
+        outputFile.write(&allRows[0], totalLength);
+        outputFile.close();
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef SIMULATORSEEDSHARD_HPP_
+#define SIMULATORSEEDSHARD_HPP_
+
+#include <string>
+
+/*******************************
+ * SIMULATOR SEED SHARD
+ * Splits a simulator's seed range across MPI ranks for single-command parallel runs (mpirun -np N <simulator> ...)
+ *
+ * USE: Construct with the simulator's full seed range after ExecutableSupport startup; the constructor isolates the
+ * ranks (PetscTools::IsolateProcesses) so that each runs its own serial simulations. Each rank gets a contiguous
+ * block of seeds [GetStartSeed(), GetStopSeed()), so concatenating rank outputs in rank order gives seed order.
+ *
+ * Row output: each rank writes its rows to the log file GetShardName(filename); only the first shard writes headers.
+ * GetFirstEntry() gives the entry number of the rank's first seed. After LogFile::Close(), GatherShardFiles()
+ * concatenates the shard logs onto rank 0 as <filename>, which is then identical to the serial run's output.
+ *
+ * With a single process, shard names are unchanged and GatherShardFiles() does nothing.
+ *******************************/
+
+class SimulatorSeedShard
+{
+private:
+    unsigned mGlobalStartSeed;
+    unsigned mStartSeed;
+    unsigned mStopSeed;
+    unsigned mRank;
+    unsigned mNumProcs;
+
+public:
+
+    /**
+     * Constructor. Isolates the MPI ranks and assigns this rank its block of seeds.
+     *
+     * @param startSeed the first seed of the full range
+     * @param endSeed the last seed of the full range
+     */
+    SimulatorSeedShard(unsigned startSeed, unsigned endSeed);
+
+    /** @return this rank's first seed */
+    unsigned GetStartSeed() const;
+    /** @return one past this rank's last seed (== GetStartSeed() if the rank has no seeds) */
+    unsigned GetStopSeed() const;
+    /** @return the log entry number of this rank's first seed */
+    unsigned GetFirstEntry() const;
+    /** @return whether this rank's output comes first, ie. whether it writes the file headers */
+    bool IsFirstShard() const;
+
+    /**
+     * @param name a file or directory name shared by all ranks
+     * @return the rank-specific version of name
+     */
+    std::string GetShardName(const std::string& name) const;
+
+    /**
+     * Collective. Concatenate every rank's shard log onto rank 0 as directory/filename, in rank order.
+     * Shard logs are removed. Call after LogFile::Close().
+     *
+     * @param directory the output directory (relative to CHASTE_TEST_OUTPUT) passed to LogFile::Set()
+     * @param filename the combined output filename
+     */
+    void GatherShardFiles(const std::string& directory, const std::string& filename) const;
+};
+
+#endif /* SIMULATORSEEDSHARD_HPP_ */
@@ -1,10 +1,11 @@
 #include "WanStemCellCycleModel.hpp"
+#include "HePolicyCellCycleModel.hpp"
 
 WanStemCellCycleModel::WanStemCellCycleModel() :
         AbstractSimpleCellCycleModel(), mExpandingStemPopulation(false), mPopulation(), mOutput(false), mEventStartTime(
                 72.0), mDebug(false), mTimeID(), mVarIDs(), mDebugWriter(), mBasePopulation(), mGammaShift(4.0), mGammaShape(
                 2.0), mGammaScale(1.0), mMitoticMode(0), mSeed(0), mTimeDependentCycleDuration(false), mPeakRateTime(), mIncreasingRateSlope(), mDecreasingRateSlope(), mBaseGammaScale(), mHeParamVector(
-                { 8, 15, 1, 0, .2, .4, .2, 0, 4, 2, 1, 1 })
+                { 8, 15, 1, 0, .2, .4, .2, 0, 4, 2, 1, 1 }), mpDurationSampler()
 {
 }
 
@@ -16,7 +17,7 @@ WanStemCellCycleModel::WanStemCellCycleModel(const WanStemCellCycleModel& rModel
                 rModel.mGammaScale), mMitoticMode(rModel.mMitoticMode), mSeed(rModel.mSeed), mTimeDependentCycleDuration(
                 rModel.mTimeDependentCycleDuration), mPeakRateTime(rModel.mPeakRateTime), mIncreasingRateSlope(
                 rModel.mIncreasingRateSlope), mDecreasingRateSlope(rModel.mDecreasingRateSlope), mBaseGammaScale(
-                rModel.mBaseGammaScale), mHeParamVector(rModel.mHeParamVector)
+                rModel.mBaseGammaScale), mHeParamVector(rModel.mHeParamVector), mpDurationSampler(rModel.mpDurationSampler)
 {
 }
 
@@ -27,9 +28,15 @@ AbstractCellCycleModel* WanStemCellCycleModel::CreateCellCycleModel()
 
 void WanStemCellCycleModel::SetCellCycleDuration()
 {
-    RandomNumberGenerator* p_random_number_generator = RandomNumberGenerator::Instance();
-
-    mCellCycleDuration = mGammaShift + p_random_number_generator->GammaRandomDeviate(mGammaShape, mGammaScale);
+    if (mpDurationSampler)
+    {
+        mCellCycleDuration = mGammaShift + mpDurationSampler->Gamma(mGammaShape, mGammaScale);
+    }
+    else
+    {
+        mCellCycleDuration = mGammaShift
+                + RandomNumberGenerator::Instance()->GammaRandomDeviate(mGammaShape, mGammaScale);
+    }
 
     /**************************************
      * CELL CYCLE DURATION RANDOM VARIABLE
@@ -122,13 +129,29 @@ void WanStemCellCycleModel::InitialiseDaughterCell()
 
         double tiLOffset = -(SimulationTime::Instance()->GetTime());
         //Initialise a HeCellCycleModel and set it up with appropriate TiL value & parameters
-        HeCellCycleModel* p_cycle_model = new HeCellCycleModel;
+        //offspring are killed on specification; the policy model is used unless debug output is required
+        HeCellCycleModel* p_cycle_model;
+        if (mDebug)
+        {
+            p_cycle_model = new HeCellCycleModel;
+        }
+        else
+        {
+            p_cycle_model = new HePolicyCellCycleModel<HeStochasticMode, HeNoModeEventOutput, HeNoSequenceSampler,
+                    HeKillSpecified>;
+        }
         p_cycle_model->SetModelParameters(tiLOffset, mHeParamVector[0], mHeParamVector[1], mHeParamVector[2],
                                           mHeParamVector[3], mHeParamVector[4], mHeParamVector[5], mHeParamVector[6],
                                           mHeParamVector[7], mHeParamVector[8], mHeParamVector[9], mHeParamVector[10],
                                           mHeParamVector[11]);
         p_cycle_model->EnableKillSpecified();
 
+        //progenitor offspring draw from the stem cell's duration sampler, if enabled
+        if (mpDurationSampler)
+        {
+            p_cycle_model->EnableFastDurationSampler(mpDurationSampler);
+        }
+
         //if debug output is enabled for the stem cell, enable it for its progenitor offspring
         if (mDebug)
         {
@@ -172,6 +195,11 @@ void WanStemCellCycleModel::SetTimeDependentCycleDuration(double peakRateTime, d
     mBaseGammaScale = mGammaScale;
 }
 
+void WanStemCellCycleModel::EnableFastDurationSampler(boost::shared_ptr<CycleDurationSampler> p_sampler)
+{
+    mpDurationSampler = p_sampler;
+}
+
 void WanStemCellCycleModel::EnableModeEventOutput(double eventStart, unsigned seed)
 {
     mOutput = true;
@@ -87,6 +87,8 @@ protected:
     double mDecreasingRateSlope;
     double mBaseGammaScale;
     std::vector<double> mHeParamVector;
+    //optional buffered cycle duration stream, passed on to progenitor offspring
+    boost::shared_ptr<CycleDurationSampler> mpDurationSampler;
 
     /**
      * Protected copy-constructor for use by CreateCellCycleModel().
@@ -156,6 +158,9 @@ public:
     //Uses singleton logfile
     void EnableModeEventOutput(double eventStart, unsigned seed);
 
+    //Draw stem & progenitor cycle durations from a shared buffered sampler (see CycleDurationSampler.hpp)
+    void EnableFastDurationSampler(boost::shared_ptr<CycleDurationSampler> p_sampler);
+
     //More detailed debug output. Needs a ColumnDataWriter passed to it
     //Only declare ColumnDataWriter directory, filename, etc; do not set up otherwise
     void EnableModelDebugOutput(boost::shared_ptr<ColumnDataWriter> debugWriter);
@@ -0,0 +1,96 @@
+#ifndef TESTBOIJEGENERATIONSOLVER_HPP_
+#define TESTBOIJEGENERATIONSOLVER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "BoijeGenerationSolver.hpp"
+
+#include "FakePetscSetup.hpp"
+
+class TestBoijeGenerationSolver : public CxxTest::TestSuite
+{
+public:
+
+    void TestPhase1Doubling()
+    {
+        //default phase 2 starts after generation 3: all PP to there
+        BoijeGenerationSolver solver;
+        for (unsigned generation = 0; generation <= 3; generation++)
+        {
+            std::vector<double> distribution = solver.GetCountDistribution(BoijeGenerationSolver::CLONE_SIZE,
+                                                                           generation);
+            TS_ASSERT_DELTA(distribution[1u << generation], 1.0, 1e-12);
+        }
+
+        std::vector<std::vector<double> > events = solver.GetExpectedModeEvents(3);
+        TS_ASSERT_DELTA(events[3][0], 4.0, 1e-12);
+        TS_ASSERT_DELTA(events[3][1], 0.0, 1e-12);
+        TS_ASSERT_DELTA(events[3][2], 0.0, 1e-12);
+
+        //clone of 8 aliases onto count 0 of a range of 4
+        BoijeGenerationSolver smallSolver(3);
+        TS_ASSERT_THROWS_CONTAINS(smallSolver.GetCountDistribution(BoijeGenerationSolver::CLONE_SIZE, 3),
+                                  "increase -max_count");
+    }
+
+    void TestSinglePhase2Division()
+    {
+        //pAtoh7 .32, pPtf1a .3, png .8: PD_RGC .224, PD_AC/HC .096, DD_AC/HC .204, DD_PR/BC .3808, PP .0952
+        BoijeGenerationSolver solver;
+        solver.SetModelParameters(0, 5, 0.32, 0.3, 0.8);
+
+        std::vector<double> clone = solver.GetCountDistribution(BoijeGenerationSolver::CLONE_SIZE, 1);
+        TS_ASSERT_DELTA(clone[2], 1.0, 1e-12);
+
+        std::vector<double> rgc = solver.GetCountDistribution(BoijeGenerationSolver::RGC_COUNT, 1);
+        TS_ASSERT_DELTA(rgc[0], 0.776, 1e-12);
+        TS_ASSERT_DELTA(rgc[1], 0.224, 1e-12);
+
+        std::vector<double> acHC = solver.GetCountDistribution(BoijeGenerationSolver::AC_HC_COUNT, 1);
+        TS_ASSERT_DELTA(acHC[0], 0.7, 1e-12);
+        TS_ASSERT_DELTA(acHC[1], 0.096, 1e-12);
+        TS_ASSERT_DELTA(acHC[2], 0.204, 1e-12);
+
+        std::vector<double> prBC = solver.GetCountDistribution(BoijeGenerationSolver::PR_BC_COUNT, 1);
+        TS_ASSERT_DELTA(prBC[0], 0.6192, 1e-12);
+        TS_ASSERT_DELTA(prBC[2], 0.3808, 1e-12);
+
+        std::vector<std::vector<double> > events = solver.GetExpectedModeEvents(2);
+        TS_ASSERT_DELTA(events[1][0], 0.0952, 1e-12);
+        TS_ASSERT_DELTA(events[1][1], 0.32, 1e-12);
+        TS_ASSERT_DELTA(events[1][2], 0.5848, 1e-12);
+        //proliferative cells after generation 1: 2 * .0952 + .32
+        TS_ASSERT_DELTA(events[2][1], 0.5104 * 0.32, 1e-12);
+
+        std::map<std::string, double> sequences = solver.GetSequenceDistribution(1, 1e-12);
+        TS_ASSERT_EQUALS(sequences.size(), 3u);
+        TS_ASSERT_DELTA(sequences["0"], 0.0952, 1e-12);
+        TS_ASSERT_DELTA(sequences["1"], 0.32, 1e-12);
+        TS_ASSERT_DELTA(sequences["2"], 0.5848, 1e-12);
+    }
+
+    void TestTwoPhase3Generations()
+    {
+        //DD PR/BC w.p. .8, otherwise PP: clone of 2 (DD) or 4 (PP, then two divisions)
+        BoijeGenerationSolver solver;
+        solver.SetModelParameters(0, 0, 0.32, 0.3, 0.8);
+
+        std::vector<double> clone = solver.GetCountDistribution(BoijeGenerationSolver::CLONE_SIZE, 2);
+        TS_ASSERT_DELTA(clone[2], 0.8, 1e-12);
+        TS_ASSERT_DELTA(clone[4], 0.2, 1e-12);
+        TS_ASSERT_DELTA(std::accumulate(clone.begin(), clone.end(), 0.0), 1.0, 1e-12);
+
+        //PR/BC: 2 from a first DD or one second-generation DD; 4 from two; 0 from two PP
+        std::vector<double> prBC = solver.GetCountDistribution(BoijeGenerationSolver::PR_BC_COUNT, 2);
+        TS_ASSERT_DELTA(prBC[0], 0.2 * 0.04, 1e-12);
+        TS_ASSERT_DELTA(prBC[2], 0.8 + 0.2 * 0.32, 1e-12);
+        TS_ASSERT_DELTA(prBC[4], 0.2 * 0.64, 1e-12);
+    }
+};
+
+#endif /* TESTBOIJEGENERATIONSOLVER_HPP_ */
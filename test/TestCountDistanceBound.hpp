@@ -0,0 +1,123 @@
+#ifndef TESTCOUNTDISTANCEBOUND_HPP_
+#define TESTCOUNTDISTANCEBOUND_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CountDistanceBound.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "FakePetscSetup.hpp"
+
+class TestCountDistanceBound : public CxxTest::TestSuite
+{
+private:
+
+    /** @return the path of a reference file holding rReference */
+    std::string WriteReference(const std::vector<double>& rReference, const std::string& rFilename)
+    {
+        OutputFileHandler handler("TestCountDistanceBound", false);
+        out_stream p_file = handler.OpenOutputFile(rFilename);
+        for (unsigned k = 0; k < rReference.size(); k++)
+        {
+            *p_file << rReference[k] << "\n";
+        }
+        p_file->close();
+        return handler.GetOutputDirectoryFullPath() + rFilename;
+    }
+
+public:
+
+    void TestPartialCountProjection()
+    {
+        //reference .5, .3, .2 for counts 1-3; 7 of 10 lineages seen, all count 1
+        double reference[3] = { .5, .3, .2 };
+        CountDistanceBound bound(10, 0.05);
+        bound.ReadReference(WriteReference(std::vector<double>(reference, reference + 3), "reference"));
+        TS_ASSERT_DELTA(bound.GetLowerBound(), 0.0, 1e-12);
+
+        for (unsigned i = 0; i < 7; i++)
+        {
+            bound.AddLineage(1);
+        }
+
+        //count 1 is .2 over whatever follows; the last 3 lineages best split 2:1 over counts 2 & 3
+        //for p = (.7, .2, .1): RSS .04 + .01 + .01
+        TS_ASSERT_DELTA(bound.GetLowerBound(), 0.06, 1e-12);
+        TS_ASSERT(bound.IsExceeded());
+    }
+
+    void TestUnseenMassMayLeaveTheHistogram()
+    {
+        //reference mass .5 on count 1: one lineage of count 1 and one beyond the range meet it exactly
+        CountDistanceBound bound(2, 0.0);
+        bound.ReadReference(WriteReference(std::vector<double>(1, 0.5), "halfReference"));
+        TS_ASSERT_DELTA(bound.GetLowerBound(), 0.0, 1e-12);
+
+        bound.AddLineage(7);
+        TS_ASSERT_DELTA(bound.GetLowerBound(), 0.0, 1e-12);
+        TS_ASSERT(!bound.IsExceeded());
+
+        //a lineage of count 0 leaves no room for count 1
+        CountDistanceBound zeroBound(2, 0.0);
+        zeroBound.ReadReference(WriteReference(std::vector<double>(1, 0.5), "halfReference"));
+        zeroBound.AddLineage(0);
+        zeroBound.AddLineage(0);
+        TS_ASSERT_DELTA(zeroBound.GetLowerBound(), 0.25, 1e-12);
+    }
+
+    void TestBoundNeverExceedsFinalDistance()
+    {
+        double reference[6] = { .05, .3, .25, .2, .15, .05 };
+        std::vector<double> referenceVector(reference, reference + 6);
+        std::string referenceFile = WriteReference(referenceVector, "runReference");
+
+        std::mt19937 generator(1);
+        std::uniform_int_distribution<unsigned> countDistribution(0, 8);
+        for (unsigned run = 0; run < 20; run++)
+        {
+            const unsigned numLineages = 50;
+            std::vector<unsigned> counts(numLineages);
+            std::vector<double> histogram(referenceVector.size(), 0.0);
+            for (unsigned i = 0; i < numLineages; i++)
+            {
+                counts[i] = countDistribution(generator);
+                if (counts[i] >= 1 && counts[i] <= histogram.size()) histogram[counts[i] - 1] += 1.0 / numLineages;
+            }
+            double finalDistance = 0.0;
+            for (unsigned k = 0; k < histogram.size(); k++)
+            {
+                finalDistance += (histogram[k] - reference[k]) * (histogram[k] - reference[k]);
+            }
+
+            //the bound rises as lineages are added, never past the final RSS, which it reaches at the end
+            CountDistanceBound bound(numLineages, finalDistance);
+            bound.ReadReference(referenceFile);
+            double previousBound = bound.GetLowerBound();
+            for (unsigned i = 0; i < numLineages; i++)
+            {
+                bound.AddLineage(counts[i]);
+                double lowerBound = bound.GetLowerBound();
+                TS_ASSERT_LESS_THAN_EQUALS(previousBound, lowerBound + 1e-12);
+                TS_ASSERT_LESS_THAN_EQUALS(lowerBound, finalDistance + 1e-12);
+                previousBound = lowerBound;
+            }
+            TS_ASSERT_DELTA(bound.GetLowerBound(), finalDistance, 1e-12);
+        }
+    }
+
+    void TestExceptions()
+    {
+        TS_ASSERT_THROWS_THIS(CountDistanceBound(0, 1.0), "Count distance bound needs at least one lineage");
+
+        CountDistanceBound bound(10, 1.0);
+        TS_ASSERT_THROWS_CONTAINS(bound.ReadReference("not_a_reference_file"), "Could not open reference file");
+        TS_ASSERT_THROWS_CONTAINS(bound.ReadReference(WriteReference(std::vector<double>(), "emptyReference")),
+                                  "holds no probabilities");
+    }
+};
+
+#endif /* TESTCOUNTDISTANCEBOUND_HPP_ */
@@ -0,0 +1,100 @@
+#ifndef TESTCYCLEDURATIONSAMPLER_HPP_
+#define TESTCYCLEDURATIONSAMPLER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+
+#include "CycleDurationSampler.hpp"
+
+#include "FakePetscSetup.hpp"
+
+class TestCycleDurationSampler : public CxxTest::TestSuite
+{
+private:
+
+    static const unsigned NUM_DRAWS = 200000;
+
+    //sample mean & variance of one deviate function
+    template<class DRAW>
+    void GetMoments(DRAW draw, double& rMean, double& rVariance)
+    {
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        for (unsigned i = 0; i < NUM_DRAWS; i++)
+        {
+            double x = draw();
+            sum += x;
+            sumSquares += x * x;
+        }
+        rMean = sum / NUM_DRAWS;
+        rVariance = sumSquares / NUM_DRAWS - rMean * rMean;
+    }
+
+    //mean to 5 standard errors; variance to 5%
+    void CheckMoments(double mean, double variance, double expectedMean, double expectedVariance)
+    {
+        TS_ASSERT_DELTA(mean, expectedMean, 5.0 * sqrt(expectedVariance / NUM_DRAWS));
+        TS_ASSERT_DELTA(variance, expectedVariance, 0.05 * expectedVariance);
+    }
+
+public:
+
+    void TestDeviateMoments()
+    {
+        CycleDurationSampler sampler(1);
+        double mean, variance;
+
+        GetMoments([&]() { return sampler.Uniform(); }, mean, variance);
+        CheckMoments(mean, variance, 0.5, 1.0 / 12.0);
+
+        GetMoments([&]() { return sampler.Normal(3.0, 2.0); }, mean, variance);
+        CheckMoments(mean, variance, 3.0, 4.0);
+
+        //lognormal mean exp(mu + sigma^2/2), variance (exp(sigma^2) - 1) mean^2
+        GetMoments([&]() { return sampler.LogNormal(1.0, 0.3); }, mean, variance);
+        double logNormalMean = exp(1.0 + 0.045);
+        CheckMoments(mean, variance, logNormalMean, (exp(0.09) - 1.0) * logNormalMean * logNormalMean);
+
+        //gamma mean k theta, variance k theta^2; shape < 1 takes the boost path
+        GetMoments([&]() { return sampler.Gamma(2.0, 1.5); }, mean, variance);
+        CheckMoments(mean, variance, 3.0, 4.5);
+
+        GetMoments([&]() { return sampler.Gamma(0.5, 2.0); }, mean, variance);
+        CheckMoments(mean, variance, 1.0, 2.0);
+    }
+
+    void TestGammaTable()
+    {
+        CycleDurationSampler sampler(2);
+        sampler.SetGammaTable(2.0, 1.5);
+
+        double mean, variance;
+        GetMoments([&]() { return sampler.Gamma(2.0, 1.5); }, mean, variance);
+        CheckMoments(mean, variance, 3.0, 4.5);
+
+        //Gamma(2,1) median
+        TS_ASSERT_DELTA(CycleDurationSampler::ExactGammaQuantile(2.0, 1.0, 0.5), 1.678346990, 1e-8);
+        TS_ASSERT_DELTA(sampler.GammaQuantile(2.0, 1.5, 0.5), 1.5 * 1.678346990, 1e-4);
+        TS_ASSERT_LESS_THAN(sampler.GammaQuantile(2.0, 1.5, 0.25), sampler.GammaQuantile(2.0, 1.5, 0.75));
+
+        TS_ASSERT_THROWS_THIS(sampler.SetGammaTable(0.0, 1.5),
+                              "Gamma table requires shape > 0, scale > 0 and resolution >= 2");
+    }
+
+    void TestReseed()
+    {
+        CycleDurationSampler sampler(3);
+        double first[3] = { sampler.Uniform(), sampler.StandardNormal(), sampler.Gamma(2.0, 1.0) };
+
+        sampler.Reseed(4);
+        TS_ASSERT_DIFFERS(sampler.Uniform(), first[0]);
+
+        sampler.Reseed(3);
+        TS_ASSERT_EQUALS(sampler.Uniform(), first[0]);
+        TS_ASSERT_EQUALS(sampler.StandardNormal(), first[1]);
+        TS_ASSERT_EQUALS(sampler.Gamma(2.0, 1.0), first[2]);
+    }
+};
+
+#endif /* TESTCYCLEDURATIONSAMPLER_HPP_ */
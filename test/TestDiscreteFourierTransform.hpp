@@ -0,0 +1,94 @@
+#ifndef TESTDISCRETEFOURIERTRANSFORM_HPP_
+#define TESTDISCRETEFOURIERTRANSFORM_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "DiscreteFourierTransform.hpp"
+
+#include "FakePetscSetup.hpp"
+
+class TestDiscreteFourierTransform : public CxxTest::TestSuite
+{
+private:
+
+    //PGF of a pmf on counts 0,1,... at each of the given points, by Horner's rule
+    std::vector<std::complex<double> > EvaluatePolynomial(const std::vector<double>& rPmf,
+                                                          const std::vector<std::complex<double> >& rPoints)
+    {
+        std::vector<std::complex<double> > values(rPoints.size());
+        for (unsigned j = 0; j < rPoints.size(); j++)
+        {
+            for (unsigned m = rPmf.size(); m-- > 0;)
+            {
+                values[j] = values[j] * rPoints[j] + rPmf[m];
+            }
+        }
+        return values;
+    }
+
+public:
+
+    void TestForwardFFTMatchesDirectSum()
+    {
+        unsigned n = 16;
+        std::vector<std::complex<double> > data(n);
+        for (unsigned j = 0; j < n; j++)
+        {
+            data[j] = std::complex<double>(sin(0.7 * j) + 0.1 * j, cos(1.3 * j));
+        }
+
+        std::vector<std::complex<double> > transformed(data);
+        ForwardFFT(transformed);
+
+        for (unsigned m = 0; m < n; m++)
+        {
+            std::complex<double> direct(0.0, 0.0);
+            for (unsigned j = 0; j < n; j++)
+            {
+                direct += data[j] * std::polar(1.0, -2.0 * M_PI * j * m / n);
+            }
+            TS_ASSERT_DELTA(transformed[m].real(), direct.real(), 1e-12);
+            TS_ASSERT_DELTA(transformed[m].imag(), direct.imag(), 1e-12);
+        }
+    }
+
+    void TestInvertPGFRoundTrip()
+    {
+        unsigned n = 8;
+        std::vector<double> pmf = { 0.05, 0.2, 0.0, 0.3, 0.1, 0.15, 0.0, 0.2 };
+
+        std::vector<std::complex<double> > points = GetPGFPoints(n);
+        TS_ASSERT_EQUALS(points.size(), n / 2 + 2);
+        TS_ASSERT_DELTA(pow(points[n / 2 + 1].real(), n), 0.5, 1e-12);
+
+        std::vector<double> inverted = InvertPGF(EvaluatePolynomial(pmf, points), n);
+        TS_ASSERT_EQUALS(inverted.size(), n);
+        for (unsigned m = 0; m < n; m++)
+        {
+            TS_ASSERT_DELTA(inverted[m], pmf[m], 1e-12);
+        }
+    }
+
+    void TestInvertPGFDetectsAliasedMass()
+    {
+        unsigned n = 8;
+        std::vector<std::complex<double> > points = GetPGFPoints(n);
+
+        //mass at count 9 wraps onto count 1
+        std::vector<double> pmf = { 0.5, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.5 };
+        TS_ASSERT_THROWS_CONTAINS(InvertPGF(EvaluatePolynomial(pmf, points), n), "increase -max_count");
+
+        //accepted below the tolerance, and still folded onto count mod N
+        pmf[0] = 1.0 - 1e-9;
+        pmf[9] = 1e-9;
+        std::vector<double> inverted = InvertPGF(EvaluatePolynomial(pmf, points), n);
+        TS_ASSERT_DELTA(inverted[0], 1.0 - 1e-9, 1e-12);
+        TS_ASSERT_DELTA(inverted[1], 1e-9, 1e-12);
+    }
+};
+
+#endif /* TESTDISCRETEFOURIERTRANSFORM_HPP_ */
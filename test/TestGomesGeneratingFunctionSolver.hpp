@@ -0,0 +1,70 @@
+#ifndef TESTGOMESGENERATINGFUNCTIONSOLVER_HPP_
+#define TESTGOMESGENERATINGFUNCTIONSOLVER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <numeric>
+#include <vector>
+
+#include "GomesGeneratingFunctionSolver.hpp"
+
+#include "FakePetscSetup.hpp"
+
+class TestGomesGeneratingFunctionSolver : public CxxTest::TestSuite
+{
+public:
+
+    void TestCountDistributionsSumToOne()
+    {
+        GomesGeneratingFunctionSolver solver;
+        TS_ASSERT_EQUALS(solver.GetCountRange(), 256u);
+
+        for (unsigned countType = GomesGeneratingFunctionSolver::CLONE_SIZE;
+                countType <= GomesGeneratingFunctionSolver::MG_COUNT; countType++)
+        {
+            std::vector<double> distribution = solver.GetCountDistribution(
+                    (GomesGeneratingFunctionSolver::CountType) countType, 80.0);
+            TS_ASSERT_EQUALS(distribution.size(), 256u);
+            TS_ASSERT_DELTA(std::accumulate(distribution.begin(), distribution.end(), 0.0), 1.0, 1e-9);
+        }
+    }
+
+    void TestHandCheckedDistributions()
+    {
+        GomesGeneratingFunctionSolver solver;
+
+        //no divisions by the end time: the founder alone
+        std::vector<double> founder = solver.GetCountDistribution(GomesGeneratingFunctionSolver::CLONE_SIZE, 0.0);
+        TS_ASSERT_DELTA(founder[1], 1.0, 1e-12);
+
+        //all DD: one division (the lognormal cycle is < 400 h to ~1e-10), each daughter AC w.p. 0.25
+        solver.SetModelParameters(3.9716, 0.32839, 0.0, 0.0, 0.25, 0.25, 0.0);
+        std::vector<double> clone = solver.GetCountDistribution(GomesGeneratingFunctionSolver::CLONE_SIZE, 400.0);
+        TS_ASSERT_DELTA(clone[2], 1.0, 1e-8);
+
+        std::vector<double> ac = solver.GetCountDistribution(GomesGeneratingFunctionSolver::AC_COUNT, 400.0);
+        TS_ASSERT_DELTA(ac[0], 0.5625, 1e-8);
+        TS_ASSERT_DELTA(ac[1], 0.375, 1e-8);
+        TS_ASSERT_DELTA(ac[2], 0.0625, 1e-8);
+
+        std::vector<double> rph = solver.GetCountDistribution(GomesGeneratingFunctionSolver::RPH_COUNT, 400.0);
+        TS_ASSERT_DELTA(rph[0], 0.25, 1e-8);
+        TS_ASSERT_DELTA(rph[1], 0.5, 1e-8);
+        TS_ASSERT_DELTA(rph[2], 0.25, 1e-8);
+    }
+
+    void TestCountRangeTooSmallThrows()
+    {
+        //all PP clones outgrow 15 cells by 200 h
+        GomesGeneratingFunctionSolver solver(0.25, 15);
+        solver.SetModelParameters(3.9716, 0.32839, 1.0, 0.0);
+        TS_ASSERT_EQUALS(solver.GetCountRange(), 16u);
+        TS_ASSERT_THROWS_NOTHING(solver.GetCountDistribution(GomesGeneratingFunctionSolver::CLONE_SIZE, 100.0));
+        TS_ASSERT_THROWS_CONTAINS(solver.GetCountDistribution(GomesGeneratingFunctionSolver::CLONE_SIZE, 200.0),
+                                  "increase -max_count");
+
+        TS_ASSERT_THROWS_THIS(GomesGeneratingFunctionSolver(0.0), "Solver timestep must be > 0");
+    }
+};
+
+#endif /* TESTGOMESGENERATINGFUNCTIONSOLVER_HPP_ */
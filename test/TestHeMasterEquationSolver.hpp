@@ -0,0 +1,152 @@
+#ifndef TESTHEMASTEREQUATIONSOLVER_HPP_
+#define TESTHEMASTEREQUATIONSOLVER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "HeMasterEquationSolver.hpp"
+
+#include "FakePetscSetup.hpp"
+
+class TestHeMasterEquationSolver : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * Independent Monte Carlo of one stochastic He lineage on the solver's grid, founder at TiL 0: cycles are
+     * shift + Gamma(shape, scale) rounded up to whole steps, PP sisters max(shift, cycle + N(0, sisterShift)).
+     *
+     * @return the clone size at the end step
+     */
+    unsigned SimulateLineage(std::mt19937& rGenerator, double dt, unsigned endStep, double phase2, double pPP[2],
+                             double pPD[2])
+    {
+        std::gamma_distribution<double> gamma(2.0, 1.0);
+        std::normal_distribution<double> sisterShift(0.0, 1.0);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+        unsigned count = 0;
+        std::vector<unsigned> divisionSteps(1, 0);
+        while (!divisionSteps.empty())
+        {
+            unsigned step = divisionSteps.back();
+            divisionSteps.pop_back();
+            if (step > endStep)
+            {
+                count++;
+                continue;
+            }
+
+            unsigned phase = (step * dt > phase2) ? 1 : 0;
+            double mode = uniform(rGenerator);
+            double cycle = 4.0 + gamma(rGenerator);
+            if (mode < pPP[phase])
+            {
+                double sisterCycle = std::max(4.0, cycle + sisterShift(rGenerator));
+                divisionSteps.push_back(step + (unsigned) ceil(cycle / dt));
+                divisionSteps.push_back(step + (unsigned) ceil(sisterCycle / dt));
+            }
+            else if (mode < pPP[phase] + pPD[phase])
+            {
+                count++;
+                divisionSteps.push_back(step + (unsigned) ceil(cycle / dt));
+            }
+            else
+            {
+                count += 2;
+            }
+        }
+        return count;
+    }
+
+public:
+
+    void TestHeFixtureMassSumsToOne()
+    {
+        HeMasterEquationSolver solver;
+        solver.SetModelParameters();
+
+        double inductionTimes[3] = { 24.0, 32.0, 48.0 };
+        for (unsigned i = 0; i < 3; i++)
+        {
+            solver.SolveHeFixture(inductionTimes[i], 23.0, 39.0, 72.0);
+            const std::vector<double>& r_distribution = solver.rGetCountDistribution();
+            TS_ASSERT_EQUALS(r_distribution.size(), 256u);
+            TS_ASSERT_DELTA(std::accumulate(r_distribution.begin(), r_distribution.end(), 0.0), 1.0, 1e-6);
+            TS_ASSERT_DELTA(r_distribution[0], 0.0, 1e-12);
+
+            const std::vector<std::vector<double> >& r_rates = solver.rGetModeRates();
+            for (unsigned hour = 0; hour < r_rates.size(); hour++)
+            {
+                for (unsigned mode = 0; mode < 3; mode++)
+                {
+                    TS_ASSERT_LESS_THAN_EQUALS(0.0, r_rates[hour][mode]);
+                }
+            }
+        }
+
+        TS_ASSERT_THROWS_THIS(solver.SolveHeFixture(24.0, 23.0, 39.0, 72.0, 0),
+                              "At least one lineage start time node is required");
+    }
+
+    void TestAllDDLineage()
+    {
+        //every division DD: the founder divides once into two postmitotic cells
+        HeMasterEquationSolver solver;
+        solver.SetModelParameters(8, 15, 0, 0, 0, 0, 0, 0);
+        solver.SolveValidationFixture(0.0, 100.0);
+
+        const std::vector<double>& r_distribution = solver.rGetCountDistribution();
+        TS_ASSERT_DELTA(r_distribution[2], 1.0, 1e-9);
+
+        const std::vector<std::vector<double> >& r_rates = solver.rGetModeRates();
+        double dd = 0.0;
+        for (unsigned hour = 0; hour < r_rates.size(); hour++)
+        {
+            TS_ASSERT_DELTA(r_rates[hour][0], 0.0, 1e-12);
+            TS_ASSERT_DELTA(r_rates[hour][1], 0.0, 1e-12);
+            dd += r_rates[hour][2];
+        }
+        TS_ASSERT_DELTA(dd, 1.0, 1e-9);
+    }
+
+    void TestTwoPhaseLineageAgainstMonteCarlo()
+    {
+        //phase 1 PP .7, PD .2; phase 2 from TiL 8 h, PP .2, PD .4; 16 h covers two to three generations
+        HeMasterEquationSolver solver;
+        solver.SetModelParameters(8, 100, .7, .2, .2, .4, .2, .4);
+        solver.SolveValidationFixture(0.0, 16.0);
+        const std::vector<double>& r_distribution = solver.rGetCountDistribution();
+
+        double pPP[2] = { .7, .2 };
+        double pPD[2] = { .2, .4 };
+        const unsigned num_lineages = 200000;
+        std::mt19937 generator(1);
+        std::vector<double> frequencies(r_distribution.size(), 0.0);
+        for (unsigned lineage = 0; lineage < num_lineages; lineage++)
+        {
+            frequencies[SimulateLineage(generator, 0.25, 64, 8.0, pPP, pPD)] += 1.0 / num_lineages;
+        }
+
+        //each count probability to 4 standard errors, with a margin for the sister quadrature
+        for (unsigned count = 0; count < r_distribution.size(); count++)
+        {
+            double standardError = sqrt(r_distribution[count] * (1.0 - r_distribution[count]) / num_lineages);
+            TS_ASSERT_DELTA(frequencies[count], r_distribution[count], 4.0 * standardError + 1e-4);
+        }
+    }
+
+    void TestCountRangeTooSmallThrows()
+    {
+        HeMasterEquationSolver solver(0.25, 7);
+        solver.SetModelParameters();
+        TS_ASSERT_THROWS_CONTAINS(solver.SolveHeFixture(24.0, 23.0, 39.0, 72.0), "increase -max_count");
+    }
+};
+
+#endif /* TESTHEMASTEREQUATIONSOLVER_HPP_ */
@@ -0,0 +1,108 @@
+#ifndef TESTHEMODELIKELIHOODRECORDER_HPP_
+#define TESTHEMODELIKELIHOODRECORDER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "HeModeLikelihoodRecorder.hpp"
+
+#include "FakePetscSetup.hpp"
+
+class TestHeModeLikelihoodRecorder : public CxxTest::TestSuite
+{
+public:
+
+    void TestModeCounts()
+    {
+        HeModeLikelihoodRecorder recorder;
+        recorder.RecordDivision(1, 0);
+        recorder.RecordDivision(1, 0);
+        recorder.RecordDivision(2, 1);
+        recorder.RecordDivision(3, 2);
+
+        TS_ASSERT_EQUALS(recorder.GetModeCount(1, 0), 2u);
+        TS_ASSERT_EQUALS(recorder.GetModeCount(2, 1), 1u);
+        TS_ASSERT_EQUALS(recorder.GetModeCount(3, 2), 1u);
+        TS_ASSERT_EQUALS(recorder.GetModeCount(2, 0), 0u);
+
+        recorder.Reset();
+        for (unsigned phase = 1; phase <= 3; phase++)
+        {
+            for (unsigned mode = 0; mode < 3; mode++)
+            {
+                TS_ASSERT_EQUALS(recorder.GetModeCount(phase, mode), 0u);
+            }
+        }
+        TS_ASSERT_DELTA(recorder.GetLogLikelihood(std::vector<double>(6, 0.0), false), 0.0, 1e-12);
+    }
+
+    void TestModeProbabilities()
+    {
+        double probabilities[6] = { 1, 0, .2, .4, .2, 0 };
+        std::vector<double> phaseProbabilities(probabilities, probabilities + 6);
+
+        TS_ASSERT_DELTA(HeModeLikelihoodRecorder::GetModeProbability(phaseProbabilities, 1, 0, false), 1.0, 1e-12);
+        TS_ASSERT_DELTA(HeModeLikelihoodRecorder::GetModeProbability(phaseProbabilities, 2, 1, false), 0.4, 1e-12);
+        TS_ASSERT_DELTA(HeModeLikelihoodRecorder::GetModeProbability(phaseProbabilities, 2, 2, false), 0.4, 1e-12);
+        TS_ASSERT_DELTA(HeModeLikelihoodRecorder::GetModeProbability(phaseProbabilities, 3, 2, false), 0.8, 1e-12);
+
+        //Ath5 morphants: PP .2 + .8 * .4, PD .2 * .4, DD unchanged
+        TS_ASSERT_DELTA(HeModeLikelihoodRecorder::GetModeProbability(phaseProbabilities, 2, 0, true), 0.52, 1e-12);
+        TS_ASSERT_DELTA(HeModeLikelihoodRecorder::GetModeProbability(phaseProbabilities, 2, 1, true), 0.08, 1e-12);
+        TS_ASSERT_DELTA(HeModeLikelihoodRecorder::GetModeProbability(phaseProbabilities, 2, 2, true), 0.4, 1e-12);
+    }
+
+    void TestLogLikelihood()
+    {
+        double probabilities[6] = { 1, 0, .2, .4, .2, 0 };
+        std::vector<double> phaseProbabilities(probabilities, probabilities + 6);
+
+        //PP in phase 1, PP, PD & two DD in phase 2, DD in phase 3
+        HeModeLikelihoodRecorder recorder;
+        recorder.RecordDivision(1, 0);
+        recorder.RecordDivision(2, 0);
+        recorder.RecordDivision(2, 1);
+        recorder.RecordDivision(2, 2);
+        recorder.RecordDivision(2, 2);
+        recorder.RecordDivision(3, 2);
+        TS_ASSERT_DELTA(recorder.GetLogLikelihood(phaseProbabilities, false), log(.2 * .4 * .4 * .4 * .8), 1e-12);
+        TS_ASSERT_DELTA(recorder.GetLogLikelihood(phaseProbabilities, true), log(.52 * .08 * .4 * .4 * .8), 1e-12);
+
+        //a phase 3 PD has probability 0
+        recorder.RecordDivision(3, 1);
+        double logLikelihood = recorder.GetLogLikelihood(phaseProbabilities, false);
+        TS_ASSERT_EQUALS(logLikelihood, -std::numeric_limits<double>::infinity());
+    }
+
+    void TestTiltedProbabilities()
+    {
+        double probabilities[6] = { 1, 0, .2, .4, .2, 0 };
+        std::vector<double> target(probabilities, probabilities + 6);
+
+        //PP halfway to 1, PD & DD halved; phase 1 (PP = 1) unchanged
+        std::vector<double> proposal = HeModeLikelihoodRecorder::GetTiltedProbabilities(target, 0.5);
+        double expected[6] = { 1, 0, .6, .2, .6, 0 };
+        for (unsigned i = 0; i < 6; i++)
+        {
+            TS_ASSERT_DELTA(proposal[i], expected[i], 1e-12);
+        }
+
+        std::vector<double> untilted = HeModeLikelihoodRecorder::GetTiltedProbabilities(target, 0.0);
+        for (unsigned i = 0; i < 6; i++)
+        {
+            TS_ASSERT_DELTA(untilted[i], target[i], 1e-12);
+        }
+
+        //phase 2 PP then DD: target .2 * .4, proposal .6 * .2, so the lineage's weight is 2/3
+        HeModeLikelihoodRecorder recorder;
+        recorder.RecordDivision(2, 0);
+        recorder.RecordDivision(2, 2);
+        double weight = exp(recorder.GetLogLikelihood(target, false) - recorder.GetLogLikelihood(proposal, false));
+        TS_ASSERT_DELTA(weight, 2.0 / 3.0, 1e-12);
+    }
+};
+
+#endif /* TESTHEMODELIKELIHOODRECORDER_HPP_ */
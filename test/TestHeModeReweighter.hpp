@@ -0,0 +1,143 @@
+#ifndef TESTHEMODEREWEIGHTER_HPP_
+#define TESTHEMODEREWEIGHTER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "HeModeLikelihoodRecorder.hpp"
+#include "HeModeReweighter.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "PetscSetupAndFinalize.hpp"
+
+class TestHeModeReweighter : public CxxTest::TestSuite
+{
+public:
+
+    void TestProbabilityValidation()
+    {
+        double simulated[6] = { 1, 0, .2, .4, .2, 0 };
+        double negative[6] = { 1, 0, -.1, .4, .2, 0 };
+        double overOne[6] = { 1, 0, .7, .4, .2, 0 };
+
+        TS_ASSERT_THROWS_THIS(HeModeReweighter(std::vector<double>(5, 0.0), false),
+                              "Simulated phase probabilities must be pPP1, pPD1, pPP2, pPD2, pPP3, pPD3");
+        TS_ASSERT_THROWS_THIS(HeModeReweighter(std::vector<double>(overOne, overOne + 6), false),
+                              "Simulated phase probabilities must lie in [0,1] with pPP + pPD <= 1 in each phase");
+
+        HeModeReweighter reweighter(std::vector<double>(simulated, simulated + 6), false);
+        TS_ASSERT_THROWS_THIS(reweighter.AddAlternative(std::vector<double>(negative, negative + 6)),
+                              "Alternative phase probabilities must lie in [0,1] with pPP + pPD <= 1 in each phase");
+        TS_ASSERT_THROWS_THIS(reweighter.AddAlternative(std::vector<double>(overOne, overOne + 6)),
+                              "Alternative phase probabilities must lie in [0,1] with pPP + pPD <= 1 in each phase");
+        TS_ASSERT_EQUALS(reweighter.GetNumAlternatives(), 0u);
+
+        //a file with an invalid line is rejected at that line
+        OutputFileHandler handler("TestHeModeReweighter");
+        out_stream p_file = handler.OpenOutputFile("alternatives");
+        *p_file << "# pPP1 pPD1 pPP2 pPD2 pPP3 pPD3\n1 0 .2 .4 .2 0\n1 0 .2 .4 1.2 0\n";
+        p_file->close();
+        TS_ASSERT_THROWS_THIS(reweighter.ReadAlternatives(handler.GetOutputDirectoryFullPath() + "alternatives"),
+                              "Alternative phase probabilities must lie in [0,1] with pPP + pPD <= 1 in each phase");
+        TS_ASSERT_EQUALS(reweighter.GetNumAlternatives(), 1u);
+    }
+
+    void TestTwoDivisionLineageWeights()
+    {
+        /**
+         * Simulated phase 2 PP .2, PD .4, DD .4; alternative phase 2 PP .3, PD .3, DD .4.
+         * Lineage A: phase 1 PP, phase 2 PD, count 2; weight (1 * .3) / (1 * .4) = .75.
+         * Lineage B: phase 1 PP, phase 2 DD, count 3; weight (1 * .4) / (1 * .4) = 1.
+         * Self-normalised histogram .75/1.75, 1/1.75; ESS 1.75^2 / (.75^2 + 1^2) = 1.96.
+         */
+        double simulated[6] = { 1, 0, .2, .4, .2, 0 };
+        double alternative[6] = { 1, 0, .3, .3, .2, 0 };
+        HeModeReweighter reweighter(std::vector<double>(simulated, simulated + 6), false);
+        reweighter.AddAlternative(std::vector<double>(simulated, simulated + 6));
+        reweighter.AddAlternative(std::vector<double>(alternative, alternative + 6));
+        TS_ASSERT_EQUALS(reweighter.GetNumAlternatives(), 2u);
+
+        HeModeLikelihoodRecorder lineageA;
+        lineageA.RecordDivision(1, 0);
+        lineageA.RecordDivision(2, 1);
+        reweighter.AddLineage(lineageA, 2);
+
+        HeModeLikelihoodRecorder lineageB;
+        lineageB.RecordDivision(1, 0);
+        lineageB.RecordDivision(2, 2);
+        reweighter.AddLineage(lineageB, 3);
+
+        reweighter.WriteSummary("TestHeModeReweighter", "summary");
+
+        OutputFileHandler handler("TestHeModeReweighter", false);
+        std::ifstream summaryFile((handler.GetOutputDirectoryFullPath() + "summary").c_str());
+        TS_ASSERT(summaryFile.is_open());
+
+        std::string label, line;
+        unsigned numLineages;
+        summaryFile >> label >> numLineages;
+        TS_ASSERT_EQUALS(label, "Lineages");
+        TS_ASSERT_EQUALS(numLineages, 2u);
+        std::getline(summaryFile, line);
+        std::getline(summaryFile, line);
+
+        //rows: alternative, 6 probabilities, covered, ESS, count, probability; counts 0-3 for each alternative
+        double expectedProbabilities[2][4] = { { 0, 0, 0.5, 0.5 }, { 0, 0, .75 / 1.75, 1 / 1.75 } };
+        double expectedESS[2] = { 2.0, 1.96 };
+        for (unsigned i = 0; i < 2; i++)
+        {
+            for (unsigned count = 0; count < 4; count++)
+            {
+                unsigned alternativeIndex, covered, rowCount;
+                double probability, ess, phaseProbability;
+                summaryFile >> alternativeIndex;
+                for (unsigned j = 0; j < 6; j++)
+                {
+                    summaryFile >> phaseProbability;
+                }
+                summaryFile >> covered >> ess >> rowCount >> probability;
+
+                TS_ASSERT_EQUALS(alternativeIndex, i);
+                TS_ASSERT_EQUALS(covered, 1u);
+                TS_ASSERT_DELTA(ess, expectedESS[i], 1e-4);
+                TS_ASSERT_EQUALS(rowCount, count);
+                TS_ASSERT_DELTA(probability, expectedProbabilities[i][count], 1e-5);
+            }
+        }
+    }
+
+    void TestUncoveredAlternative()
+    {
+        //phase 1 PD never happens in the simulations, so an alternative allowing it is not covered
+        double simulated[6] = { 1, 0, .2, .4, .2, 0 };
+        double alternative[6] = { .9, .1, .2, .4, .2, 0 };
+        HeModeReweighter reweighter(std::vector<double>(simulated, simulated + 6), false);
+        reweighter.AddAlternative(std::vector<double>(alternative, alternative + 6));
+
+        HeModeLikelihoodRecorder lineage;
+        lineage.RecordDivision(1, 0);
+        reweighter.AddLineage(lineage, 2);
+        reweighter.WriteSummary("TestHeModeReweighter", "uncovered");
+
+        OutputFileHandler handler("TestHeModeReweighter", false);
+        std::ifstream summaryFile((handler.GetOutputDirectoryFullPath() + "uncovered").c_str());
+        std::string line;
+        std::getline(summaryFile, line);
+        std::getline(summaryFile, line);
+
+        unsigned alternativeIndex, covered;
+        double phaseProbability;
+        summaryFile >> alternativeIndex;
+        for (unsigned j = 0; j < 6; j++)
+        {
+            summaryFile >> phaseProbability;
+        }
+        summaryFile >> covered;
+        TS_ASSERT_EQUALS(covered, 0u);
+    }
+};
+
+#endif /* TESTHEMODEREWEIGHTER_HPP_ */
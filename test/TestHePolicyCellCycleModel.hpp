@@ -0,0 +1,164 @@
+#ifndef TESTHEPOLICYCELLCYCLEMODEL_HPP_
+#define TESTHEPOLICYCELLCYCLEMODEL_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CellId.hpp"
+#include "CellLabel.hpp"
+#include "EventOutputBuffer.hpp"
+#include "LogFile.hpp"
+#include "OutputFileHandler.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SimulationTime.hpp"
+#include "SmartPointers.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "HeAth5Mo.hpp"
+#include "HeCellCycleModel.hpp"
+#include "HePolicyCellCycleModel.hpp"
+
+#include "FakePetscSetup.hpp"
+
+class TestHePolicyCellCycleModel : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Divide one lineage to 48 h without a population, writing its mode events (or sampled sequence) to the log
+     * through the event buffer, as the simulators do
+     *
+     * @param p_model the founder's model, set up but not yet attached to a cell
+     * @param seed the RNG seed
+     * @param ath5 whether the founder carries the Ath5 morpholino
+     * @param sequence whether to sample a sequence rather than log mode events
+     * @return the log contents, followed by the final cell count
+     */
+    std::string RunLineage(HeCellCycleModel* p_model, unsigned seed, bool ath5, bool sequence)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(48.0, 960);
+        RandomNumberGenerator::Instance()->Reseed(seed);
+        CellId::ResetMaxCellId();
+
+        LogFile* p_log = LogFile::Instance();
+        p_log->Set(0, "TestHePolicyCellCycleModel", "lineage");
+        EventOutputBuffer::Instance()->BeginSeed(seed);
+
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(TransitCellProliferativeType, p_mitotic);
+        MAKE_PTR(Ath5Mo, p_morpholino);
+        MAKE_PTR(CellLabel, p_label);
+
+        p_model->SetDimension(2);
+        if (sequence)
+        {
+            p_model->EnableSequenceSampler();
+        }
+        else
+        {
+            p_model->EnableModeEventOutput(0.0, seed);
+        }
+
+        std::vector<CellPtr> cells;
+        CellPtr p_founder(new Cell(p_state, p_model));
+        p_founder->SetCellProliferativeType(p_mitotic);
+        if (ath5) p_founder->AddCellProperty(p_morpholino);
+        if (sequence) p_founder->AddCellProperty(p_label);
+        p_founder->InitialiseCellCycleModel();
+        cells.push_back(p_founder);
+
+        while (!SimulationTime::Instance()->IsFinished())
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            unsigned numCells = cells.size();
+            for (unsigned i = 0; i < numCells; i++)
+            {
+                if (cells[i]->ReadyToDivide())
+                {
+                    cells.push_back(cells[i]->Divide());
+                }
+            }
+        }
+        EventOutputBuffer::MergeToLog();
+        LogFile::Close();
+
+        OutputFileHandler handler("TestHePolicyCellCycleModel", false);
+        std::ifstream logFile((handler.GetOutputDirectoryFullPath() + "lineage").c_str());
+        std::stringstream contents;
+        contents << logFile.rdbuf() << "\nCells\t" << cells.size() << "\n";
+        return contents.str();
+    }
+
+public:
+
+    void TestStochasticLineagesMatchRuntimeModel()
+    {
+        typedef HePolicyCellCycleModel<HeStochasticMode, HeModeEventLogOutput, HeNoSequenceSampler, HeKeepSpecified>
+                PolicyModel;
+
+        for (unsigned seed = 1; seed <= 5; seed++)
+        {
+            for (unsigned ath5 = 0; ath5 <= 1; ath5++)
+            {
+                HeCellCycleModel* p_runtime = new HeCellCycleModel;
+                p_runtime->SetModelParameters();
+                std::string runtimeLog = RunLineage(p_runtime, seed, ath5, false);
+
+                HeCellCycleModel* p_policy = new PolicyModel;
+                p_policy->SetModelParameters();
+                std::string policyLog = RunLineage(p_policy, seed, ath5, false);
+
+                TS_ASSERT_EQUALS(policyLog, runtimeLog);
+                //events were logged: phase 1 divisions are PP
+                TS_ASSERT_DIFFERS(runtimeLog.find("\t0\n"), std::string::npos);
+            }
+        }
+    }
+
+    void TestDeterministicLineagesMatchRuntimeModel()
+    {
+        typedef HePolicyCellCycleModel<HeDeterministicMode, HeModeEventLogOutput, HeNoSequenceSampler, HeKeepSpecified>
+                PolicyModel;
+
+        for (unsigned seed = 1; seed <= 5; seed++)
+        {
+            HeCellCycleModel* p_runtime = new HeCellCycleModel;
+            p_runtime->SetDeterministicMode();
+            std::string runtimeLog = RunLineage(p_runtime, seed, true, false);
+
+            HeCellCycleModel* p_policy = new PolicyModel;
+            p_policy->SetDeterministicMode();
+            std::string policyLog = RunLineage(p_policy, seed, true, false);
+
+            TS_ASSERT_EQUALS(policyLog, runtimeLog);
+        }
+    }
+
+    void TestSequencesMatchRuntimeModel()
+    {
+        typedef HePolicyCellCycleModel<HeStochasticMode, HeNoModeEventOutput, HeSequenceSampler, HeKeepSpecified>
+                PolicyModel;
+
+        for (unsigned seed = 1; seed <= 5; seed++)
+        {
+            HeCellCycleModel* p_runtime = new HeCellCycleModel;
+            p_runtime->SetModelParameters();
+            std::string runtimeLog = RunLineage(p_runtime, seed, false, true);
+
+            HeCellCycleModel* p_policy = new PolicyModel;
+            p_policy->SetModelParameters();
+            std::string policyLog = RunLineage(p_policy, seed, false, true);
+
+            TS_ASSERT_EQUALS(policyLog, runtimeLog);
+        }
+    }
+};
+
+#endif /* TESTHEPOLICYCELLCYCLEMODEL_HPP_ */
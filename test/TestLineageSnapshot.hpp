@@ -0,0 +1,137 @@
+#ifndef TESTLINEAGESNAPSHOT_HPP_
+#define TESTLINEAGESNAPSHOT_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <set>
+#include <vector>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CellLabel.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "HoneycombMeshGenerator.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "SimulationTime.hpp"
+#include "SmartPointers.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "HeCellCycleModel.hpp"
+#include "LineageSnapshot.hpp"
+
+#include "FakePetscSetup.hpp"
+
+class TestLineageSnapshot : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestSnapshotCopiesProliferativeCells()
+    {
+        //a labelled lineage divided to 30 h; every division after 8 h is PD, leaving postmitotic & mitotic cells
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(30.0, 600);
+
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(TransitCellProliferativeType, p_mitotic);
+        MAKE_PTR(CellLabel, p_label);
+
+        HeCellCycleModel* p_model = new HeCellCycleModel;
+        p_model->SetDimension(2);
+        p_model->SetModelParameters(0, 8, 100, 1, 0, 0, 1, 0, 1);
+        std::vector<CellPtr> cells;
+        CellPtr p_founder(new Cell(p_state, p_model));
+        p_founder->SetCellProliferativeType(p_mitotic);
+        p_founder->AddCellProperty(p_label);
+        p_founder->InitialiseCellCycleModel();
+        cells.push_back(p_founder);
+
+        while (!SimulationTime::Instance()->IsFinished())
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            unsigned numCells = cells.size();
+            for (unsigned i = 0; i < numCells; i++)
+            {
+                if (cells[i]->ReadyToDivide())
+                {
+                    cells.push_back(cells[i]->Divide());
+                }
+            }
+        }
+
+        HoneycombMeshGenerator generator(1, cells.size());
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*generator.GetMesh(), 1.5);
+        NodeBasedCellPopulation<2> population(mesh, cells);
+
+        std::vector<CellPtr> proliferativeCells;
+        unsigned numPostMitotic = 0;
+        for (AbstractCellPopulation<2>::Iterator cell_iter = population.Begin(); cell_iter != population.End();
+                ++cell_iter)
+        {
+            if ((*cell_iter)->GetCellProliferativeType()->IsType<DifferentiatedCellProliferativeType>())
+            {
+                numPostMitotic++;
+            }
+            else
+            {
+                proliferativeCells.push_back(*cell_iter);
+            }
+        }
+        TS_ASSERT_LESS_THAN(0u, numPostMitotic);
+        TS_ASSERT_LESS_THAN(0u, proliferativeCells.size());
+
+        std::vector<boost::shared_ptr<AbstractCellProperty> > carriedProperties(1, p_label);
+        LineageSnapshot snapshot(population, carriedProperties);
+        TS_ASSERT_EQUALS(snapshot.GetNumProliferativeCells(), proliferativeCells.size());
+        TS_ASSERT_EQUALS(snapshot.GetPostMitoticCount(), numPostMitotic);
+
+        //each continuation gets fresh copies of the running cycles, attached without being redrawn
+        std::vector<CellPtr> forkedCells = snapshot.CreateCells(p_state);
+        std::vector<CellPtr> secondForkedCells = snapshot.CreateCells(p_state);
+        TS_ASSERT_EQUALS(forkedCells.size(), proliferativeCells.size());
+        for (unsigned i = 0; i < forkedCells.size(); i++)
+        {
+            AbstractCellCycleModel* p_original = proliferativeCells[i]->GetCellCycleModel();
+            AbstractCellCycleModel* p_forked = forkedCells[i]->GetCellCycleModel();
+            TS_ASSERT_DIFFERS(p_forked, p_original);
+            TS_ASSERT_DIFFERS(p_forked, secondForkedCells[i]->GetCellCycleModel());
+            TS_ASSERT_EQUALS(p_forked->GetCell(), forkedCells[i]);
+            TS_ASSERT_DELTA(p_forked->GetBirthTime(), p_original->GetBirthTime(), 1e-12);
+            TS_ASSERT(forkedCells[i]->GetCellProliferativeType()->IsType<TransitCellProliferativeType>());
+            TS_ASSERT(forkedCells[i]->HasCellProperty<CellLabel>());
+        }
+
+        //copied cycle durations: forked cells come due at the same steps as the originals
+        SimulationTime::Instance()->ResetEndTimeAndNumberOfTimeSteps(50.0, 400);
+        while (!SimulationTime::Instance()->IsFinished())
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            for (unsigned i = 0; i < forkedCells.size(); i++)
+            {
+                TS_ASSERT_EQUALS(forkedCells[i]->GetCellCycleModel()->ReadyToDivide(),
+                                 proliferativeCells[i]->GetCellCycleModel()->ReadyToDivide());
+            }
+        }
+    }
+
+    void TestContinuationSeeds()
+    {
+        //reproducible, and distinct across continuations & lineages
+        std::set<unsigned> seeds;
+        for (unsigned streamSeed = 0; streamSeed < 100; streamSeed++)
+        {
+            for (unsigned continuation = 0; continuation < 10; continuation++)
+            {
+                unsigned seed = LineageSnapshot::GetContinuationSeed(streamSeed, continuation);
+                TS_ASSERT_EQUALS(seed, LineageSnapshot::GetContinuationSeed(streamSeed, continuation));
+                seeds.insert(seed);
+            }
+        }
+        TS_ASSERT_EQUALS(seeds.size(), 1000u);
+
+        //unrelated to the simulator's seed range
+        TS_ASSERT_DIFFERS(LineageSnapshot::GetContinuationSeed(0, 0), 0u);
+        TS_ASSERT_DIFFERS(LineageSnapshot::GetContinuationSeed(1, 0), LineageSnapshot::GetContinuationSeed(0, 1));
+    }
+};
+
+#endif /* TESTLINEAGESNAPSHOT_HPP_ */
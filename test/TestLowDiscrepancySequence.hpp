@@ -0,0 +1,66 @@
+#ifndef TESTLOWDISCREPANCYSEQUENCE_HPP_
+#define TESTLOWDISCREPANCYSEQUENCE_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+
+#include "LowDiscrepancySequence.hpp"
+
+#include "FakePetscSetup.hpp"
+
+class TestLowDiscrepancySequence : public CxxTest::TestSuite
+{
+public:
+
+    void TestOneSamplePerStratum()
+    {
+        for (unsigned scrambleSeed = 0; scrambleSeed < 4; scrambleSeed++)
+        {
+            LowDiscrepancySequence sequence(scrambleSeed);
+            for (unsigned k = 0; k <= 10; k++)
+            {
+                unsigned numStrata = 1u << k;
+
+                //the first 2^k samples, and the aligned block of 2^k after them
+                for (unsigned start = 0; start <= numStrata; start += numStrata)
+                {
+                    std::vector<unsigned> hits(numStrata, 0);
+                    for (unsigned i = start; i < start + numStrata; i++)
+                    {
+                        double sample = sequence.GetSample(i);
+                        TS_ASSERT_LESS_THAN_EQUALS(0.0, sample);
+                        TS_ASSERT_LESS_THAN(sample, 1.0);
+                        hits[(unsigned) (sample * numStrata)]++;
+                    }
+                    for (unsigned stratum = 0; stratum < numStrata; stratum++)
+                    {
+                        TS_ASSERT_EQUALS(hits[stratum], 1u);
+                    }
+                }
+            }
+        }
+    }
+
+    void TestScrambleKeys()
+    {
+        LowDiscrepancySequence sequence(1);
+        LowDiscrepancySequence sameSequence(1);
+        LowDiscrepancySequence otherSequence(2);
+
+        unsigned numDiffering = 0;
+        double sum = 0.0;
+        for (unsigned i = 0; i < 1024; i++)
+        {
+            TS_ASSERT_EQUALS(sequence.GetSample(i), sameSequence.GetSample(i));
+            if (sequence.GetSample(i) != otherSequence.GetSample(i)) numDiffering++;
+            sum += sequence.GetSample(i);
+        }
+        TS_ASSERT_EQUALS(numDiffering, 1024u);
+
+        //one sample in each 1/1024 stratum: the mean is within half a stratum of 1/2
+        TS_ASSERT_DELTA(sum / 1024, 0.5, 0.5 / 1024);
+    }
+};
+
+#endif /* TESTLOWDISCREPANCYSEQUENCE_HPP_ */